@@ -0,0 +1,609 @@
+/*
+    Measure image decoders' throughput without any graphic context.
+
+    A fixed corpus is generated into the working directory (or loaded from
+    an existing directory) and each file is decoded several times.
+    Results are printed as one JSON object per line :
+
+    bvr_bench_image [-s size] [-i iterations] [-c corpus_directory] [case...]
+
+    Peak RSS is the process' high-water mark, run a single case per process
+    to get its own peak memory usage.
+*/
+
+#include <BVR/image.h>
+
+#include <png.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+    #include <Windows.h>
+    #include <psapi.h>
+#else
+    #include <sys/resource.h>
+#endif
+
+#ifndef BVR_IMAGE_PROFILE
+    #error "bvr_bench_image requires Beauvoir to be compiled with BVR_IMAGE_PROFILE"
+#endif
+
+#define BENCH_PATH_SIZE 256
+#define BENCH_PSD_LAYER_COUNT 4
+
+typedef int (*bench_writer_t)(const char* path, uint32 size);
+
+struct bench_case_s {
+    const char* name;
+    const char* file;
+    bench_writer_t writer;
+};
+
+static struct {
+    uint32 size;
+    uint32 iterations;
+    const char* corpus;
+
+    uint32 seed;
+} bench;
+
+/*
+    Pseudo random samples, so that compressed formats don't degenerate.
+*/
+static uint8 bench_sample(uint32 x, uint32 y, uint32 channel){
+    bench.seed = bench.seed * 1664525u + 1013904223u;
+    return (uint8)(((x + y * 3 + channel * 64) & 0xFF) ^ ((bench.seed >> 24) & 0x0F));
+}
+
+static void bench_write_u16_le(FILE* file, uint16 value){
+    fputc(value & 0xFF, file);
+    fputc(value >> 8, file);
+}
+
+static void bench_write_u32_le(FILE* file, uint32 value){
+    bench_write_u16_le(file, value & 0xFFFF);
+    bench_write_u16_le(file, value >> 16);
+}
+
+static void bench_write_u16_be(FILE* file, uint16 value){
+    fputc(value >> 8, file);
+    fputc(value & 0xFF, file);
+}
+
+static void bench_write_u32_be(FILE* file, uint32 value){
+    bench_write_u16_be(file, value >> 16);
+    bench_write_u16_be(file, value & 0xFFFF);
+}
+
+static int bench_write_png(const char* path, uint32 size, int depth){
+    FILE* file = fopen(path, "wb");
+    if(!file){
+        return BVR_FAILED;
+    }
+
+    png_structp writer = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+    png_infop info = png_create_info_struct(writer);
+
+    if(setjmp(png_jmpbuf(writer))){
+        png_destroy_write_struct(&writer, &info);
+        fclose(file);
+        return BVR_FAILED;
+    }
+
+    png_init_io(writer, file);
+    png_set_IHDR(writer, info, size, size, depth, PNG_COLOR_TYPE_RGBA,
+        PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT
+    );
+    png_write_info(writer, info);
+
+    uint32 sample_size = depth / 8;
+    uint8* row = malloc(size * 4 * sample_size);
+    BVR_ASSERT(row);
+
+    for (uint32 y = 0; y < size; y++)
+    {
+        for (uint32 x = 0; x < size * 4; x++)
+        {
+            // 16-bit samples are stored as big-endian
+            for (uint32 byte = 0; byte < sample_size; byte++)
+            {
+                row[x * sample_size + byte] = bench_sample(x / 4, y, x % 4);
+            }
+        }
+
+        png_write_row(writer, row);
+    }
+
+    png_write_end(writer, NULL);
+    png_destroy_write_struct(&writer, &info);
+
+    free(row);
+    fclose(file);
+    return BVR_OK;
+}
+
+static int bench_write_png8(const char* path, uint32 size){
+    return bench_write_png(path, size, 8);
+}
+
+static int bench_write_png16(const char* path, uint32 size){
+    return bench_write_png(path, size, 16);
+}
+
+static int bench_write_bmp(const char* path, uint32 size, int bit_per_pixel){
+    FILE* file = fopen(path, "wb");
+    if(!file){
+        return BVR_FAILED;
+    }
+
+    uint32 palette_size = bit_per_pixel == 8 ? 256 * 4 : 0;
+    uint32 stride = ((size * bit_per_pixel + 31) / 32) * 4;
+    uint32 offset = 14 + 40 + palette_size;
+
+    // file header
+    fputc('B', file);
+    fputc('M', file);
+    bench_write_u32_le(file, offset + stride * size);
+    bench_write_u32_le(file, 0);
+    bench_write_u32_le(file, offset);
+
+    // DIB header
+    bench_write_u32_le(file, 40);
+    bench_write_u32_le(file, size);
+    bench_write_u32_le(file, size);
+    bench_write_u16_le(file, 1);
+    bench_write_u16_le(file, bit_per_pixel);
+    bench_write_u32_le(file, 0);
+    bench_write_u32_le(file, stride * size);
+    bench_write_u32_le(file, 2835);
+    bench_write_u32_le(file, 2835);
+    bench_write_u32_le(file, palette_size / 4);
+    bench_write_u32_le(file, 0);
+
+    // gray palette
+    for (uint32 color = 0; color < palette_size / 4; color++)
+    {
+        bench_write_u32_le(file, color | (color << 8) | (color << 16));
+    }
+
+    uint8* row = calloc(stride, sizeof(uint8));
+    BVR_ASSERT(row);
+
+    for (uint32 y = 0; y < size; y++)
+    {
+        for (uint32 x = 0; x < size * (bit_per_pixel / 8); x++)
+        {
+            row[x] = bench_sample(x, y, 0);
+        }
+        fwrite(row, sizeof(uint8), stride, file);
+    }
+
+    free(row);
+    fclose(file);
+    return BVR_OK;
+}
+
+static int bench_write_bmp8(const char* path, uint32 size){
+    return bench_write_bmp(path, size, 8);
+}
+
+static int bench_write_bmp24(const char* path, uint32 size){
+    return bench_write_bmp(path, size, 24);
+}
+
+static int bench_write_bmp32(const char* path, uint32 size){
+    return bench_write_bmp(path, size, 32);
+}
+
+/*
+    Write an uncompressed RGBA TIF where each channel is stored in its own strip.
+*/
+static int bench_write_tif(const char* path, uint32 size){
+    const uint16 tag_count = 11;
+    const uint32 channels = 4;
+
+    FILE* file = fopen(path, "wb");
+    if(!file){
+        return BVR_FAILED;
+    }
+
+    uint32 ifd_offset = 8;
+    uint32 ifd_size = 2 + tag_count * 12 + 4;
+    uint32 bits_offset = ifd_offset + ifd_size;
+    uint32 offsets_offset = bits_offset + channels * sizeof(uint16);
+    uint32 counts_offset = offsets_offset + channels * sizeof(uint32);
+    uint32 data_offset = counts_offset + channels * sizeof(uint32);
+
+    fputc('I', file);
+    fputc('I', file);
+    bench_write_u16_le(file, 42);
+    bench_write_u32_le(file, ifd_offset);
+
+    struct { uint16 id, type; uint32 count, value; } tags[] = {
+        {256, 4, 1, size},                  // width
+        {257, 4, 1, size},                  // height
+        {258, 3, channels, bits_offset},    // bits per sample
+        {259, 3, 1, 1},                     // no compression
+        {262, 3, 1, 2},                     // RGB
+        {273, 4, channels, offsets_offset}, // strip offsets
+        {274, 3, 1, 1},                     // orientation
+        {277, 3, 1, channels},              // samples per pixel
+        {278, 4, 1, size},                  // rows per strip
+        {279, 4, channels, counts_offset},  // strip byte counts
+        {284, 3, 1, 2},                     // planar
+    };
+
+    bench_write_u16_le(file, tag_count);
+    for (uint16 tag = 0; tag < tag_count; tag++)
+    {
+        bench_write_u16_le(file, tags[tag].id);
+        bench_write_u16_le(file, tags[tag].type);
+        bench_write_u32_le(file, tags[tag].count);
+        bench_write_u32_le(file, tags[tag].value);
+    }
+    bench_write_u32_le(file, 0); // no next image
+
+    for (uint32 channel = 0; channel < channels; channel++)
+    {
+        bench_write_u16_le(file, 8);
+    }
+    for (uint32 channel = 0; channel < channels; channel++)
+    {
+        bench_write_u32_le(file, data_offset + channel * size * size);
+    }
+    for (uint32 channel = 0; channel < channels; channel++)
+    {
+        bench_write_u32_le(file, size * size);
+    }
+
+    uint8* row = malloc(size);
+    BVR_ASSERT(row);
+
+    for (uint32 channel = 0; channel < channels; channel++)
+    {
+        for (uint32 y = 0; y < size; y++)
+        {
+            for (uint32 x = 0; x < size; x++)
+            {
+                row[x] = bench_sample(x, y, channel);
+            }
+            fwrite(row, sizeof(uint8), size, file);
+        }
+    }
+
+    free(row);
+    fclose(file);
+    return BVR_OK;
+}
+
+/*
+    PackBits a single row, return the packed length.
+*/
+static uint32 bench_pack_row(const uint8* row, uint32 length, uint8* packed){
+    uint32 packed_length = 0;
+    uint32 i = 0;
+
+    while (i < length)
+    {
+        uint32 run = 1;
+        while (i + run < length && run < 128 && row[i + run] == row[i])
+        {
+            run++;
+        }
+
+        if(run >= 3){
+            packed[packed_length++] = (uint8)(257 - run);
+            packed[packed_length++] = row[i];
+            i += run;
+            continue;
+        }
+
+        uint32 literal = length - i < 128 ? length - i : 128;
+        packed[packed_length++] = (uint8)(literal - 1);
+        memcpy(packed + packed_length, row + i, literal);
+        packed_length += literal;
+        i += literal;
+    }
+
+    return packed_length;
+}
+
+/*
+    Pack a whole channel and return its length.
+    If `file` is NULL, only compute the length.
+*/
+static uint32 bench_write_psd_channel(FILE* file, uint32 width, uint32 height, uint32 channel, uint32 seed){
+    uint8* row = malloc(width);
+    uint8* packed = malloc(width * 2);
+    uint16* lengths = malloc(height * sizeof(uint16));
+    BVR_ASSERT(row && packed && lengths);
+
+    uint32 length = sizeof(uint16) + height * sizeof(uint16);
+    uint32 previous_seed = bench.seed;
+
+    // first pass computes rows' lengths, second pass writes them
+    for (int pass = 0; pass < (file ? 2 : 1); pass++)
+    {
+        bench.seed = seed;
+
+        if(pass == 1){
+            bench_write_u16_be(file, 1);
+            for (uint32 y = 0; y < height; y++)
+            {
+                bench_write_u16_be(file, lengths[y]);
+            }
+        }
+
+        for (uint32 y = 0; y < height; y++)
+        {
+            for (uint32 x = 0; x < width; x++)
+            {
+                // large flat areas, like most painted layers
+                row[x] = (x / 16 + y / 16) & 1 ? bench_sample(x, y, channel) : 0xFF;
+            }
+
+            lengths[y] = bench_pack_row(row, width, packed);
+            if(pass == 0){
+                length += lengths[y];
+            }
+            else {
+                fwrite(packed, sizeof(uint8), lengths[y], file);
+            }
+        }
+    }
+
+    bench.seed = previous_seed;
+
+    free(lengths);
+    free(packed);
+    free(row);
+    return length;
+}
+
+/*
+    Write a multi-layers PSD where every channel is RLE compressed.
+*/
+static int bench_write_psd(const char* path, uint32 size){
+    const short channel_ids[] = {-1, 0, 1, 2};
+    const uint32 channel_count = 4;
+
+    FILE* file = fopen(path, "wb");
+    if(!file){
+        return BVR_FAILED;
+    }
+
+    uint32 bounds[BENCH_PSD_LAYER_COUNT][4];
+    uint32 lengths[BENCH_PSD_LAYER_COUNT][4];
+    uint32 records_size = 0;
+    uint32 data_size = 0;
+
+    for (uint32 layer = 0; layer < BENCH_PSD_LAYER_COUNT; layer++)
+    {
+        // each layer covers three quarters of the canvas
+        uint32 offset = layer * (size / 4) / BENCH_PSD_LAYER_COUNT;
+        bounds[layer][0] = offset;
+        bounds[layer][1] = offset;
+        bounds[layer][2] = offset + size * 3 / 4;
+        bounds[layer][3] = offset + size * 3 / 4;
+
+        for (uint32 channel = 0; channel < channel_count; channel++)
+        {
+            lengths[layer][channel] = bench_write_psd_channel(NULL, size * 3 / 4, size * 3 / 4, channel, layer * 4 + channel);
+            data_size += lengths[layer][channel];
+        }
+
+        // bounds, channels, blend mode, extra data (masks, ranges and a 4 bytes name)
+        records_size += 16 + 2 + channel_count * 6 + 12 + 4 + 4 + 4 + 4;
+    }
+
+    uint32 layer_info_size = sizeof(uint16) + records_size + data_size;
+    layer_info_size += layer_info_size & 1;
+
+    // header
+    fwrite("8BPS", 1, 4, file);
+    bench_write_u16_be(file, 1);
+    fwrite("\0\0\0\0\0\0", 1, 6, file);
+    bench_write_u16_be(file, channel_count);
+    bench_write_u32_be(file, size);
+    bench_write_u32_be(file, size);
+    bench_write_u16_be(file, 8);
+    bench_write_u16_be(file, 3);
+
+    bench_write_u32_be(file, 0); // color mode
+    bench_write_u32_be(file, 0); // ressources
+
+    // layer and mask section
+    bench_write_u32_be(file, 4 + layer_info_size + 4);
+    bench_write_u32_be(file, layer_info_size);
+    bench_write_u16_be(file, (uint16)(-BENCH_PSD_LAYER_COUNT));
+
+    for (uint32 layer = 0; layer < BENCH_PSD_LAYER_COUNT; layer++)
+    {
+        for (uint32 bound = 0; bound < 4; bound++)
+        {
+            bench_write_u32_be(file, bounds[layer][bound]);
+        }
+
+        bench_write_u16_be(file, channel_count);
+        for (uint32 channel = 0; channel < channel_count; channel++)
+        {
+            bench_write_u16_be(file, (uint16)channel_ids[channel]);
+            bench_write_u32_be(file, lengths[layer][channel]);
+        }
+
+        fwrite("8BIMnorm", 1, 8, file);
+        fputc(255, file); // opacity
+        fputc(0, file); // clipping
+        fputc(0, file); // flags
+        fputc(0, file); // filler
+
+        bench_write_u32_be(file, 4 + 4 + 4);
+        bench_write_u32_be(file, 0); // mask
+        bench_write_u32_be(file, 0); // blending ranges
+        fputc(3, file);
+        fprintf(file, "L%02u", layer);
+    }
+
+    for (uint32 layer = 0; layer < BENCH_PSD_LAYER_COUNT; layer++)
+    {
+        for (uint32 channel = 0; channel < channel_count; channel++)
+        {
+            bench_write_psd_channel(file, size * 3 / 4, size * 3 / 4, channel, layer * 4 + channel);
+        }
+    }
+
+    if((sizeof(uint16) + records_size + data_size) & 1){
+        fputc(0, file);
+    }
+
+    bench_write_u32_be(file, 0); // global mask
+
+    // merged image is stored raw
+    bench_write_u16_be(file, 0);
+    for (uint32 i = 0; i < size * size * channel_count; i++)
+    {
+        fputc(0x80, file);
+    }
+
+    fclose(file);
+    return BVR_OK;
+}
+
+static uint64 bench_peak_rss(void){
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+    return counters.PeakWorkingSetSize / 1024;
+#else
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+#endif
+}
+
+static uint64 bench_file_size(const char* path){
+    FILE* file = fopen(path, "rb");
+    if(!file){
+        return 0;
+    }
+
+    fseek(file, 0, SEEK_END);
+    uint64 size = ftell(file);
+    fclose(file);
+    return size;
+}
+
+static void bench_run(struct bench_case_s* bench_case){
+    char path[BENCH_PATH_SIZE];
+    snprintf(path, sizeof(path), "%s/%s", bench.corpus, bench_case->file);
+
+    // only generate missing files, so that a corpus can be reused
+    if(!bench_file_size(path) && !bench_case->writer(path, bench.size)){
+        printf("{\"case\":\"%s\",\"error\":\"cannot write %s\"}\n", bench_case->name, path);
+        return;
+    }
+
+    uint64 input_size = bench_file_size(path);
+    uint64 decoded_size = 0;
+    bvr_image_t image;
+
+    bvr_image_reset_profile();
+
+    for (uint32 iteration = 0; iteration < bench.iterations; iteration++)
+    {
+        FILE* file = fopen(path, "rb");
+        if(!file || !bvr_create_imagef(&image, file, 0) || !image.pixels){
+            printf("{\"case\":\"%s\",\"error\":\"cannot decode %s\"}\n", bench_case->name, path);
+            if(file){
+                fclose(file);
+            }
+            return;
+        }
+        fclose(file);
+
+        uint64 planes = BVR_BUFFER_COUNT(image.layers) ? BVR_BUFFER_COUNT(image.layers) : 1;
+        decoded_size = (uint64)image.width * image.height * image.channels * (image.depth == 16 ? 2 : 1) * planes;
+
+        bvr_destroy_image(&image);
+    }
+
+    bvr_image_profile_t* profile = bvr_image_get_profile();
+    double iterations = bench.iterations;
+    double seconds = profile->total / 1000.0;
+
+    printf(
+        "{\"case\":\"%s\",\"file\":\"%s\",\"iterations\":%u,"
+        "\"input_bytes\":%llu,\"decoded_bytes\":%llu,"
+        "\"header_ms\":%.3f,\"decompress_ms\":%.3f,\"scatter_ms\":%.3f,\"flip_ms\":%.3f,\"total_ms\":%.3f,"
+        "\"input_mb_s\":%.2f,\"decoded_mb_s\":%.2f,\"peak_rss_kb\":%llu}\n",
+        bench_case->name, path, bench.iterations,
+        input_size, decoded_size,
+        profile->header / iterations, profile->decompress / iterations, profile->scatter / iterations,
+        profile->flip / iterations, profile->total / iterations,
+        seconds > 0.0 ? input_size * iterations / seconds / (1024.0 * 1024.0) : 0.0,
+        seconds > 0.0 ? decoded_size * iterations / seconds / (1024.0 * 1024.0) : 0.0,
+        bench_peak_rss()
+    );
+    fflush(stdout);
+}
+
+int main(int argc, char** argv){
+    struct bench_case_s cases[] = {
+        {"png8", "bench_8.png", bench_write_png8},
+        {"png16", "bench_16.png", bench_write_png16},
+        {"bmp8", "bench_8.bmp", bench_write_bmp8},
+        {"bmp24", "bench_24.bmp", bench_write_bmp24},
+        {"bmp32", "bench_32.bmp", bench_write_bmp32},
+        {"tif_planar", "bench_planar.tif", bench_write_tif},
+        {"psd_layers_rle", "bench_layers.psd", bench_write_psd},
+    };
+    const uint32 case_count = sizeof(cases) / sizeof(cases[0]);
+
+    bench.size = 2048;
+    bench.iterations = 5;
+    bench.corpus = ".";
+    bench.seed = 1;
+
+    int first_case = argc;
+    for (int arg = 1; arg < argc; arg++)
+    {
+        if(!strcmp(argv[arg], "-s") && arg + 1 < argc){
+            bench.size = atoi(argv[++arg]);
+        }
+        else if(!strcmp(argv[arg], "-i") && arg + 1 < argc){
+            bench.iterations = atoi(argv[++arg]);
+        }
+        else if(!strcmp(argv[arg], "-c") && arg + 1 < argc){
+            bench.corpus = argv[++arg];
+        }
+        else {
+            first_case = arg;
+            break;
+        }
+    }
+
+    // sizes must be a multiple of 4 to avoid bitmap's padding
+    bench.size = (bench.size + 3) & ~3;
+    if(bench.size < 8 || bench.iterations < 1){
+        fprintf(stderr, "invalid size or iteration count\n");
+        return 1;
+    }
+
+    for (uint32 i = 0; i < case_count; i++)
+    {
+        int selected = first_case == argc;
+        for (int arg = first_case; arg < argc; arg++)
+        {
+            selected |= !strcmp(argv[arg], cases[i].name);
+        }
+
+        if(selected){
+            bench_run(&cases[i]);
+        }
+    }
+
+    return 0;
+}
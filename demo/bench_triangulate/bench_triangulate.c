@@ -0,0 +1,264 @@
+/*
+    Measure polygon triangulation on large outlines, without any graphic context.
+
+    Each case generates an outline (optionally with holes) then triangulates it several times.
+    Results are printed as one JSON object per line :
+
+    bvr_bench_triangulate [-n vertex_count] [-i iterations] [case...]
+
+    `area_error` is the relative difference between the area of the triangles 
+    and the area of the polygon, it should stay close to zero.
+*/
+
+#include <BVR/mesh.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#define BENCH_HOLE_COUNT 16
+
+/*
+    Write an outline and return its hole count, `vertex_count` is updated if fewer vertices are used.
+*/
+typedef uint32 (*bench_generator_t)(float* vertices, uint32* vertex_count, uint32* holes);
+
+struct bench_case_s {
+    const char* name;
+    bench_generator_t generator;
+};
+
+static struct {
+    uint32 vertex_count;
+    uint32 iterations;
+
+    uint32 seed;
+} bench;
+
+static float bench_random(void){
+    bench.seed = bench.seed * 1664525u + 1013904223u;
+    return (bench.seed >> 8) / 16777216.0f;
+}
+
+static void bench_write_ring(float* vertices, uint32 count, float cx, float cy, float radius, float noise, int clockwise){
+    for (uint32 i = 0; i < count; i++)
+    {
+        float angle = 2.0f * (float)M_PI * i / count * (clockwise ? -1.0f : 1.0f);
+        float r = radius * (1.0f - noise * bench_random());
+
+        vertices[i * 2 + 0] = cx + cosf(angle) * r;
+        vertices[i * 2 + 1] = cy + sinf(angle) * r;
+    }
+}
+
+/*
+    Convex outline, every vertex is an ear.
+*/
+static uint32 bench_generate_circle(float* vertices, uint32* vertex_count, uint32* holes){
+    bench_write_ring(vertices, *vertex_count, 0.0f, 0.0f, 100.0f, 0.0f, 0);
+    return 0;
+}
+
+/*
+    Half of the vertices are reflex.
+*/
+static uint32 bench_generate_star(float* vertices, uint32* vertex_count, uint32* holes){
+    for (uint32 i = 0; i < *vertex_count; i++)
+    {
+        float angle = 2.0f * (float)M_PI * i / *vertex_count;
+        float r = i & 1 ? 60.0f : 100.0f;
+
+        vertices[i * 2 + 0] = cosf(angle) * r;
+        vertices[i * 2 + 1] = sinf(angle) * r;
+    }
+    return 0;
+}
+
+/*
+    Noisy sprite-like outline.
+*/
+static uint32 bench_generate_blob(float* vertices, uint32* vertex_count, uint32* holes){
+    bench_write_ring(vertices, *vertex_count, 0.0f, 0.0f, 100.0f, 0.3f, 0);
+    return 0;
+}
+
+/*
+    Comb made of long and thin teeth, ears are slivers.
+*/
+static uint32 bench_generate_comb(float* vertices, uint32* vertex_count, uint32* holes){
+    uint32 teeth = (*vertex_count - 2) / 4;
+    uint32 count = 0;
+
+    for (uint32 tooth = 0; tooth < teeth; tooth++)
+    {
+        float x = tooth * 2.0f;
+        vertices[count++] = x;          vertices[count++] = 0.0f;
+        vertices[count++] = x;          vertices[count++] = 100.0f;
+        vertices[count++] = x + 1.0f;   vertices[count++] = 100.0f;
+        vertices[count++] = x + 1.0f;   vertices[count++] = 0.0f;
+    }
+
+    // base, closing the outline below the teeth
+    vertices[count++] = teeth * 2.0f; vertices[count++] = -10.0f;
+    vertices[count++] = 0.0f;         vertices[count++] = -10.0f;
+
+    // reverse the order to get a counter clockwise outline, like the other cases
+    for (uint32 i = 0; i < count / 4; i++)
+    {
+        for (uint32 axis = 0; axis < 2; axis++)
+        {
+            float tmp = vertices[i * 2 + axis];
+            vertices[i * 2 + axis] = vertices[count - 2 - i * 2 + axis];
+            vertices[count - 2 - i * 2 + axis] = tmp;
+        }
+    }
+
+    *vertex_count = count / 2;
+    return 0;
+}
+
+/*
+    Circle with clockwise holes, laid out on a grid.
+*/
+static uint32 bench_generate_holes(float* vertices, uint32* vertex_count, uint32* holes){
+    uint32 hole_vertex_count = *vertex_count / 2 / BENCH_HOLE_COUNT;
+    uint32 outer_count = *vertex_count - hole_vertex_count * BENCH_HOLE_COUNT;
+
+    bench_write_ring(vertices, outer_count, 0.0f, 0.0f, 100.0f, 0.0f, 0);
+
+    for (uint32 hole = 0; hole < BENCH_HOLE_COUNT; hole++)
+    {
+        float cx = ((hole % 4) - 1.5f) * 30.0f;
+        float cy = ((hole / 4) - 1.5f) * 30.0f;
+
+        holes[hole] = outer_count + hole * hole_vertex_count;
+        bench_write_ring(&vertices[holes[hole] * 2], hole_vertex_count, cx, cy, 10.0f, 0.2f, 1);
+    }
+
+    return BENCH_HOLE_COUNT;
+}
+
+static double bench_ring_area(const float* vertices, uint32 start, uint32 end){
+    double area = 0.0;
+    for (uint32 i = start, j = end - 1; i < end; j = i++)
+    {
+        area += (double)vertices[j * 2] * vertices[i * 2 + 1] - (double)vertices[i * 2] * vertices[j * 2 + 1];
+    }
+    return fabs(area) * 0.5;
+}
+
+static double bench_triangles_area(const vec2* triangles, uint64 count){
+    double area = 0.0;
+    for (uint64 i = 0; i + 2 < count; i += 3)
+    {
+        area += fabs(((double)triangles[i + 1][0] - triangles[i][0]) * ((double)triangles[i + 2][1] - triangles[i][1]) - 
+            ((double)triangles[i + 2][0] - triangles[i][0]) * ((double)triangles[i + 1][1] - triangles[i][1])) * 0.5;
+    }
+    return area;
+}
+
+static double bench_now_ms(void){
+    struct timespec time;
+    timespec_get(&time, TIME_UTC);
+    return time.tv_sec * 1000.0 + time.tv_nsec / 1000000.0;
+}
+
+static void bench_run(struct bench_case_s* bench_case){
+    float* vertices = malloc(bench.vertex_count * 2 * sizeof(float));
+    uint32 holes[BENCH_HOLE_COUNT];
+    BVR_ASSERT(vertices);
+
+    bench.seed = 1;
+    uint32 vertex_count = bench.vertex_count;
+    uint32 hole_count = bench_case->generator(vertices, &vertex_count, holes);
+
+    bvr_mesh_buffer_t src, dest;
+    src.data = (char*)vertices;
+    src.count = vertex_count * 2;
+    src.type = BVR_FLOAT;
+
+    double polygon_area = bench_ring_area(vertices, 0, hole_count ? holes[0] : src.count / 2);
+    for (uint32 hole = 0; hole < hole_count; hole++)
+    {
+        polygon_area -= bench_ring_area(vertices, holes[hole], hole + 1 < hole_count ? holes[hole + 1] : src.count / 2);
+    }
+
+    double best = 0.0, total = 0.0;
+    uint64 triangle_count = 0;
+    double triangles_area = 0.0;
+
+    for (uint32 iteration = 0; iteration < bench.iterations; iteration++)
+    {
+        double start = bench_now_ms();
+        bvr_triangulate_with_holes(&src, hole_count ? holes : NULL, hole_count, &dest, 2);
+        double elapsed = bench_now_ms() - start;
+
+        best = iteration == 0 || elapsed < best ? elapsed : best;
+        total += elapsed;
+
+        triangle_count = dest.count / 3;
+        triangles_area = bench_triangles_area((vec2*)dest.data, dest.count);
+        free(dest.data);
+    }
+
+    printf(
+        "{\"case\":\"%s\",\"vertices\":%llu,\"holes\":%u,\"triangles\":%llu,\"iterations\":%u,"
+        "\"best_ms\":%.3f,\"average_ms\":%.3f,\"area_error\":%.2e}\n",
+        bench_case->name, src.count / 2, hole_count, triangle_count, bench.iterations,
+        best, total / bench.iterations, polygon_area > 0.0 ? fabs(triangles_area - polygon_area) / polygon_area : 0.0
+    );
+    fflush(stdout);
+
+    free(vertices);
+}
+
+int main(int argc, char** argv){
+    struct bench_case_s cases[] = {
+        {"circle", bench_generate_circle},
+        {"star", bench_generate_star},
+        {"blob", bench_generate_blob},
+        {"comb", bench_generate_comb},
+        {"holes", bench_generate_holes},
+    };
+    const uint32 case_count = sizeof(cases) / sizeof(cases[0]);
+
+    bench.vertex_count = 10000;
+    bench.iterations = 10;
+
+    int first_case = argc;
+    for (int arg = 1; arg < argc; arg++)
+    {
+        if(!strcmp(argv[arg], "-n") && arg + 1 < argc){
+            bench.vertex_count = atoi(argv[++arg]);
+        }
+        else if(!strcmp(argv[arg], "-i") && arg + 1 < argc){
+            bench.iterations = atoi(argv[++arg]);
+        }
+        else {
+            first_case = arg;
+            break;
+        }
+    }
+
+    if(bench.vertex_count < BENCH_HOLE_COUNT * 8 || bench.iterations < 1){
+        fprintf(stderr, "invalid vertex or iteration count\n");
+        return 1;
+    }
+
+    for (uint32 i = 0; i < case_count; i++)
+    {
+        int selected = first_case == argc;
+        for (int arg = first_case; arg < argc; arg++)
+        {
+            selected |= !strcmp(argv[arg], cases[i].name);
+        }
+
+        if(selected){
+            bench_run(&cases[i]);
+        }
+    }
+
+    return 0;
+}
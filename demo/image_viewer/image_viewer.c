@@ -18,6 +18,7 @@
 #endif
 
 #define CAMERA_SLIDER_MAX 1000.0f
+#define RECENT_FILE_COUNT 4
 
 static bvr_book_t game;
 static bvr_nuklear_t gui;
@@ -31,8 +32,29 @@ static struct {
 
     uint8* enabled_layers;
     uint32 image_flags;
+
+    bvr_thumbnail_generator_t thumbnails;
+    bvr_thumbnail_t* recent_files[RECENT_FILE_COUNT];
 } image_viewer;
 
+static void add_recent_file(const char* path){
+    bvr_asset_t asset;
+    if(!bvr_find_asset(path, &asset)){
+        return;
+    }
+
+    bvr_thumbnail_t* thumbnail = bvr_request_thumbnail(&image_viewer.thumbnails, &asset);
+    for (int i = 0; i < RECENT_FILE_COUNT; i++)
+    {
+        if(image_viewer.recent_files[i] == thumbnail){
+            return;
+        }
+    }
+
+    memmove(&image_viewer.recent_files[1], &image_viewer.recent_files[0], (RECENT_FILE_COUNT - 1) * sizeof(bvr_thumbnail_t*));
+    image_viewer.recent_files[0] = thumbnail;
+}
+
 static void load_texture(const char* path){
     if(image_viewer.texture.id){
         bvr_destroy_layered_texture(&image_viewer.texture);
@@ -42,13 +64,17 @@ static void load_texture(const char* path){
     }
 
     if(path){
-        memcpy(image_viewer.path, path, sizeof(image_viewer.path));
+        if(path != image_viewer.path){
+            strncpy(image_viewer.path, path, sizeof(image_viewer.path) - 1);
+        }
 
         bvr_create_layered_texture(&image_viewer.texture, path, image_viewer.image_flags, BVR_TEXTURE_WRAP_REPEAT);
         bvr_shader_set_texturei(image_viewer.texture_uniform, &image_viewer.texture.id, NULL);
     
         image_viewer.enabled_layers = calloc(BVR_BUFFER_COUNT(image_viewer.texture.image.layers), sizeof(uint8));   
         memset(image_viewer.enabled_layers, 1, BVR_BUFFER_COUNT(image_viewer.texture.image.layers)); 
+
+        add_recent_file(path);
     }
 }
 
@@ -90,19 +116,22 @@ int main(){
     /* Initialize GUI */
     bvr_create_nuklear(&gui, &game.window);
 
+    /* Recent files' previews are generated in background */
+    bvr_create_thumbnail_generator(&image_viewer.thumbnails, "thumbnails/");
+
     /* Create the camera */
     bvr_create_orthographic_camera(&game.page, &game.window.framebuffer, 0.1f, 100.0f, 1.0f);
 
     /* Create image's plane mesh */
     bvr_create_2d_square_mesh(&image_viewer.model.mesh, 480.0f, 480.0f);
 
-    /* Create the shader */
-    bvr_create_shader(&image_viewer.model.shader, "../shader.glsl", BVR_VERTEX_SHADER | BVR_FRAGMENT_SHADER);
+    /* Create the shader, it is instanced so that every layer is drawn at once */
+    bvr_create_shader(&image_viewer.model.shader, "../shader_instanced.glsl", BVR_VERTEX_SHADER | BVR_FRAGMENT_SHADER);
 
-    /* create texture uniforms */
+    /* create texture uniforms, layer index is an instance attribute */
     image_viewer.texture_uniform = bvr_shader_register_texture(
         &image_viewer.model.shader, BVR_TEXTURE_2D_ARRAY, NULL, NULL, 
-        "bvr_texture", "bvr_texture_layer"
+        "bvr_texture", NULL
     );
 
     load_texture("../scene.tif");
@@ -117,34 +146,52 @@ int main(){
             break;
         }
 
-        /* start drawing */
-        bvr_shader_enable(&image_viewer.model.shader);
-        for (int layer = 0; layer < BVR_BUFFER_COUNT(image_viewer.texture.image.layers); layer++)
+        /* 
+            start drawing, each enabled layer is a draw command. 
+            Commands share the same mesh, shader and texture, so the pipeline merges them into one instanced draw.
+        */
         {
-            if(image_viewer.enabled_layers[layer]){
-                image_viewer.model.object.transform.position[1] = layer;
-                
-                /* enable texture unit */
-                bvr_layered_texture_enable(&image_viewer.texture, BVR_TEXTURE_UNIT0);
+            struct bvr_draw_command_s cmd;
+            memset(&cmd, 0, sizeof(cmd));
+
+            mat4x4 transform;
+            BVR_IDENTITY_MAT4(transform);
+            memcpy(cmd.transform, transform, sizeof(mat4x4));
+
+            cmd.array_buffer = image_viewer.model.mesh.array_buffer;
+            cmd.vertex_buffer = image_viewer.model.mesh.vertex_buffer;
+            cmd.element_buffer = image_viewer.model.mesh.element_buffer;
+            cmd.attrib_count = image_viewer.model.mesh.attrib_count;
+            cmd.base_vertex = image_viewer.model.mesh.base_vertex;
+            cmd.element_offset = image_viewer.model.mesh.element_offset;
+            cmd.element_count = image_viewer.model.mesh.element_count;
+            cmd.element_type = image_viewer.model.mesh.element_type;
+            cmd.draw_mode = BVR_DRAWMODE_TRIANGLES;
+
+            cmd.shader = &image_viewer.model.shader;
+            cmd.texture_type = BVR_TEXTURE_2D_ARRAY;
+            cmd.texture = (bvr_texture_t*)&image_viewer.texture;
+            cmd.payload_type = BVR_DRAW_PAYLOAD_LAYER;
+
+            for (int layer = 0; layer < BVR_BUFFER_COUNT(image_viewer.texture.image.layers); layer++)
+            {
+                if(image_viewer.enabled_layers[layer]){
+                    /* layers are decoded the first time they are shown */
+                    bvr_layered_texture_load_layer(&image_viewer.texture, layer);
 
-                /* update texture's content and push it to the shader */
-                bvr_shader_set_texturei(image_viewer.texture_uniform, NULL, &layer);
-                bvr_shader_use_uniform(image_viewer.texture_uniform, NULL);
-    
-                /* draw the plane */
-                bvr_mesh_draw(&image_viewer.model.mesh, BVR_DRAWMODE_TRIANGLES);
-                
-                /* disable texture unit */
-                bvr_layered_texture_disable();
+                    cmd.payload.layer = layer;
+                    bvr_pipeline_add_draw_cmd(&cmd);
+                }
             }
         }
-        
-        /* disable shader */
-        bvr_shader_disable();
+
+        /* draw now, so that this frame's statistics can be shown */
+        bvr_flush(&game);
 
 #ifdef BVR_INCLUDE_NUKLEAR
         {
             bvr_nuklear_handle(&gui);
+            bvr_thumbnail_generator_update(&image_viewer.thumbnails);
 
             if (nk_begin(gui.context, "Book informations", nk_rect(50, 50, 350, 200),
                 NK_WINDOW_BORDER|NK_WINDOW_MOVABLE|NK_WINDOW_SCALABLE|
@@ -152,6 +199,9 @@ int main(){
             {
                 nk_layout_row_dynamic(gui.context, 15, 1);
                 nk_label(gui.context, BVR_FORMAT("delta time %fms", game.delta_time * 1000.0f), NK_TEXT_ALIGN_LEFT);
+                nk_label(gui.context, BVR_FORMAT("draw commands %u, instanced draws %u (%u commands)", 
+                    game.pipeline.statistics.submitted_commands, game.pipeline.statistics.instanced_draws, 
+                    game.pipeline.statistics.instanced_commands), NK_TEXT_ALIGN_LEFT);
                 nk_label(gui.context, "-", NK_TEXT_ALIGN_CENTERED);
                 
                 bvr_nuklear_vec3_label(&gui, "Position", game.page.camera.transform.position);
@@ -202,6 +252,18 @@ int main(){
                 if(nk_button_label(gui.context, "Reload")){
                     load_texture(image_viewer.path);
                 }
+
+                nk_layout_row_static(gui.context, 64, 64, RECENT_FILE_COUNT);
+                for (int i = 0; i < RECENT_FILE_COUNT; i++)
+                {
+                    bvr_thumbnail_t* thumbnail = image_viewer.recent_files[i];
+                    if(thumbnail && thumbnail->texture.id &&
+                        nk_button_image(gui.context, nk_image_id(thumbnail->texture.id))){
+                        
+                        load_texture(thumbnail->path.string);
+                        break;
+                    }
+                }
             }
             nk_end(gui.context);
 
@@ -215,6 +277,7 @@ int main(){
     
     free(image_viewer.enabled_layers);
 
+    bvr_destroy_thumbnail_generator(&image_viewer.thumbnails);
     bvr_destroy_nuklear(&gui);
     bvr_destroy_shader(&image_viewer.model.shader);
     bvr_destroy_mesh(&image_viewer.model.mesh);
@@ -0,0 +1,49 @@
+#version 400
+
+#ifdef _VERTEX_
+
+layout(location=0) in vec3 in_position;
+layout(location=1) in vec2 in_uvs;
+
+/* per layer data, filled by the pipeline */
+layout(location=8) in mat4 bvr_instance_transform;
+layout(location=12) in int bvr_instance_layer;
+
+layout(std140) uniform bvr_camera {
+	mat4 bvr_projection;
+	mat4 bvr_view;
+};
+
+out V_DATA {
+	vec2 uvs;
+	flat int layer;
+} vertex;
+
+void main() {
+	gl_Position = bvr_projection * bvr_view * bvr_instance_transform * vec4(in_position, 1.0);
+	
+	vertex.uvs = in_uvs;
+	vertex.layer = bvr_instance_layer;
+}
+
+#endif
+
+#ifdef _FRAGMENT_
+
+in V_DATA {
+	vec2 uvs;
+	flat int layer;
+} vertex;
+
+uniform sampler2DArray bvr_texture;
+
+void main() {
+	vec4 tex = texture(bvr_texture, vec3(vertex.uvs, vertex.layer));
+
+	if(tex.a < 0.1){
+		tex = vec4(0.2, 0.2, 0.2, 0.2);
+	}
+	gl_FragColor = vec4(tex);
+}
+
+#endif
\ No newline at end of file
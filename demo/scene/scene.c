@@ -16,6 +16,14 @@ static bvr_book_t book;
 */
 static bvr_dynamic_actor_t player;
 
+/*
+    ground's tiles
+    It is a single actor drawn several times each frame, 
+    because its shader is instanced every tile is drawn with the same draw call.
+*/
+#define TILE_COUNT 16
+static bvr_static_actor_t tiles;
+
 /* editor's context */
 static bvr_editor_t editor;
 
@@ -72,6 +80,23 @@ int main(){
         bvr_link_actor_to_page(&book.page, &player.object);
     }
 
+    {
+        bvr_create_2d_square_mesh(&tiles.mesh, 20.0f, 20.0f);
+
+        /*
+            this shader reads its transform from 'bvr_instance_transform' instead of 'bvr_transform',
+            so that the pipeline can merge tiles' draw commands into a single instanced draw.
+        */
+        bvr_create_shader(&tiles.shader, "monochrome_instanced.glsl", BVR_VERTEX_SHADER | BVR_FRAGMENT_SHADER);
+        bvr_shader_register_uniform(&tiles.shader, BVR_VEC3, 1, "bvr_color");
+
+        vec3 color = {0.4f, 0.4f, 0.4f};
+        bvr_shader_set_uniform(&tiles.shader, "bvr_color", &color[0]);
+
+        /* tiles are not linked to the page, they are drawn and destroyed by hand */
+        bvr_create_actor(&tiles.object, "tiles", BVR_STATIC_ACTOR, 0);
+    }
+
     /* main loop */
     while (1)
     {
@@ -111,6 +136,15 @@ int main(){
         /* update collisions and physics */
         bvr_update(&book);
 
+        /* draw tiles, each draw queues a command with tile's current transform */
+        for (int tile = 0; tile < TILE_COUNT; tile++)
+        {
+            tiles.object.transform.position[0] = (tile - TILE_COUNT / 2) * 25.0f;
+            tiles.object.transform.position[1] = -100.0f;
+
+            bvr_draw_actor(&tiles.object, BVR_DRAWMODE_TRIANGLES);
+        }
+
         /* draw player */
         bvr_draw_actor((bvr_static_actor_t*)&player.object, BVR_DRAWMODE_TRIANGLES);
 
@@ -125,6 +159,7 @@ int main(){
     }
     
     /* free */
+    bvr_destroy_actor(&tiles.object);
     bvr_destroy_book(&book);
 
     return 0;
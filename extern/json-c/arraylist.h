@@ -24,6 +24,8 @@ extern "C" {
 
 #include <stddef.h>
 
+#include "json_inttypes.h"
+
 #define ARRAY_LIST_DEFAULT_SIZE 32
 
 typedef void(array_list_free_fn)(void *data);
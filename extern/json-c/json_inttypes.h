@@ -34,4 +34,15 @@ typedef unsigned __int64 uint64_t;
 typedef SSIZE_T ssize_t;
 #endif
 
+/* short integer names shared with Beauvoir (BVR/config.h), keep them identical */
+typedef signed char int8;
+typedef unsigned char uint8;
+typedef short int16;
+typedef unsigned short uint16;
+typedef int int32;
+typedef unsigned uint32;
+
+typedef long long int64;
+typedef unsigned long long uint64;
+
 #endif
@@ -8,6 +8,10 @@
     #define BVR_EDITOR_HIDDEN_INPUT 62
 #endif
 
+#ifndef BVR_EDITOR_THUMBNAIL_PATH
+    #define BVR_EDITOR_THUMBNAIL_PATH "thumbnails/"
+#endif
+
 #ifndef BVR_EDITOR_SHOW_INPUT
     // f6
     #define BVR_EDITOR_SHOW_INPUT 63
@@ -30,9 +34,11 @@ typedef struct bvr_editor_s {
         bvr_shader_t shader;
 
         uint32 array_buffer; 
-        uint32 vertex_buffer;
+        bvr_dynamic_buffer_t vertex_buffer;
     } device;
 
+    bvr_thumbnail_generator_t thumbnails;
+
     struct {
         bvr_string_t name;
 
@@ -11,11 +11,34 @@
 #define BVR_BE_TO_LE_U16 __bswap_16
 #define BVR_BE_TO_LE_U32 __bswap_32
 
+/*
+    Read-only view over a whole file.
+*/
+typedef struct bvr_file_view_s {
+    void* data;
+    uint64 size;
+
+    /*
+        If the file could not be mapped, the view is a heap copy.
+    */
+    int mapped;
+} bvr_file_view_t;
+
 /*
     Return size of a file.
 */
 uint64 bvr_get_file_size(FILE* file);
 
+/*
+    Map a whole file into memory, or read it if the platform cannot map it.
+*/
+int bvr_map_file(bvr_file_view_t* view, FILE* file);
+
+/*
+    Release a file view.
+*/
+void bvr_unmap_file(bvr_file_view_t* view);
+
 /*
     Read all the file and copy data into a string.
 */
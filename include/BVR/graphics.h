@@ -31,7 +31,67 @@
 #define BVR_DEPTH_FUNC_NOTEQUAL 0x080
 #define BVR_DEPTH_FUNC_EQUAL    0x100
 
-#define BVR_MAX_DRAW_COMMAND 258
+/*
+    Draw commands reserved by the pipeline on first use, the queue then doubles when it is full 
+    up to BVR_DRAW_COMMAND_LIMIT commands. The queue keeps its largest size across frames.
+*/
+#ifndef BVR_MAX_DRAW_COMMAND
+    #define BVR_MAX_DRAW_COMMAND 258
+#endif
+
+/*
+    Commands submitted beyond this limit in a frame are dropped and counted in pipeline's statistics.
+*/
+#ifndef BVR_DRAW_COMMAND_LIMIT
+    #define BVR_DRAW_COMMAND_LIMIT (1 << 20)
+#endif
+
+/*
+    Number of frames a dynamic buffer can be written ahead of the GPU, 
+    each frame appends to its own region of the buffer.
+*/
+#ifndef BVR_DYNAMIC_BUFFER_FRAMES
+    #define BVR_DYNAMIC_BUFFER_FRAMES 3
+#endif
+
+/*
+    Texture units whose bindings are cached by the pipeline.
+*/
+#ifndef BVR_PIPELINE_TEXTURE_UNITS
+    #define BVR_PIPELINE_TEXTURE_UNITS 8
+#endif
+
+/*
+    Bytes of per instance data the pipeline can write each frame, 
+    commands that do not fit are drawn one by one.
+*/
+#ifndef BVR_INSTANCE_BUFFER_SIZE
+    #define BVR_INSTANCE_BUFFER_SIZE (1 << 20)
+#endif
+
+/*
+    Ring buffer for geometry written every frame (debug lines, particles...).
+    A region is only written again once the fence set at the end of its frame is signaled, 
+    so that appending never waits for the GPU to be done with the previous frames.
+*/
+typedef struct bvr_dynamic_buffer_s {
+    uint32 buffer;
+
+    uint64 region_size;
+    uint64 offset;
+    uint8 region;
+
+    void* fences[BVR_DYNAMIC_BUFFER_FRAMES];
+} bvr_dynamic_buffer_t;
+
+/*
+    Location of geometry appended to a dynamic buffer, `offset` is in bytes from buffer's start.
+    `buffer` is 0 when the geometry didn't fit.
+*/
+typedef struct bvr_dynamic_range_s {
+    uint32 buffer;
+    uint64 offset;
+} bvr_dynamic_range_t;
 
 struct bvr_pipeline_state_s {
     short blending;
@@ -39,6 +99,18 @@ struct bvr_pipeline_state_s {
     int flags;
 };
 
+/*
+    Tells which member of a draw command's payload is used.
+*/
+typedef enum bvr_draw_payload_e {
+    BVR_DRAW_PAYLOAD_NONE = 0,
+
+    /*
+        Layer of the texture array to draw.
+    */
+    BVR_DRAW_PAYLOAD_LAYER
+} bvr_draw_payload_t;
+
 struct bvr_draw_command_s {
     short order;
 
@@ -46,8 +118,10 @@ struct bvr_draw_command_s {
     uint32 vertex_buffer;
     uint32 element_buffer;
 
-    uint16 element_offset;
+    int32 base_vertex;
+    uint32 element_offset;
     uint32 element_count;
+    uint16 element_type;
     uint8 attrib_count;
     
     uint8 draw_mode;
@@ -57,9 +131,70 @@ struct bvr_draw_command_s {
     bvr_shader_t* shader;
     bvr_texture_t* texture;    
 
-    void* user_data;
+    /*
+        Model matrix, uploaded when the command is drawn.
+    */
+    mat4x4 transform;
+
+    /*
+        Payload is stored inline, submitting a command never allocates.
+    */
+    uint8 payload_type;
+    union {
+        int32 layer;
+    } payload;
 } __attribute__ ((packed));
 
+/*
+    Last states sent to OpenGL by the pipeline, setting the same state again is skipped.
+    Bindings are forgotten at each flush, since they are also changed outside of the pipeline. 
+    Blending and depth stay cached, code changing them behind the pipeline (like the GUI) must invalidate them.
+    Counters are reset each frame.
+*/
+struct bvr_pipeline_cache_s {
+    uint32 program;
+    uint32 active_texture;
+    uint32 textures[BVR_PIPELINE_TEXTURE_UNITS];
+    uint32 texture_targets[BVR_PIPELINE_TEXTURE_UNITS];
+
+    uint32 array_buffer;
+    uint32 vertex_buffer;
+    uint32 element_buffer;
+
+    short blending;
+    short depth;
+
+    uint32 issued_calls;
+    uint32 elided_calls;
+};
+
+/*
+    Draw command's sort key, and its index in the queue.
+*/
+struct bvr_draw_key_s {
+    uint64 key;
+    uint32 index;
+};
+
+/*
+    Pipeline's statistics for the current frame, reset in bvr_new_frame.
+*/
+struct bvr_pipeline_statistics_s {
+    uint32 submitted_commands;
+    uint32 dropped_commands;
+
+    /*
+        Times the command queue was full and had to grow.
+    */
+    uint32 queue_growths;
+
+    /*
+        Instanced draw calls issued, and the commands they drew.
+    */
+    uint32 instanced_draws;
+    uint32 instanced_commands;
+};
+
 typedef struct bvr_pipeline_s {
     /*
         State use for default rendering
@@ -72,8 +207,23 @@ typedef struct bvr_pipeline_s {
     */
     struct bvr_pipeline_state_s swap_pass;
 
-    uint16 command_count;
-    struct bvr_draw_command_s commands[BVR_MAX_DRAW_COMMAND];
+    /*
+        Commands queued for the next flush, `command_order` and `command_keys` 
+        are the sort's buffers and grow with the queue.
+    */
+    struct bvr_draw_command_s* commands;
+    uint32* command_order;
+    struct bvr_draw_key_s* command_keys;
+    uint32 command_count;
+    uint32 command_capacity;
+
+    /*
+        Per instance data of instanced draws, created on first use.
+    */
+    bvr_dynamic_buffer_t instances;
+
+    struct bvr_pipeline_cache_s cache;
+    struct bvr_pipeline_statistics_s statistics;
 
     vec3 clear_color;
 } bvr_pipeline_t;
@@ -92,12 +242,89 @@ typedef struct bvr_framebuffer_s {
 void bvr_pipeline_state_enable(struct bvr_pipeline_state_s* const state);
 void bvr_pipeline_draw_cmd(struct bvr_draw_command_s* cmd);
 void bvr_pipeline_add_draw_cmd(struct bvr_draw_command_s* cmd);
+
+/*
+    Set OpenGL states through the pipeline's cache.
+*/
+void bvr_pipeline_use_program(uint32 program);
+void bvr_pipeline_bind_texture(int unit, int target, uint32 texture);
+void bvr_pipeline_bind_vertex_array(uint32 array_buffer);
+void bvr_pipeline_bind_buffer(int target, uint32 buffer);
+
+/*
+    Forget cached bindings, after OpenGL states were changed outside of the pipeline.
+    Blending and depth states are forgotten as well if `all` is true.
+*/
+void bvr_pipeline_invalidate_cache(bvr_pipeline_t* pipeline, int all);
 void bvr_error(void);
 
-BVR_H_FUNC int bvr_pipeline_compare_commands(const void* a, const void* b){
-    return (((struct bvr_draw_command_s*)a)->order - ((struct bvr_draw_command_s*)b)->order);
+/*
+    Sort key of a draw command, from the most significant bits: order, shader, texture, vertex array 
+    and mesh range. Meshes of a layout share their vertex array, the range tells them apart so that 
+    commands drawing the same mesh with the same states end up next to each other within an order.
+*/
+BVR_H_FUNC uint64 bvr_pipeline_command_key(const struct bvr_draw_command_s* cmd){
+    uint32 range = cmd->element_offset * 31 + (uint32)cmd->base_vertex;
+
+    return ((uint64)((uint16)cmd->order ^ 0x8000) << 48) |
+        ((uint64)(cmd->shader ? cmd->shader->program & 0xFFF : 0) << 36) |
+        ((uint64)(cmd->texture ? cmd->texture->id & 0xFFF : 0) << 24) |
+        ((uint64)(cmd->array_buffer & 0xFF) << 16) |
+        (uint64)(range & 0xFFFF);
 }
 
+/*
+    Sort commands by key into `indices`, commands are not moved.
+    Sort is stable, commands with the same key keep their submission order.
+    `keys` must hold twice `count` keys.
+*/
+void bvr_pipeline_sort_commands(const struct bvr_draw_command_s* commands, uint32 count, uint32* indices, 
+    struct bvr_draw_key_s* keys);
+
+/*
+    Number of commands, starting at `indices[0]`, that can be drawn with a single instanced draw.
+    Commands are merged if they use the same instanced shader with the same uniforms, and the same 
+    mesh range, texture and draw mode. Returns 1 if the first command cannot be instanced.
+*/
+uint32 bvr_pipeline_instance_count(const struct bvr_draw_command_s* commands, const uint32* indices, uint32 count);
+
+/*
+    Draw `count` commands with one instanced draw, each command's transform and layer are instance's data.
+*/
+void bvr_pipeline_draw_instanced(struct bvr_draw_command_s* commands, const uint32* indices, uint32 count);
+
+/*
+    Release pipeline's command queue and instance buffer.
+*/
+void bvr_destroy_pipeline(bvr_pipeline_t* pipeline);
+
+/*
+    Create a dynamic buffer that can receive `size` bytes each frame.
+*/
+int bvr_create_dynamic_buffer(bvr_dynamic_buffer_t* buffer, const uint64 size);
+
+/*
+    Reserve `size` bytes of the current frame, aligned on a multiple of `alignment` bytes, 
+    and map them for writing. Returns NULL if the frame is full, the range must be unmapped before drawing.
+*/
+void* bvr_dynamic_buffer_map(bvr_dynamic_buffer_t* buffer, const uint64 size, const uint64 alignment, 
+    bvr_dynamic_range_t* range);
+
+void bvr_dynamic_buffer_unmap(bvr_dynamic_buffer_t* buffer);
+
+/*
+    Copy `size` bytes to the current frame.
+*/
+bvr_dynamic_range_t bvr_dynamic_buffer_append(bvr_dynamic_buffer_t* buffer, const void* data, 
+    const uint64 size, const uint64 alignment);
+
+/*
+    Close the current frame once its draws are issued, and move to the next region.
+*/
+void bvr_dynamic_buffer_next_frame(bvr_dynamic_buffer_t* buffer);
+
+void bvr_destroy_dynamic_buffer(bvr_dynamic_buffer_t* buffer);
+
 int bvr_create_framebuffer(bvr_framebuffer_t* framebuffer, const uint16 width, const uint16 height, const char* shader);
 void bvr_framebuffer_enable(bvr_framebuffer_t* framebuffer);
 void bvr_framebuffer_disable(bvr_framebuffer_t* framebuffer);
@@ -27,6 +27,8 @@
 #define BVR_RG16    0x822C
 #define BVR_RGB16   0x8054
 #define BVR_RGBA16  0x805B
+#define BVR_RGB16F  0x881B
+#define BVR_RGBA16F 0x881A
 
 #define BVR_TEXTURE_UNIT0   0x84C0
 #define BVR_TEXTURE_UNIT1   0x84C1
@@ -67,8 +69,39 @@
 #define BVR_TEXTURE_WRAP_REPEAT 0x2901
 #define BVR_TEXTURE_WRAP_CLAMP_TO_EDGE 0x812F
 
+/*
+    Only load PSD's merged image and skip every layer.
+*/
+#define BVR_IMAGE_LOAD_COMPOSITE 0x01
+
+/*
+    Reduce 16-bit images to 8-bit (ordered dithering) right after decoding.
+*/
+#define BVR_IMAGE_LOAD_REDUCE_16 0x02
+
+/*
+    Downscale image by an integer denominator (1 to 255) while decoding it.
+    PNG, TIF and PSD's merged image are box filtered scanline per scanline, 
+    others formats are filtered once decoded.
+*/
+#define BVR_IMAGE_LOAD_SCALE(denominator) (((denominator) & 0xFF) << 16)
+
+#ifndef BVR_THUMBNAIL_SIZE
+    #define BVR_THUMBNAIL_SIZE 128
+#endif
+
+#define BVR_THUMBNAIL_QUEUED  0x0
+#define BVR_THUMBNAIL_LOADING 0x1
+#define BVR_THUMBNAIL_READY   0x2
+#define BVR_THUMBNAIL_FAILED  0x3
+
 #define BVR_LAYER_CLIPPED 0x01
 
+/*
+    Layer's pixels have been decoded (and uploaded for layered textures).
+*/
+#define BVR_LAYER_LOADED  0x02
+
 typedef enum bvr_layer_blend_mode_e {
     BVR_LAYER_BLEND_PASSTHROUGH     = 0x70617373,
     BVR_LAYER_BLEND_NORMAL          = 0x6E6F726D,
@@ -100,6 +133,15 @@ typedef enum bvr_layer_blend_mode_e {
     BVR_LAYER_BLEND_LUMINOSITY      = 0x65756D00
 } bvr_layer_blend_mode_t;
 
+/*
+    Position of a layer's channel inside layer's packed data.
+*/
+typedef struct bvr_layer_channel_s {
+    short id;
+    uint32 offset;
+    uint32 length;
+} bvr_layer_channel_t;
+
 /*
     Contains image layer informations
 */
@@ -112,6 +154,15 @@ typedef struct bvr_layer_s {
 
     short opacity;
     bvr_layer_blend_mode_t blend_mode;
+
+    // packed channels, used to decode the layer on demand
+    struct bvr_buffer_s channels;
+
+    /*
+        Layer's compressed data.
+        Released once the layer is decoded.
+    */
+    struct bvr_buffer_s packed;
 } bvr_layer_t;
 
 /*
@@ -137,6 +188,32 @@ typedef struct bvr_texture_s {
     int filter, wrap;
 } bvr_texture_t;
 
+/*
+    Downscaled preview of an image asset.
+    Texture is created once the thumbnail is ready.
+*/
+typedef struct bvr_thumbnail_s {
+    bvr_uuid_t id;
+    bvr_string_t path;
+
+    int state;
+    bvr_texture_t texture;
+} bvr_thumbnail_t;
+
+/*
+    Generate thumbnails on a background thread.
+    Each thumbnail is cached on disk under its asset's uuid.
+*/
+typedef struct bvr_thumbnail_generator_s {
+    struct bvr_buffer_s thumbnails;
+    bvr_string_t cache_path;
+
+    int running;
+    void* thread;
+    void* lock;
+    void* signal;
+} bvr_thumbnail_generator_t;
+
 /*
     Represent an array of 2D textures
 */
@@ -160,8 +237,30 @@ typedef struct bvr_layered_texture_s {
     int filter, wrap;
 } bvr_layered_texture_t;
 
-int bvr_create_imagef(bvr_image_t* image, FILE* file);
-BVR_H_FUNC int bvr_create_image(bvr_image_t* image, const char* path){
+#ifdef BVR_IMAGE_PROFILE
+
+/*
+    Time spent (in milliseconds) in each image decoding stage.
+    Only available when compiled with BVR_IMAGE_PROFILE.
+*/
+typedef struct bvr_image_profile_s {
+    double header;
+    double decompress;
+    double scatter;
+    double flip;
+    double total;
+} bvr_image_profile_t;
+
+/*
+    Return stages' timings accumulated since the last reset.
+*/
+bvr_image_profile_t* bvr_image_get_profile(void);
+void bvr_image_reset_profile(void);
+
+#endif
+
+int bvr_create_imagef(bvr_image_t* image, FILE* file, int flags);
+BVR_H_FUNC int bvr_create_image(bvr_image_t* image, const char* path, int flags){
     BVR_FILE_EXISTS(path);
     
     bvr_uuid_t* id = bvr_register_asset(path, BVR_OPEN_READ);
@@ -171,21 +270,34 @@ BVR_H_FUNC int bvr_create_image(bvr_image_t* image, const char* path){
     }
 
     FILE* file = fopen(path, "rb");
-    int success = bvr_create_imagef(image, file);
+    int success = bvr_create_imagef(image, file, flags);
     fclose(file);
     return success;
 }
 
 int bvr_create_bitmap(bvr_image_t* image, const char* path, int channel);
 
+/*
+    Decode a single layer from its packed data, which is released afterward.
+    `pixels` must be an allocated canvas of width * height * channels * (depth / 8) bytes.
+*/
+int bvr_image_decode_layer(bvr_image_t* image, uint32 layer, uint8* pixels);
+
 /*
     Flip a pixel buffer vertically
 */
 void bvr_flip_image_vertically(bvr_image_t* image);
 
+/*
+    Reduce a 16-bit image to 8-bit in place using a 4x4 ordered dither.
+    Does nothing if image is already 8-bit.
+*/
+void bvr_image_reduce_depth(bvr_image_t* image);
+
 /*
     Copy a specific image channel over another pixel buffer.
     The targeted pixel buffer must be allocated.
+    16-bit images are copied as their most significant byte.
 */
 int bvr_image_copy_channel(bvr_image_t* image, int channel, uint8* buffer);
 
@@ -193,8 +305,8 @@ void bvr_destroy_image(bvr_image_t* image);
 
 /* 2D TEXTURE */
 int bvr_create_texture_from_image(bvr_texture_t* texture, bvr_image_t* image, int filter, int wrap);
-int bvr_create_texturef(bvr_texture_t* texture, FILE* file, int filter, int wrap);
-BVR_H_FUNC int bvr_create_texture(bvr_texture_t* texture, const char* path, int filter, int wrap){
+int bvr_create_texturef(bvr_texture_t* texture, FILE* file, int filter, int wrap, int flags);
+BVR_H_FUNC int bvr_create_texture(bvr_texture_t* texture, const char* path, int filter, int wrap, int flags){
     BVR_FILE_EXISTS(path);
 
     bvr_uuid_t* id = bvr_register_asset(path, BVR_OPEN_READ);
@@ -204,7 +316,7 @@ BVR_H_FUNC int bvr_create_texture(bvr_texture_t* texture, const char* path, int
     }
 
     FILE* file = fopen(path, "rb");
-    int success = bvr_create_texturef(texture, file, filter, wrap);
+    int success = bvr_create_texturef(texture, file, filter, wrap, flags);
     fclose(file);
     return success;
 }
@@ -258,7 +370,34 @@ BVR_H_FUNC int bvr_create_layered_texture(bvr_layered_texture_t* texture, const
     return success;
 }
 
+/*
+    Decode and upload a layer if it hasn't been done yet.
+    PSD layers are only loaded on their first use.
+*/
+int bvr_layered_texture_load_layer(bvr_layered_texture_t* texture, uint32 layer);
+
 void bvr_layered_texture_enable(bvr_layered_texture_t* texture, int unit);
 void bvr_layered_texture_disable(void);
 
-void bvr_destroy_layered_texture(bvr_layered_texture_t* texture);
\ No newline at end of file
+void bvr_destroy_layered_texture(bvr_layered_texture_t* texture);
+
+/* THUMBNAILS */
+
+/*
+    Start thumbnails' worker thread.
+    `cache_path` is the directory where thumbnails are kept (must end with a separator).
+*/
+int bvr_create_thumbnail_generator(bvr_thumbnail_generator_t* generator, const char* cache_path);
+
+/*
+    Return asset's thumbnail and queue it if it does not exist yet.
+*/
+bvr_thumbnail_t* bvr_request_thumbnail(bvr_thumbnail_generator_t* generator, bvr_asset_t* asset);
+
+/*
+    Create finished thumbnails' textures. 
+    Must be called from the thread owning the graphic context.
+*/
+void bvr_thumbnail_generator_update(bvr_thumbnail_generator_t* generator);
+
+void bvr_destroy_thumbnail_generator(bvr_thumbnail_generator_t* generator);
\ No newline at end of file
@@ -4,6 +4,56 @@
 
 #include <BVR/utils.h>
 #include <BVR/buffer.h>
+#include <BVR/math.h>
+
+/*
+    Extension of the binary meshes cached next to their source.
+*/
+#ifndef BVR_MESH_CACHE_EXTENSION
+    #define BVR_MESH_CACHE_EXTENSION ".bvrm"
+#endif
+
+/*
+    Maximum number of levels of details of a mesh, including the full resolution one.
+    Each level halves the triangles of the previous one.
+*/
+#ifndef BVR_MESH_LOD_COUNT
+    #define BVR_MESH_LOD_COUNT 4
+#endif
+
+/*
+    Simplification error, in pixels, tolerated when selecting a mesh's level of details.
+*/
+#ifndef BVR_MESH_LOD_THRESHOLD
+    #define BVR_MESH_LOD_THRESHOLD 1.0f
+#endif
+
+/*
+    Meshes share a vertex and an element buffer per layout (attributes and vertex type) 
+    unless BVR_NO_MESH_ARENA is defined, so that a single vertex array serves all of them.
+    Shared buffers start at these sizes, in bytes, and double when they are full.
+*/
+#ifndef BVR_MESH_ARENA_VERTEX_SIZE
+    #define BVR_MESH_ARENA_VERTEX_SIZE (1 << 20)
+#endif
+
+#ifndef BVR_MESH_ARENA_ELEMENT_SIZE
+    #define BVR_MESH_ARENA_ELEMENT_SIZE (1 << 18)
+#endif
+
+/*
+    Maximum number of layouts with shared buffers.
+*/
+#ifndef BVR_MESH_ARENA_COUNT
+    #define BVR_MESH_ARENA_COUNT 16
+#endif
+
+/*
+    Time, in milliseconds, spent each frame creating the buffers of meshes loaded in background.
+*/
+#ifndef BVR_MESH_UPLOAD_BUDGET
+    #define BVR_MESH_UPLOAD_BUDGET 2.0f
+#endif
 
 typedef enum bvr_drawmode_e {
     BVR_DRAWMODE_LINES = 0x0001,
@@ -46,7 +96,40 @@ typedef enum bvr_mesh_array_attrib_e {
         uvs         -> vec2
         normals     -> vec3 
     */
-    BVR_MESH_ATTRIB_V3UV2N3
+    BVR_MESH_ATTRIB_V3UV2N3,
+
+    /*
+        Quantized layouts, float vertices are quantized when the mesh is created.
+        Positions are stored as normalized int16 relative to mesh's bounds, 
+        bvr_mesh_dequantization() gives the matrix bringing them back to model space.
+        UVs are stored as normalized uint16, and must be between 0 and 1.
+        Normals are octahedral encoded as two normalized int16 and must be decoded by the shader:
+
+        vec3 bvr_decode_normal(vec2 e) {
+            vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+            float t = max(-n.z, 0.0);
+            n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+            return normalize(n);
+        }
+    */
+
+    /*
+        vertices    -> snorm16 x3 (+ padding), 8 bytes
+    */
+    BVR_MESH_ATTRIB_V3_QUANTIZED,
+
+    /*
+        vertices    -> snorm16 x3 (+ padding)
+        uvs         -> unorm16 x2, 12 bytes
+    */
+    BVR_MESH_ATTRIB_V3UV2_QUANTIZED,
+
+    /*
+        vertices    -> snorm16 x3 (+ padding)
+        uvs         -> unorm16 x2
+        normals     -> octahedral snorm16 x2, 16 bytes
+    */
+    BVR_MESH_ATTRIB_V3UV2N3_QUANTIZED
 } bvr_mesh_array_attrib_t;
 
 typedef struct bvr_vertex_group_s {
@@ -54,6 +137,11 @@ typedef struct bvr_vertex_group_s {
 
     uint32 element_count;
     uint32 element_offset;
+
+    /*
+        Added to group's indices, on top of mesh's base vertex.
+    */
+    int32 base_vertex;
 } bvr_vertex_group_t;
 
 typedef struct bvr_mesh_s {
@@ -65,39 +153,191 @@ typedef struct bvr_mesh_s {
     uint32 element_count;
     struct bvr_buffer_s vertex_groups;
 
+    /*
+        Location of mesh's content inside the shared buffers, `base_vertex` must be added 
+        to each index and vertex groups' offsets start from `element_offset` (in elements).
+    */
+    int32 base_vertex;
+    uint32 element_offset;
+
+    int vertex_type;
     int element_type;
 
     bvr_mesh_array_attrib_t attrib;
 
     uint8 attrib_count;
     uint16 stride;
+
+    /*
+        Dequantization of quantized layouts' positions,
+        position = position_offset + quantized * position_scale.
+    */
+    vec3 position_offset;
+    vec3 position_scale;
+
+    /*
+        Levels of details, the first level is the mesh itself (vertex_groups).
+        Simplified levels are element ranges inside the same buffers, `lod_groups` holds 
+        a range for each vertex group of each level after the first one.
+        `lod_errors` is the largest distance, in model space, to the full resolution mesh.
+    */
+    uint8 lod_count;
+    float lod_errors[BVR_MESH_LOD_COUNT];
+    struct bvr_buffer_s lod_groups;
+
+    /*
+        Model space bounds (an AABB and a bounding sphere), computed when the mesh is created.
+    */
+    vec3 bounds_min;
+    vec3 bounds_max;
+    vec3 bounds_center;
+    float bounds_radius;
+
+    /*
+        Compact copy of vertices' positions in model space, `position_components` floats per vertex
+        (2 for 2D layouts, 3 otherwise), so that colliders or picking never read GPU memory back.
+        NULL when BVR_NO_MESH_POSITIONS is defined.
+    */
+    float* positions;
+    uint32 position_count;
+    uint8 position_components;
 } bvr_mesh_t;
 
+/*
+    Post-transform vertex cache efficiency of an index buffer, 
+    computed with a FIFO cache of BVR_MESH_CACHE_SIZE vertices.
+*/
+typedef struct bvr_mesh_statistics_s {
+    /*
+        Average cache miss ratio, transformed vertices per triangle (0.5 is great, 3 is the worst).
+    */
+    float acmr;
+
+    /*
+        Average transformed vertex ratio, transformed vertices per vertex (1 is ideal).
+    */
+    float atvr;
+} bvr_mesh_statistics_t;
+
 /*
     Create a new mesh by using raw vertices and indices data
 */
 int bvr_create_meshv(bvr_mesh_t* mesh, bvr_mesh_buffer_t* vertices, bvr_mesh_buffer_t* elements, bvr_mesh_array_attrib_t attrib);
 
 /*
-    Create a new mesh by using a FILE
+    Create a new mesh by using a FILE.
+    Supports binary meshes (.bvrm), binary glTF (.glb) unless BVR_NO_GLTF is defined and OBJ unless BVR_NO_OBJ is defined.
+    glTF vertices are drawn straight from the file's buffer when all primitives can share one vertex array, 
+    such meshes are neither optimized nor cached.
 */
 int bvr_create_meshf(bvr_mesh_t* mesh, FILE* file, bvr_mesh_array_attrib_t attrib);
 
 /*
-    Create a new mesh from path
+    Create a new mesh from path.
+    Unless BVR_NO_MESH_CACHE is defined, a binary copy of the mesh is saved next to the source 
+    (path + BVR_MESH_CACHE_EXTENSION) and loaded instead while the source doesn't change.
+*/
+int bvr_create_mesh(bvr_mesh_t* mesh, const char* path, bvr_mesh_array_attrib_t attrib);
+
+/*
+    Load a mesh from path on a background thread, its buffers are created by the render thread 
+    in bvr_new_frame. The mesh is empty until then, and must stay at the same address.
 */
-BVR_H_FUNC int bvr_create_mesh(bvr_mesh_t* mesh, const char* path, bvr_mesh_array_attrib_t attrib){
-    BVR_FILE_EXISTS(path);
-    FILE* file = fopen(path, "rb");
-    int status = bvr_create_meshf(mesh, file, attrib);
-    fclose(file);
-    return status;
+int bvr_create_mesh_async(bvr_mesh_t* mesh, const char* path, bvr_mesh_array_attrib_t attrib);
+
+/*
+    Return true while a mesh created with bvr_create_mesh_async is not loaded yet.
+*/
+int bvr_is_mesh_loading(bvr_mesh_t* mesh);
+
+/*
+    Create the buffers of meshes loaded in background, for about `budget` milliseconds.
+*/
+void bvr_update_mesh_loader(float budget);
+
+/*
+    Write a mesh as a binary mesh (.bvrm), that can be loaded back with bvr_create_meshf.
+*/
+int bvr_write_mesh(bvr_mesh_t* mesh, FILE* file);
+
+/*
+    Compute the vertex cache statistics of an index buffer (BVR_UNSIGNED_INT16 or BVR_UNSIGNED_INT32).
+    Loaded 3D meshes are optimized for the vertex cache, for overdraw and for vertex fetches unless 
+    BVR_NO_MESH_OPTIMIZATION is defined, define BVR_MESH_STATISTICS to print the gains.
+    Their levels of details are generated as well unless BVR_NO_MESH_LOD is defined.
+*/
+void bvr_mesh_statistics(bvr_mesh_statistics_t* statistics, const void* elements, int element_type, 
+    uint32 element_count, uint32 vertex_count);
+
+/*
+    Get the matrix bringing mesh's positions back to model space, 
+    identity for unquantized layouts.
+*/
+BVR_H_FUNC void bvr_mesh_dequantization(bvr_mesh_t* mesh, mat4x4 result){
+    BVR_IDENTITY_MAT4(result);
+
+    result[0][0] = mesh->position_scale[0];
+    result[1][1] = mesh->position_scale[1];
+    result[2][2] = mesh->position_scale[2];
+    result[3][0] = mesh->position_offset[0];
+    result[3][1] = mesh->position_offset[1];
+    result[3][2] = mesh->position_offset[2];
+}
+
+BVR_H_FUNC int bvr_is_mesh_quantized(bvr_mesh_t* mesh){
+    return mesh->attrib >= BVR_MESH_ATTRIB_V3_QUANTIZED;
+}
+
+/*
+    Get the element range of a vertex group at a level of details.
+*/
+BVR_H_FUNC bvr_vertex_group_t* bvr_mesh_get_lod_group(bvr_mesh_t* mesh, uint32 lod, uint64 group){
+    if(!lod){
+        return &((bvr_vertex_group_t*)mesh->vertex_groups.data)[group];
+    }
+
+    return &((bvr_vertex_group_t*)mesh->lod_groups.data)[(lod - 1) * BVR_BUFFER_COUNT(mesh->vertex_groups) + group];
+}
+
+/*
+    Select the coarsest level of details whose error stays under BVR_MESH_LOD_THRESHOLD pixels, 
+    `pixels_per_unit` being the projected size of a model space unit.
+*/
+BVR_H_FUNC uint32 bvr_mesh_select_lod(bvr_mesh_t* mesh, float pixels_per_unit){
+    uint32 lod = 0;
+    while (lod + 1 < mesh->lod_count && mesh->lod_errors[lod + 1] * pixels_per_unit <= BVR_MESH_LOD_THRESHOLD)
+    {
+        lod++;
+    }
+    
+    return lod;
 }
 
+/*
+    Triangulate a simple polygon made of float vertices, `stride` being the number of floats per vertex
+    (only x and y are used). `dest` receives the triangles as BVR_VEC2, its data must be freed.
+*/
 void bvr_triangulate(bvr_mesh_buffer_t* src, bvr_mesh_buffer_t* dest, const uint8 stride);
 
+/*
+    Triangulate a polygon with holes, `holes` being the index of the first vertex of each hole.
+    The outer ring is made of the vertices before the first hole.
+*/
+void bvr_triangulate_with_holes(bvr_mesh_buffer_t* src, const uint32* holes, uint32 hole_count, 
+    bvr_mesh_buffer_t* dest, const uint8 stride);
+
 void bvr_destroy_mesh(bvr_mesh_t* mesh);
 
+/*
+    Release the buffers shared by meshes, called when the book is destroyed.
+*/
+void bvr_destroy_mesh_arenas(void);
+
+/*
+    Stop the background mesh loader, meshes that are not loaded yet stay empty.
+*/
+void bvr_destroy_mesh_loader(void);
+
 #ifdef BVR_GEOMETRY_IMPLEMENTATION
 
 BVR_H_FUNC void bvr_create_2d_square_mesh(bvr_mesh_t* mesh, float width, float height){
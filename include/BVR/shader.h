@@ -11,6 +11,15 @@
 #define BVR_UNIFORM_TRANSFORM_NAME "bvr_transform"
 #define BVR_UNIFORM_GLOBAL_ILLUMINATION_NAME "bvr_global_illumination"
 
+/*
+    Per instance attributes read by instanced shaders, the transform takes four locations.
+*/
+#define BVR_ATTRIBUTE_INSTANCE_TRANSFORM_NAME "bvr_instance_transform"
+#define BVR_ATTRIBUTE_INSTANCE_LAYER_NAME "bvr_instance_layer"
+
+#define BVR_ATTRIBUTE_INSTANCE_TRANSFORM    0x8
+#define BVR_ATTRIBUTE_INSTANCE_LAYER        0xC
+
 #define BVR_UNIFORM_BLOCK_CAMERA                0x0
 #define BVR_UNIFORM_BLOCK_GLOBAL_ILLUMINATION   0x1
 
@@ -22,6 +31,12 @@
 #define BVR_FRAGMENT_SHADER 0x002
 #define BVR_FRAMEBUFFER_SHADER 0x004
 
+/*
+    Set on shaders whose vertex stage reads `bvr_instance_transform` instead of `bvr_transform`, 
+    their draw commands can be merged into instanced draws.
+*/
+#define BVR_INSTANCED_SHADER 0x008
+
 typedef struct bvr_shader_uniform_s {
     struct bvr_buffer_s memory;
 
@@ -92,6 +107,11 @@ void bvr_destroy_uniform_buffer(uint32* buffer);
 int bvri_create_shader_vert_frag(bvr_shader_t* shader, const char* vert, const char* frag);
 
 bvr_shader_uniform_t* bvr_shader_register_uniform(bvr_shader_t* shader, int type, int count, const char* name);
+
+/*
+    Register a texture uniform, `layer_name` is the layer's uniform of array textures.
+    It can be NULL for instanced shaders, which read the layer from `bvr_instance_layer`.
+*/
 bvr_shader_uniform_t* bvr_shader_register_texture(bvr_shader_t* shader, int type, int* id, int* layer, const char* name, const char* layer_name);
 bvr_shader_block_t* bvr_shader_register_block(bvr_shader_t* shader, const char* name, int type, int count, int index);
 
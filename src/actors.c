@@ -2,6 +2,7 @@
 
 #include <BVR/file.h>
 #include <BVR/graphics.h>
+#include <BVR/scene.h>
 
 #include <stdlib.h>
 #include <math.h>
@@ -35,6 +36,29 @@ static void bvri_update_transform(struct bvr_actor_s* actor){
     mat4_mul(actor->transform.matrix, actor->transform.matrix, rotation_mat);
 }
 
+/*
+    Get the size in pixels of a model space unit of the actor, as seen by the page's camera.
+*/
+static float bvri_get_pixels_per_unit(struct bvr_actor_s* actor){
+    bvr_camera_t* camera = &bvr_get_book_instance()->page.camera;
+    if(!camera->framebuffer){
+        return 0.0f;
+    }
+
+    float pixels = actor->transform.scale[0] * camera->framebuffer->height * 0.5f;
+
+    if(camera->mode == BVR_CAMERA_ORTHOGRAPHIC){
+        return pixels * camera->field_of_view.scale / camera->framebuffer->target_height;
+    }
+
+    // perspective field of view is in degrees
+    vec3 direction;
+    vec3_sub(direction, actor->transform.position, camera->transform.position);
+
+    float distance = vec3_len(direction) * tanf(deg_to_rad(camera->field_of_view.fov) * 0.5f);
+    return distance > 0.0f ? pixels / distance : pixels;
+}
+
 /*
     Generic contructor for dynamics actors
 */
@@ -67,38 +91,21 @@ static void bvri_create_dynamic_actor(bvr_dynamic_actor_t* actor, int flags){
 
     // generate bounding boxes by using mesh's vertices
     if(BVR_HAS_FLAG(flags, BVR_DYNACTOR_CREATE_COLLIDER_FROM_BOUNDS)){
-        if(actor->mesh.attrib == BVR_MESH_ATTRIB_V3 || 
-            actor->mesh.attrib == BVR_MESH_ATTRIB_V3UV2){
+        if(actor->mesh.attrib != BVR_MESH_ATTRIB_V2 && 
+            actor->mesh.attrib != BVR_MESH_ATTRIB_V2UV2){
             
             BVR_PRINT("cannot generate bounding box for 3d meshes!");
         }
-        else if (actor->mesh.vertex_buffer) {
+        else if (actor->mesh.position_components) {
             actor->collider.shape = BVR_COLLIDER_BOX;
 
-            float *vertices = NULL;
             struct bvr_bounds_s bounds;
 
-            // get a pointer to mesh's vertices
-            glBindBuffer(GL_ARRAY_BUFFER, actor->mesh.vertex_buffer);
-            vertices = glMapBufferRange(GL_ARRAY_BUFFER, 0, actor->mesh.vertex_count, GL_MAP_READ_BIT);
-            BVR_ASSERT(vertices);
-
             vec2_copy(bounds.coords, actor->object.transform.position);
-            bounds.width = 0;
-            bounds.height = 0;
 
-            // get max bounds
-            for (uint64 i = 0; i < actor->mesh.vertex_count; i += actor->mesh.stride)
-            {
-                if (abs(vertices[i + 0] * 2) > bounds.width)
-                {
-                    bounds.width = abs(vertices[i + 0] * 2);
-                }
-                if (abs(vertices[i + 1] * 2) > bounds.height)
-                {
-                    bounds.height = abs(vertices[i + 1] * 2);
-                }
-            }
+            // bounds are centered on the actor, use mesh's largest extent
+            bounds.width = ceilf(fmaxf(fabsf(actor->mesh.bounds_min[0]), fabsf(actor->mesh.bounds_max[0])) * 2);
+            bounds.height = ceilf(fmaxf(fabsf(actor->mesh.bounds_min[1]), fabsf(actor->mesh.bounds_max[1])) * 2);
 
             // allocate geometry
             actor->collider.geometry.elemsize = sizeof(struct bvr_bounds_s);
@@ -107,51 +114,38 @@ static void bvri_create_dynamic_actor(bvr_dynamic_actor_t* actor, int flags){
             BVR_ASSERT(actor->collider.geometry.data);
 
             memcpy(actor->collider.geometry.data, &bounds, actor->collider.geometry.size);
-
-            glUnmapBuffer(GL_ARRAY_BUFFER);
-            glBindBuffer(GL_ARRAY_BUFFER, 0);
         }
         else {
-            BVR_PRINT("failed to copy vertices data!");
+            BVR_PRINT("failed to get mesh bounds!");
         }
     }
 
-   
     if(BVR_HAS_FLAG(flags, BVR_DYNACTOR_TRIANGULATE_COLLIDER_FROM_VERTICES)){
-        if(actor->mesh.attrib == BVR_MESH_ATTRIB_V3 || 
-            actor->mesh.attrib == BVR_MESH_ATTRIB_V3UV2){
+        if(actor->mesh.attrib != BVR_MESH_ATTRIB_V2 && 
+            actor->mesh.attrib != BVR_MESH_ATTRIB_V2UV2){
             
             BVR_PRINT("cannot triangulate mesh for 3d meshes!");
         }
-        else if(actor->mesh.vertex_buffer) {
+        else if(actor->mesh.positions) {
             actor->collider.shape = BVR_COLLIDER_TRIARRAY;
-            char* vmap;
-
-            // get raw data
-            glBindBuffer(GL_ARRAY_BUFFER, actor->mesh.vertex_buffer);
-            vmap = glMapBufferRange(GL_ARRAY_BUFFER, 0, actor->mesh.vertex_count, GL_MAP_READ_BIT);
-            BVR_ASSERT(vmap);
 
             bvr_mesh_buffer_t sbuf, tbuf;
             sbuf.type = BVR_FLOAT;
             tbuf.type = BVR_FLOAT;
             tbuf.count = 0;
-            sbuf.count = actor->mesh.vertex_count;
+            sbuf.count = actor->mesh.position_count * actor->mesh.position_components;
             tbuf.data = NULL;
-            sbuf.data = vmap;
+            sbuf.data = (char*)actor->mesh.positions;
 
-            bvr_triangulate(&sbuf, &tbuf, 2);
-            
-            glUnmapBuffer(GL_ARRAY_BUFFER);
-            glBindBuffer(GL_ARRAY_BUFFER, 0);
+            bvr_triangulate(&sbuf, &tbuf, actor->mesh.position_components);
 
             // allocate and copy geometry
             actor->collider.geometry.elemsize = sizeof(vec2) * 3;
-            actor->collider.geometry.size = tbuf.count * sizeof(float);
-            actor->collider.geometry.data = malloc(actor->collider.geometry.size);
-            BVR_ASSERT(actor->collider.geometry.data);
-
-            memcpy(actor->collider.geometry.data, tbuf.data, actor->collider.geometry.size);
+            actor->collider.geometry.size = tbuf.count * sizeof(vec2);
+            actor->collider.geometry.data = tbuf.data;
+        }
+        else {
+            BVR_PRINT("mesh does not keep its vertices, cannot triangulate!");
         }
     }
 }
@@ -346,20 +340,22 @@ static void bvri_draw_layer_actor(bvr_layer_actor_t* actor){
     bvr_shader_uniform_t* texture;
 
     bvri_update_transform(&actor->object);
-    bvr_shader_enable(&actor->shader);
 
-    for (int layer = BVR_BUFFER_COUNT(actor->texture.image.layers); layer >= 0; layer--)
+    for (int layer = BVR_BUFFER_COUNT(actor->texture.image.layers) - 1; layer >= 0; layer--)
     {
         if(!(((bvr_layer_t*)actor->texture.image.layers.data)[layer]).opacity){
             continue;
         }
 
+        // hidden layers are never decoded
+        if(!bvr_layered_texture_load_layer(&actor->texture, layer)){
+            continue;
+        }
+
         texture = bvr_find_uniform(&actor->shader, "bvr_texture");
 
         bvr_shader_set_texturei(texture, NULL, &layer);
 
-        bvr_shader_use_uniform(&actor->shader.uniforms[0], &actor->object.transform.matrix[0][0]);
-
         cmd.order = actor->object.order_in_layer + layer * 2;
         cmd.array_buffer = actor->mesh.array_buffer;
         cmd.vertex_buffer = actor->mesh.vertex_buffer;
@@ -371,17 +367,16 @@ static void bvri_draw_layer_actor(bvr_layer_actor_t* actor){
         cmd.texture = (bvr_texture_t*)&actor->texture;
         cmd.draw_mode = BVR_DRAWMODE_TRIANGLES;
         cmd.element_count = actor->mesh.element_count;
-        cmd.element_offset = 0;
-
-        cmd.user_data = malloc(sizeof(int));
-        BVR_ASSERT(cmd.user_data);
+        cmd.element_type = actor->mesh.element_type;
+        cmd.base_vertex = actor->mesh.base_vertex;
+        cmd.element_offset = actor->mesh.element_offset;
+        memcpy(cmd.transform, actor->object.transform.matrix, sizeof(mat4x4));
 
-        memcpy(cmd.user_data, &layer, sizeof(int));
+        cmd.payload_type = BVR_DRAW_PAYLOAD_LAYER;
+        cmd.payload.layer = layer;
 
         bvr_pipeline_add_draw_cmd(&cmd);
     }
-
-    bvr_shader_disable();
 }
 
 void bvr_draw_actor(struct bvr_actor_s* actor, int drawmode){
@@ -406,10 +401,20 @@ void bvr_draw_actor(struct bvr_actor_s* actor, int drawmode){
 
     bvr_static_actor_t* sactor = (bvr_static_actor_t*)actor;
 
-    bvr_shader_enable(&sactor->shader);
-    bvr_shader_use_uniform(&sactor->shader.uniforms[0], &actor->transform.matrix[0][0]);
-
     struct bvr_draw_command_s cmd;
+
+    // quantized positions are brought back to model space by the transform
+    if(bvr_is_mesh_quantized(&sactor->mesh)){
+        mat4x4 model;
+        bvr_mesh_dequantization(&sactor->mesh, model);
+        mat4_mul(model, actor->transform.matrix, model);
+
+        memcpy(cmd.transform, model, sizeof(mat4x4));
+    }
+    else {
+        memcpy(cmd.transform, actor->transform.matrix, sizeof(mat4x4));
+    }
+
     cmd.order = actor->order_in_layer;
     cmd.array_buffer = sactor->mesh.array_buffer;
     cmd.vertex_buffer = sactor->mesh.vertex_buffer;
@@ -420,15 +425,22 @@ void bvr_draw_actor(struct bvr_actor_s* actor, int drawmode){
     cmd.texture = NULL;
     cmd.texture_type = 0;
     cmd.draw_mode = drawmode;
-    cmd.user_data = NULL;
+    cmd.element_type = sactor->mesh.element_type;
+    cmd.payload_type = BVR_DRAW_PAYLOAD_NONE;
+
+    // small or distant actors are drawn with a simplified level of details
+    uint32 lod = 0;
+    if(sactor->mesh.lod_count > 1){
+        lod = bvr_mesh_select_lod(&sactor->mesh, bvri_get_pixels_per_unit(actor));
+    }
 
     for (uint64 i = 0; i < BVR_BUFFER_COUNT(sactor->mesh.vertex_groups); i++)
     {
-        cmd.element_offset = ((bvr_vertex_group_t*)sactor->mesh.vertex_groups.data)[i].element_offset;
-        cmd.element_count = ((bvr_vertex_group_t*)sactor->mesh.vertex_groups.data)[i].element_count;
+        bvr_vertex_group_t* group = bvr_mesh_get_lod_group(&sactor->mesh, lod, i);
+
+        cmd.base_vertex = sactor->mesh.base_vertex + group->base_vertex;
+        cmd.element_offset = sactor->mesh.element_offset + group->element_offset;
+        cmd.element_count = group->element_count;
         bvr_pipeline_add_draw_cmd(&cmd);
     }
-    
-
-    bvr_shader_disable();
 }
\ No newline at end of file
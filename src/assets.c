@@ -118,30 +118,28 @@ int bvr_find_asset_uuid(bvr_uuid_t uuid, bvr_asset_t* asset){
 
     uint16 string_length;
     bvr_uuid_t other;
-    const char* prev_cursor = book->asset_stream.cursor;
+    char* prev_cursor = book->asset_stream.cursor;
 
+    bvr_memstream_seek(&book->asset_stream, 0, SEEK_SET);
     while (book->asset_stream.cursor < prev_cursor)
     {
         bvr_memstream_read(&book->asset_stream, &other, sizeof(bvr_uuid_t));
+        string_length = *((uint16*)book->asset_stream.cursor);
 
         if(bvr_uuid_equals(other, uuid)){
-            
-            string_length = *((uint16*)book->asset_stream.cursor);
+            memcpy(&asset->id, other, sizeof(bvr_uuid_t));
             asset->path.length = string_length;
             asset->path.string = book->asset_stream.cursor + sizeof(unsigned short);
-            
-            book->asset_stream.cursor += string_length;
-            asset->open_mode = *book->asset_stream.cursor;
+            asset->open_mode = *(book->asset_stream.cursor + sizeof(unsigned short) + string_length);
 
+            book->asset_stream.cursor = prev_cursor;
             return BVR_OK;
         }
 
-        book->asset_stream.cursor += sizeof(bvr_uuid_t);
-        string_length = *((uint16*)book->asset_stream.cursor);
-
-        bvr_memstream_seek(&book->asset_stream, sizeof(uint16) + sizeof(char) + string_length, SEEK_CUR);
+        bvr_memstream_seek(&book->asset_stream, sizeof(uint16) + string_length + sizeof(char), SEEK_CUR);
     }
     
+    book->asset_stream.cursor = prev_cursor;
     return BVR_FAILED;
 }
 
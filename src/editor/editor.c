@@ -22,11 +22,11 @@
 #define BVR_HIERARCHY_RECT(width, height) (nk_rect(50, 50, width, height))
 #define BVR_INSPECTOR_RECT(width, height) (nk_rect(350, 50, width, height))
 
-static int bvri_create_editor_render_buffers(uint32* array_buffer, uint32* vertex_buffer, uint64 vertex_size);
-static void bvri_bind_editor_buffers(uint32 array_buffer, uint32 vertex_buffer);
-static void bvri_set_editor_buffers(float* vertices, uint32 vertices_count, uint8 stride);
+static int bvri_create_editor_render_buffers(uint32* array_buffer, bvr_dynamic_buffer_t* vertex_buffer, uint64 vertex_size);
+static void bvri_bind_editor_buffers(uint32 array_buffer);
+static uint32 bvri_set_editor_buffers(float* vertices, uint32 vertices_count, uint8 stride);
 static void bvri_draw_editor_buffer(int drawmode, uint32 element_offset, uint32 element_count); 
-static void bvri_destroy_editor_render_buffers(uint32* array_buffer, uint32* vertex_buffer);
+static void bvri_destroy_editor_render_buffers(uint32* array_buffer, bvr_dynamic_buffer_t* vertex_buffer);
 
 static bvr_editor_t* __editor = NULL;
 
@@ -85,6 +85,19 @@ static void bvri_draw_editor_image(bvr_image_t* image){
 
     nk_label(__editor->gui.context, "Image", NK_TEXT_ALIGN_CENTERED);
     nk_label_wrap(__editor->gui.context, image->asset.pointer.asset_id);
+
+    // preview is generated in background
+    bvr_asset_t asset;
+    if(image->asset.origin == BVR_ASSET_ORIGIN_PATH && bvr_find_asset_uuid(image->asset.pointer.asset_id, &asset)){
+        bvr_thumbnail_t* thumbnail = bvr_request_thumbnail(&__editor->thumbnails, &asset);
+
+        if(thumbnail && thumbnail->texture.id){
+            nk_layout_row_static(__editor->gui.context, 
+                thumbnail->texture.image.height, thumbnail->texture.image.width, 1
+            );
+            nk_image(__editor->gui.context, nk_image_id(thumbnail->texture.id));
+        }
+    }
 }
 
 static void bvri_draw_editor_shader(bvr_shader_t* shader){
@@ -180,12 +193,14 @@ void bvr_create_editor(bvr_editor_t* editor, bvr_book_t* book){
     
     bvr_create_string(&editor->inspector_cmd.name, NULL);
     bvr_create_nuklear(&editor->gui, &book->window);
+    bvr_create_thumbnail_generator(&editor->thumbnails, BVR_EDITOR_THUMBNAIL_PATH);
 }
 
 void bvr_editor_handle(){
     BVR_ASSERT(__editor);
 
     bvr_nuklear_handle(&__editor->gui);
+    bvr_thumbnail_generator_update(&__editor->thumbnails);
     
     if(bvr_key_down(BVR_EDITOR_HIDDEN_INPUT)){
         __editor->state = BVR_EDITOR_STATE_HIDDEN;
@@ -632,12 +647,8 @@ void bvr_editor_draw_inspector(){
                                 bounds->coords[0] + bounds->width * -0.5f, bounds->coords[1] + bounds->height * +0.5f, 0.1f,
                             };
                         
-                            bvri_bind_editor_buffers(__editor->device.array_buffer, __editor->device.vertex_buffer);
-                            bvri_set_editor_buffers(vertices, 5, 3);
-                            bvri_bind_editor_buffers(0, 0);
-                        
                             __editor->draw_cmd.drawmode = BVR_DRAWMODE_LINE_STRIPE;
-                            __editor->draw_cmd.element_offset = 0;
+                            __editor->draw_cmd.element_offset = bvri_set_editor_buffers(vertices, 5, 3);
                             __editor->draw_cmd.element_count = 5;
                         }
                         
@@ -658,12 +669,9 @@ void bvr_editor_draw_inspector(){
                         vec2* tri = (vec2*)collider->geometry.data;
 
                         {
-                            bvri_bind_editor_buffers(__editor->device.array_buffer, __editor->device.vertex_buffer);
-                            bvri_set_editor_buffers(collider->geometry.data, collider->geometry.size / sizeof(vec2), 2);
-                            bvri_bind_editor_buffers(0, 0);
-                        
                             __editor->draw_cmd.drawmode = BVR_DRAWMODE_LINE_STRIPE;
-                            __editor->draw_cmd.element_offset = 0;
+                            __editor->draw_cmd.element_offset = bvri_set_editor_buffers(collider->geometry.data, 
+                                collider->geometry.size / sizeof(vec2), 2);
                             __editor->draw_cmd.element_count = collider->geometry.size / sizeof(vec2);
                         }
 
@@ -711,35 +719,39 @@ void bvr_editor_render(){
     if(__editor->draw_cmd.drawmode){
         bvr_shader_enable(&__editor->device.shader);
 
-        bvri_bind_editor_buffers(__editor->device.array_buffer, __editor->device.vertex_buffer);
+        bvri_bind_editor_buffers(__editor->device.array_buffer);
         bvri_draw_editor_buffer(__editor->draw_cmd.drawmode, __editor->draw_cmd.element_offset, __editor->draw_cmd.element_count);
-        bvri_bind_editor_buffers(0, 0);
+        bvri_bind_editor_buffers(0);
 
         bvr_shader_disable();
     }
 
+    // geometry is written again by the next frame
+    bvr_dynamic_buffer_next_frame(&__editor->device.vertex_buffer);
+    __editor->draw_cmd.drawmode = 0;
+
     bvr_nuklear_render(&__editor->gui);
 }
 
 void bvr_destroy_editor(bvr_editor_t* editor){
+    bvri_destroy_editor_render_buffers(&editor->device.array_buffer, &editor->device.vertex_buffer);
+    bvr_destroy_thumbnail_generator(&editor->thumbnails);
     bvr_destroy_string(&editor->inspector_cmd.name);
     bvr_destroy_nuklear(&editor->gui);
 }
 
-int bvri_create_editor_render_buffers(uint32* array_buffer, uint32* vertex_buffer, uint64 vertex_size){
+int bvri_create_editor_render_buffers(uint32* array_buffer, bvr_dynamic_buffer_t* vertex_buffer, uint64 vertex_size){
     BVR_ASSERT(vertex_buffer);
 
-    glGenVertexArrays(1, array_buffer);
-    glGenBuffers(1, vertex_buffer);
+    bvr_create_dynamic_buffer(vertex_buffer, vertex_size * sizeof(float));
 
+    // vertices are always vec3, so that the attribute is only defined once
+    glGenVertexArrays(1, array_buffer);
     glBindVertexArray(*array_buffer);
-    glBindBuffer(GL_ARRAY_BUFFER, *vertex_buffer);
-
-    glBufferData(GL_ARRAY_BUFFER, vertex_size * sizeof(float), NULL, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer->buffer);
 
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(vec3), (void*)0);
-    glDisableVertexAttribArray(0);
 
     glBindVertexArray(0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
@@ -747,27 +759,42 @@ int bvri_create_editor_render_buffers(uint32* array_buffer, uint32* vertex_buffe
     return BVR_OK;
 }
 
-void bvri_bind_editor_buffers(uint32 array_buffer, uint32 vertex_buffer){
+void bvri_bind_editor_buffers(uint32 array_buffer){
     glBindVertexArray(array_buffer);
-    glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
 }
 
-void bvri_set_editor_buffers(float* vertices, uint32 vertices_count, uint8 stride){
-    glBufferSubData(GL_ARRAY_BUFFER, 0, vertices_count * stride * sizeof(float), vertices);
+/*
+    Append vertices to this frame's geometry, returns the index of the first one.
+*/
+uint32 bvri_set_editor_buffers(float* vertices, uint32 vertices_count, uint8 stride){
+    bvr_dynamic_range_t range;
     
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, stride, GL_FLOAT, GL_FALSE, stride * sizeof(float), (void*)0);
-    glDisableVertexAttribArray(0);
+    float* target = bvr_dynamic_buffer_map(&__editor->device.vertex_buffer, 
+        vertices_count * sizeof(vec3), sizeof(vec3), &range);
     
+    // nothing is drawn if the vertices don't fit
+    if(!target){
+        __editor->draw_cmd.drawmode = 0;
+        return 0;
+    }
+
+    for (uint64 i = 0; i < vertices_count; i++)
+    {
+        target[i * 3 + 0] = vertices[i * stride + 0];
+        target[i * 3 + 1] = vertices[i * stride + 1];
+        target[i * 3 + 2] = stride > 2 ? vertices[i * stride + 2] : 0.0f;
+    }
+
+    bvr_dynamic_buffer_unmap(&__editor->device.vertex_buffer);
+
+    return range.offset / sizeof(vec3);
 }
 
 void bvri_draw_editor_buffer(int drawmode, uint32 element_offset, uint32 element_count){
-    glEnableVertexAttribArray(0);
     glDrawArrays(drawmode, element_offset, element_count);
-    glDisableVertexAttribArray(0);
 }
 
-void bvri_destroy_editor_render_buffers(uint32* array_buffer, uint32* vertex_buffer){
+void bvri_destroy_editor_render_buffers(uint32* array_buffer, bvr_dynamic_buffer_t* vertex_buffer){
     glDeleteVertexArrays(1, array_buffer);
-    glDeleteBuffers(1, vertex_buffer);
+    bvr_destroy_dynamic_buffer(vertex_buffer);
 }
\ No newline at end of file
@@ -4,6 +4,13 @@
 #include <malloc.h>
 #include <memory.h>
 
+#ifdef _WIN32
+    #include <Windows.h>
+    #include <io.h>
+#else
+    #include <sys/mman.h>
+#endif
+
 uint64 bvr_get_file_size(FILE* file){
     uint64 currp = ftell(file);
     fseek(file, 0, SEEK_END);
@@ -12,6 +19,69 @@ uint64 bvr_get_file_size(FILE* file){
     return size;
 }
 
+int bvr_map_file(bvr_file_view_t* view, FILE* file){
+    BVR_ASSERT(view);
+    BVR_ASSERT(file);
+
+    view->data = NULL;
+    view->mapped = 0;
+
+    fseek(file, 0, SEEK_SET);
+    view->size = bvr_get_file_size(file);
+    if(!view->size){
+        return BVR_FAILED;
+    }
+
+#ifdef _WIN32
+    HANDLE mapping = CreateFileMappingA((HANDLE)_get_osfhandle(_fileno(file)), NULL, PAGE_READONLY, 0, 0, NULL);
+    if(mapping){
+        view->data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);
+    }
+#else
+    void* data = mmap(NULL, view->size, PROT_READ, MAP_PRIVATE, fileno(file), 0);
+    if(data != MAP_FAILED){
+        view->data = data;
+    }
+#endif
+
+    if(view->data){
+        view->mapped = 1;
+        return BVR_OK;
+    }
+
+    // fallback on a copy
+    view->data = malloc(view->size);
+    BVR_ASSERT(view->data);
+
+    if(fread(view->data, sizeof(char), view->size, file) != view->size){
+        free(view->data);
+        view->data = NULL;
+        return BVR_FAILED;
+    }
+
+    return BVR_OK;
+}
+
+void bvr_unmap_file(bvr_file_view_t* view){
+    BVR_ASSERT(view);
+
+    if(view->mapped){
+#ifdef _WIN32
+        UnmapViewOfFile(view->data);
+#else
+        munmap(view->data, view->size);
+#endif
+    }
+    else {
+        free(view->data);
+    }
+
+    view->data = NULL;
+    view->size = 0;
+    view->mapped = 0;
+}
+
 int bvr_read_file(bvr_string_t* string, FILE* file){
     BVR_ASSERT(string);
     BVR_ASSERT(file);
@@ -12,7 +12,12 @@
 void bvr_pipeline_state_enable(struct bvr_pipeline_state_s* const state){
     BVR_ASSERT(state);
 
-    if(state->blending){
+    struct bvr_pipeline_cache_s* cache = &bvr_get_book_instance()->pipeline.cache;
+
+    if(state->blending == cache->blending){
+        cache->elided_calls++;
+    }
+    else if(state->blending){
         glEnable(GL_BLEND);
         switch(state->blending)
         {
@@ -34,7 +39,15 @@ void bvr_pipeline_state_enable(struct bvr_pipeline_state_s* const state){
         glDisable(GL_BLEND);
     }
 
-    if(state->depth){
+    if(state->blending != cache->blending){
+        cache->blending = state->blending;
+        cache->issued_calls++;
+    }
+
+    if(state->depth == cache->depth){
+        cache->elided_calls++;
+    }
+    else if(state->depth){
         glEnable(GL_DEPTH_TEST);
 
         switch (state->depth)
@@ -79,65 +92,563 @@ void bvr_pipeline_state_enable(struct bvr_pipeline_state_s* const state){
     else {
         glDisable(GL_DEPTH_TEST);
     }
+
+    if(state->depth != cache->depth){
+        cache->depth = state->depth;
+        cache->issued_calls++;
+    }
 }
 
-void bvr_pipeline_draw_cmd(struct bvr_draw_command_s* cmd){
-    bvr_shader_enable(cmd->shader);
+#define BVRI_UNKNOWN_STATE 0xFFFFFFFF
+
+void bvr_pipeline_use_program(uint32 program){
+    struct bvr_pipeline_cache_s* cache = &bvr_get_book_instance()->pipeline.cache;
+
+    if(cache->program == program){
+        cache->elided_calls++;
+        return;
+    }
+
+    glUseProgram(program);
+    cache->program = program;
+    cache->issued_calls++;
+}
+
+void bvr_pipeline_bind_texture(int unit, int target, uint32 texture){
+    struct bvr_pipeline_cache_s* cache = &bvr_get_book_instance()->pipeline.cache;
+    uint32 index = unit - BVR_TEXTURE_UNIT0;
+
+    BVR_ASSERT(index < BVR_PIPELINE_TEXTURE_UNITS);
+
+    if(cache->textures[index] == texture && cache->texture_targets[index] == (uint32)target){
+        cache->elided_calls++;
+        return;
+    }
+
+    if(cache->active_texture != (uint32)unit){
+        glActiveTexture(unit);
+        cache->active_texture = unit;
+        cache->issued_calls++;
+    }
+
+    glBindTexture(target, texture);
+    cache->textures[index] = texture;
+    cache->texture_targets[index] = target;
+    cache->issued_calls++;
+}
+
+void bvr_pipeline_bind_vertex_array(uint32 array_buffer){
+    struct bvr_pipeline_cache_s* cache = &bvr_get_book_instance()->pipeline.cache;
+
+    if(cache->array_buffer == array_buffer){
+        cache->elided_calls++;
+        return;
+    }
+
+    glBindVertexArray(array_buffer);
+    cache->array_buffer = array_buffer;
+    cache->issued_calls++;
+
+    // element buffer binding is part of the vertex array state
+    cache->element_buffer = BVRI_UNKNOWN_STATE;
+}
+
+void bvr_pipeline_bind_buffer(int target, uint32 buffer){
+    struct bvr_pipeline_cache_s* cache = &bvr_get_book_instance()->pipeline.cache;
+    uint32* binding = target == GL_ELEMENT_ARRAY_BUFFER ? &cache->element_buffer : &cache->vertex_buffer;
+
+    BVR_ASSERT(target == GL_ARRAY_BUFFER || target == GL_ELEMENT_ARRAY_BUFFER);
+
+    if(*binding == buffer){
+        cache->elided_calls++;
+        return;
+    }
+
+    glBindBuffer(target, buffer);
+    *binding = buffer;
+    cache->issued_calls++;
+}
+
+void bvr_pipeline_invalidate_cache(bvr_pipeline_t* pipeline, int all){
+    BVR_ASSERT(pipeline);
+
+    struct bvr_pipeline_cache_s* cache = &pipeline->cache;
+
+    cache->program = BVRI_UNKNOWN_STATE;
+    cache->active_texture = BVRI_UNKNOWN_STATE;
+    cache->array_buffer = BVRI_UNKNOWN_STATE;
+    cache->vertex_buffer = BVRI_UNKNOWN_STATE;
+    cache->element_buffer = BVRI_UNKNOWN_STATE;
+
+    for (uint32 i = 0; i < BVR_PIPELINE_TEXTURE_UNITS; i++)
+    {
+        cache->textures[i] = BVRI_UNKNOWN_STATE;
+        cache->texture_targets[i] = BVRI_UNKNOWN_STATE;
+    }
+
+    if(all){
+        cache->blending = -1;
+        cache->depth = -1;
+    }
+}
+
+/*
+    Per instance data of an instanced draw.
+*/
+struct bvri_instance_s {
+    mat4x4 transform;
+    int32 layer;
+} __attribute__ ((packed));
+
+/*
+    Bind command's program, uniforms, texture and buffers, everything but its transform.
+*/
+static void bvri_use_command_states(struct bvr_draw_command_s* cmd){
+    // uniforms are uploaded for each command, the program only when it changes
+    bvr_pipeline_use_program(cmd->shader->program);
+    for (uint64 uniform = 0; uniform < cmd->shader->uniform_count; uniform++)
+    {
+        bvr_shader_use_uniform(&cmd->shader->uniforms[uniform], NULL);
+    }
 
     // bind correct texture
     if(cmd->texture){
         if(cmd->texture_type == BVR_TEXTURE_2D){
-            bvr_texture_enable(cmd->texture, BVR_TEXTURE_UNIT0);
+            bvr_pipeline_bind_texture(BVR_TEXTURE_UNIT0, GL_TEXTURE_2D, cmd->texture->id);
         }
         else if(cmd->texture_type == BVR_TEXTURE_2D_ARRAY) {
-            bvr_texture_atlas_enablei((bvr_texture_atlas_t*)cmd->texture, BVR_TEXTURE_UNIT0);
+            bvr_pipeline_bind_texture(BVR_TEXTURE_UNIT0, GL_TEXTURE_2D_ARRAY, ((bvr_texture_atlas_t*)cmd->texture)->id);
+
+            // update layer index with command's payload
+            if(cmd->payload_type == BVR_DRAW_PAYLOAD_LAYER){
+                int layer = cmd->payload.layer;
 
-            // update layer index with user data
-            if(cmd->user_data){
-                bvr_shader_set_texture(cmd->shader, "bvr_texture", NULL, cmd->user_data);
+                bvr_shader_set_texture(cmd->shader, "bvr_texture", NULL, &layer);
                 bvr_shader_use_uniform(bvr_find_uniform(cmd->shader, "bvr_texture"), NULL);
-                
-                free(cmd->user_data);
-                cmd->user_data = NULL;
             }
         }
     }
 
-    glBindVertexArray(cmd->array_buffer);
-    glBindBuffer(GL_ARRAY_BUFFER, cmd->vertex_buffer);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, cmd->element_buffer);
+    bvr_pipeline_bind_vertex_array(cmd->array_buffer);
+    bvr_pipeline_bind_buffer(GL_ARRAY_BUFFER, cmd->vertex_buffer);
+    bvr_pipeline_bind_buffer(GL_ELEMENT_ARRAY_BUFFER, cmd->element_buffer);
+}
+
+void bvr_pipeline_draw_cmd(struct bvr_draw_command_s* cmd){
+    // commands are packed, copy the transform before handing it to OpenGL
+    mat4x4 transform;
+    memcpy(transform, cmd->transform, sizeof(mat4x4));
+
+    bvri_use_command_states(cmd);
+
+    // instanced shaders drawn alone read their instance attributes from constant values
+    if(BVR_HAS_FLAG(cmd->shader->flags, BVR_INSTANCED_SHADER)){
+        for (uint32 column = 0; column < 4; column++)
+        {
+            glVertexAttrib4fv(BVR_ATTRIBUTE_INSTANCE_TRANSFORM + column, transform[column]);
+        }
+
+        glVertexAttribI4i(BVR_ATTRIBUTE_INSTANCE_LAYER, 
+            cmd->payload_type == BVR_DRAW_PAYLOAD_LAYER ? cmd->payload.layer : 0, 0, 0, 0);
+    }
+    else {
+        bvr_shader_use_uniform(&cmd->shader->uniforms[0], &transform[0][0]);
+    }
 
     for (uint64 i = 0; i < cmd->attrib_count; i++)
     {
         glEnableVertexAttribArray(0);
     }
     
-    glDrawElements(cmd->draw_mode, cmd->element_count, GL_UNSIGNED_INT, (void*)cmd->element_offset);
+    // element offset is stored in elements, OpenGL wants bytes
+    glDrawElementsBaseVertex(cmd->draw_mode, cmd->element_count, cmd->element_type, 
+        (void*)((uint64)cmd->element_offset * bvr_sizeof(cmd->element_type)), cmd->base_vertex);
 
     for (uint64 i = 0; i < cmd->attrib_count; i++)
     {
         glEnableVertexAttribArray(1);
     }
+}
+
+/*
+    Compare shaders' uniforms, except the transform and textures which are part of the commands.
+*/
+static int bvri_same_uniforms(const bvr_shader_t* a, const bvr_shader_t* b){
+    if(a == b){
+        return 1;
+    }
+
+    if(a->program != b->program || a->uniform_count != b->uniform_count){
+        return 0;
+    }
+
+    for (uint64 i = 1; i < a->uniform_count; i++)
+    {
+        const bvr_shader_uniform_t* ua = &a->uniforms[i];
+        const bvr_shader_uniform_t* ub = &b->uniforms[i];
+
+        if(ua->location != ub->location || ua->type != ub->type || ua->memory.size != ub->memory.size){
+            return 0;
+        }
 
-    glBindVertexArray(cmd->array_buffer);
-    glBindBuffer(GL_ARRAY_BUFFER, cmd->vertex_buffer);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, cmd->element_buffer);
+        if(ua->type == BVR_TEXTURE_2D || ua->type == BVR_TEXTURE_2D_ARRAY){
+            continue;
+        }
 
-    // try to avoid mem leeks
-    if(cmd->user_data){
-        free(cmd->user_data);
-        cmd->user_data = NULL;
+        if(ua->memory.data != ub->memory.data && 
+            (!ua->memory.data || !ub->memory.data || memcmp(ua->memory.data, ub->memory.data, ua->memory.size))){
+            return 0;
+        }
     }
+
+    return 1;
+}
+
+static int bvri_can_instance(const struct bvr_draw_command_s* a, const struct bvr_draw_command_s* b){
+    return a->array_buffer == b->array_buffer &&
+        a->vertex_buffer == b->vertex_buffer &&
+        a->element_buffer == b->element_buffer &&
+        a->base_vertex == b->base_vertex &&
+        a->element_offset == b->element_offset &&
+        a->element_count == b->element_count &&
+        a->element_type == b->element_type &&
+        a->attrib_count == b->attrib_count &&
+        a->draw_mode == b->draw_mode &&
+        a->texture_type == b->texture_type &&
+        a->texture == b->texture &&
+        a->payload_type == b->payload_type &&
+        bvri_same_uniforms(a->shader, b->shader);
+}
+
+uint32 bvr_pipeline_instance_count(const struct bvr_draw_command_s* commands, const uint32* indices, uint32 count){
+    BVR_ASSERT(commands);
+    BVR_ASSERT(indices);
+
+    if(!count){
+        return 0;
+    }
+
+    // instance divisors are core since OpenGL 3.3
+    const struct bvr_draw_command_s* first = &commands[indices[0]];
+    if(!BVR_HAS_FLAG(first->shader->flags, BVR_INSTANCED_SHADER) || !glVertexAttribDivisor){
+        return 1;
+    }
+
+    uint32 limit = BVR_INSTANCE_BUFFER_SIZE / sizeof(struct bvri_instance_s);
+    count = count < limit ? count : limit;
+
+    // commands sharing states are next to each other once sorted
+    uint32 instances = 1;
+    while (instances < count && bvri_can_instance(first, &commands[indices[instances]]))
+    {
+        instances++;
+    }
+    
+    return instances;
+}
+
+void bvr_pipeline_draw_instanced(struct bvr_draw_command_s* commands, const uint32* indices, uint32 count){
+    BVR_ASSERT(commands);
+    BVR_ASSERT(indices);
+
+    bvr_pipeline_t* pipeline = &bvr_get_book_instance()->pipeline;
+    struct bvr_draw_command_s* cmd = &commands[indices[0]];
+
+    if(!pipeline->instances.buffer){
+        bvr_create_dynamic_buffer(&pipeline->instances, BVR_INSTANCE_BUFFER_SIZE);
+    }
+
+    bvr_dynamic_range_t range;
+    struct bvri_instance_s* instances = bvr_dynamic_buffer_map(&pipeline->instances, 
+        count * sizeof(struct bvri_instance_s), sizeof(float), &range);
+
+    // instance buffer is full for this frame
+    if(!instances){
+        for (uint32 i = 0; i < count; i++)
+        {
+            bvr_pipeline_draw_cmd(&commands[indices[i]]);
+        }
+
+        return;
+    }
+
+    for (uint32 i = 0; i < count; i++)
+    {
+        struct bvr_draw_command_s* instance = &commands[indices[i]];
+
+        memcpy(instances[i].transform, instance->transform, sizeof(mat4x4));
+        instances[i].layer = instance->payload_type == BVR_DRAW_PAYLOAD_LAYER ? instance->payload.layer : 0;
+    }
+
+    bvr_dynamic_buffer_unmap(&pipeline->instances);
+
+    bvri_use_command_states(cmd);
+
+    // instance attributes point to this draw's range, and are disabled afterward to leave the vertex array as it was
+    bvr_pipeline_bind_buffer(GL_ARRAY_BUFFER, range.buffer);
+    for (uint32 column = 0; column < 4; column++)
+    {
+        glEnableVertexAttribArray(BVR_ATTRIBUTE_INSTANCE_TRANSFORM + column);
+        glVertexAttribPointer(BVR_ATTRIBUTE_INSTANCE_TRANSFORM + column, 4, GL_FLOAT, GL_FALSE, 
+            sizeof(struct bvri_instance_s), (void*)(range.offset + column * sizeof(vec4)));
+        glVertexAttribDivisor(BVR_ATTRIBUTE_INSTANCE_TRANSFORM + column, 1);
+    }
+
+    glEnableVertexAttribArray(BVR_ATTRIBUTE_INSTANCE_LAYER);
+    glVertexAttribIPointer(BVR_ATTRIBUTE_INSTANCE_LAYER, 1, GL_INT, 
+        sizeof(struct bvri_instance_s), (void*)(range.offset + sizeof(mat4x4)));
+    glVertexAttribDivisor(BVR_ATTRIBUTE_INSTANCE_LAYER, 1);
+
+    glDrawElementsInstancedBaseVertex(cmd->draw_mode, cmd->element_count, cmd->element_type, 
+        (void*)((uint64)cmd->element_offset * bvr_sizeof(cmd->element_type)), count, cmd->base_vertex);
+
+    for (uint32 location = BVR_ATTRIBUTE_INSTANCE_TRANSFORM; location <= BVR_ATTRIBUTE_INSTANCE_LAYER; location++)
+    {
+        glDisableVertexAttribArray(location);
+    }
+
+    pipeline->statistics.instanced_draws++;
+    pipeline->statistics.instanced_commands += count;
+}
+
+/*
+    Double the command queue and its sort buffers, contents are kept.
+*/
+static int bvri_grow_command_queue(bvr_pipeline_t* pipeline){
+    uint32 capacity = pipeline->command_capacity ? pipeline->command_capacity * 2 : BVR_MAX_DRAW_COMMAND;
+    capacity = capacity < BVR_DRAW_COMMAND_LIMIT ? capacity : BVR_DRAW_COMMAND_LIMIT;
+
+    if(capacity <= pipeline->command_capacity){
+        return BVR_FAILED;
+    }
+
+    struct bvr_draw_command_s* commands = realloc(pipeline->commands, capacity * sizeof(struct bvr_draw_command_s));
+    if(!commands){
+        return BVR_FAILED;
+    }
+    pipeline->commands = commands;
+
+    uint32* order = realloc(pipeline->command_order, capacity * sizeof(uint32));
+    if(!order){
+        return BVR_FAILED;
+    }
+    pipeline->command_order = order;
+
+    struct bvr_draw_key_s* keys = realloc(pipeline->command_keys, 2 * capacity * sizeof(struct bvr_draw_key_s));
+    if(!keys){
+        return BVR_FAILED;
+    }
+    pipeline->command_keys = keys;
+
+    pipeline->command_capacity = capacity;
+    return BVR_OK;
 }
 
 void bvr_pipeline_add_draw_cmd(struct bvr_draw_command_s* cmd){
     BVR_ASSERT(cmd);
 
-    if(bvr_get_book_instance()->pipeline.command_count + 1 < BVR_MAX_DRAW_COMMAND){
-        memcpy(
-            &bvr_get_book_instance()->pipeline.commands[bvr_get_book_instance()->pipeline.command_count++], 
-            cmd, sizeof(struct bvr_draw_command_s));
+    bvr_pipeline_t* pipeline = &bvr_get_book_instance()->pipeline;
+    pipeline->statistics.submitted_commands++;
+
+    if(pipeline->command_count == pipeline->command_capacity){
+        // the queue keeps its size, it only grows while warming up
+        if(pipeline->commands){
+            pipeline->statistics.queue_growths++;
+        }
+
+        if(!bvri_grow_command_queue(pipeline)){
+            if(!pipeline->statistics.dropped_commands){
+                BVR_PRINT("draw command queue is full, dropping commands!");
+            }
+
+            pipeline->statistics.dropped_commands++;
+            return;
+        }
+    }
+
+    memcpy(&pipeline->commands[pipeline->command_count++], cmd, sizeof(struct bvr_draw_command_s));
+}
+
+void bvr_pipeline_sort_commands(const struct bvr_draw_command_s* commands, uint32 count, uint32* indices, 
+    struct bvr_draw_key_s* keys){
+    
+    BVR_ASSERT(commands || !count);
+    BVR_ASSERT(indices || !count);
+    BVR_ASSERT(keys || !count);
+
+    struct bvr_draw_key_s* sorted = keys + count;
+
+    uint64 differences = 0;
+    for (uint32 i = 0; i < count; i++)
+    {
+        keys[i].key = bvr_pipeline_command_key(&commands[i]);
+        keys[i].index = i;
+        differences |= keys[i].key ^ keys[0].key;
+    }
+
+    // LSD radix sort, one pass per byte, bytes shared by all keys are skipped
+    for (uint32 shift = 0; shift < 64; shift += 8)
+    {
+        if(!((differences >> shift) & 0xFF)){
+            continue;
+        }
+
+        uint32 offsets[256] = {0};
+        for (uint32 i = 0; i < count; i++)
+        {
+            offsets[(keys[i].key >> shift) & 0xFF]++;
+        }
+
+        for (uint32 i = 0, offset = 0; i < 256; i++)
+        {
+            uint32 bucket = offsets[i];
+            offsets[i] = offset;
+            offset += bucket;
+        }
+
+        for (uint32 i = 0; i < count; i++)
+        {
+            sorted[offsets[(keys[i].key >> shift) & 0xFF]++] = keys[i];
+        }
+
+        struct bvr_draw_key_s* swap = keys;
+        keys = sorted;
+        sorted = swap;
+    }
+
+    for (uint32 i = 0; i < count; i++)
+    {
+        indices[i] = keys[i].index;
+    }
+}
+
+void bvr_destroy_pipeline(bvr_pipeline_t* pipeline){
+    BVR_ASSERT(pipeline);
+
+    free(pipeline->commands);
+    free(pipeline->command_order);
+    free(pipeline->command_keys);
+
+    if(pipeline->instances.buffer){
+        bvr_destroy_dynamic_buffer(&pipeline->instances);
+        pipeline->instances.buffer = 0;
+    }
+
+    pipeline->commands = NULL;
+    pipeline->command_order = NULL;
+    pipeline->command_keys = NULL;
+    pipeline->command_count = 0;
+    pipeline->command_capacity = 0;
+}
+
+int bvr_create_dynamic_buffer(bvr_dynamic_buffer_t* buffer, const uint64 size){
+    BVR_ASSERT(buffer);
+    BVR_ASSERT(size);
+
+    buffer->region_size = size;
+    buffer->offset = 0;
+    buffer->region = 0;
+    memset(buffer->fences, 0, sizeof(buffer->fences));
+
+    // copy target never touches the bound vertex array's state
+    glGenBuffers(1, &buffer->buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer->buffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, size * BVR_DYNAMIC_BUFFER_FRAMES, NULL, GL_STREAM_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    return BVR_OK;
+}
+
+void* bvr_dynamic_buffer_map(bvr_dynamic_buffer_t* buffer, const uint64 size, const uint64 alignment, 
+    bvr_dynamic_range_t* range){
+    
+    BVR_ASSERT(buffer);
+    BVR_ASSERT(range);
+
+    range->buffer = 0;
+    range->offset = 0;
+
+    uint64 offset = buffer->offset;
+    if(alignment > 1){
+        offset = (offset + alignment - 1) / alignment * alignment;
+    }
+
+    if(!size || offset + size > buffer->region_size){
+        if(size){
+            BVR_PRINT("dynamic buffer is full!");
+        }
+
+        return NULL;
+    }
+
+    // wait until the GPU is done with the last time this region was written
+    if(buffer->fences[buffer->region]){
+        GLsync fence = (GLsync)buffer->fences[buffer->region];
+        while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED);
+
+        glDeleteSync(fence);
+        buffer->fences[buffer->region] = NULL;
     }
+
+    range->buffer = buffer->buffer;
+    range->offset = buffer->region * buffer->region_size + offset;
+    buffer->offset = offset + size;
+
+    // the region is fenced, the driver does not need to synchronize
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer->buffer);
+    return glMapBufferRange(GL_COPY_WRITE_BUFFER, range->offset, size, 
+        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+}
+
+void bvr_dynamic_buffer_unmap(bvr_dynamic_buffer_t* buffer){
+    BVR_ASSERT(buffer);
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer->buffer);
+    glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+bvr_dynamic_range_t bvr_dynamic_buffer_append(bvr_dynamic_buffer_t* buffer, const void* data, 
+    const uint64 size, const uint64 alignment){
+
+    bvr_dynamic_range_t range;
+    void* target = bvr_dynamic_buffer_map(buffer, size, alignment, &range);
+
+    if(target){
+        memcpy(target, data, size);
+        bvr_dynamic_buffer_unmap(buffer);
+    }
+    else {
+        range.buffer = 0;
+    }
+
+    return range;
+}
+
+void bvr_dynamic_buffer_next_frame(bvr_dynamic_buffer_t* buffer){
+    BVR_ASSERT(buffer);
+
+    // unused regions do not need to be fenced
+    if(buffer->offset){
+        buffer->fences[buffer->region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+
+    buffer->region = (buffer->region + 1) % BVR_DYNAMIC_BUFFER_FRAMES;
+    buffer->offset = 0;
+}
+
+void bvr_destroy_dynamic_buffer(bvr_dynamic_buffer_t* buffer){
+    BVR_ASSERT(buffer);
+
+    for (uint64 i = 0; i < BVR_DYNAMIC_BUFFER_FRAMES; i++)
+    {
+        if(buffer->fences[i]){
+            glDeleteSync((GLsync)buffer->fences[i]);
+            buffer->fences[i] = NULL;
+        }
+    }
+
+    glDeleteBuffers(1, &buffer->buffer);
 }
 
 void bvr_error(void){
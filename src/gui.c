@@ -1,5 +1,6 @@
 #include <BVR/gui.h>
 #include <BVR/utils.h>
+#include <BVR/scene.h>
 
 #ifdef BVR_INCLUDE_NUKLEAR
 
@@ -126,6 +127,9 @@ void bvr_nuklear_render(bvr_nuklear_t* nuklear){
         nuklear->element_buffer_length, 
         nuklear->scale
     );
+
+    // blending and depth were changed behind the pipeline's back
+    bvr_pipeline_invalidate_cache(&bvr_get_book_instance()->pipeline, 1);
 }
 
 void bvr_destroy_nuklear(bvr_nuklear_t* nuklear){
@@ -11,6 +11,182 @@
 
 #include <glad/glad.h>
 
+#include <SDL3/SDL_thread.h>
+#include <SDL3/SDL_mutex.h>
+#include <SDL3/SDL_filesystem.h>
+
+/*
+    Internal image loading flags.
+*/
+#define BVRI_IMAGE_LAZY_LAYERS 0x100
+
+/*
+    Return the size in bytes of a single channel sample.
+*/
+static uint64 bvri_sizeof_sample(int depth){
+    return depth == 16 ? sizeof(uint16) : sizeof(uint8);
+}
+
+/*
+    Return the size in bytes of a single pixel.
+*/
+static uint64 bvri_sizeof_pixel(bvr_image_t* image){
+    return image->channels * bvri_sizeof_sample(image->depth);
+}
+
+#ifdef BVR_IMAGE_PROFILE
+
+#include <time.h>
+
+static bvr_image_profile_t bvri_profile;
+
+static double bvri_profile_time(void){
+    struct timespec time;
+    timespec_get(&time, TIME_UTC);
+    return time.tv_sec * 1000.0 + time.tv_nsec / 1000000.0;
+}
+
+/*
+    Accumulate the time spent between BEGIN and END into a profile's stage.
+*/
+#define BVRI_PROFILE_BEGIN(stage) double bvri_profile_##stage = bvri_profile_time()
+#define BVRI_PROFILE_END(stage) bvri_profile.stage += bvri_profile_time() - bvri_profile_##stage
+
+#else
+
+#define BVRI_PROFILE_BEGIN(stage)
+#define BVRI_PROFILE_END(stage)
+
+#endif
+
+/*
+    Return the downscale denominator stored in loading flags.
+*/
+static uint32 bvri_scale_denominator(int flags){
+    uint32 scale = ((uint32)flags >> 16) & 0xFF;
+    return scale ? scale : 1;
+}
+
+/*
+    Make sure that the downscaled image is at least one pixel wide and high.
+*/
+static uint32 bvri_clamp_scale(uint32 scale, uint32 width, uint32 height){
+    if(scale > width){
+        scale = width;
+    }
+    if(scale > height){
+        scale = height;
+    }
+    return scale ? scale : 1;
+}
+
+/*
+    Add a row of interleaved samples to box filter's sums.
+    Columns that don't fill a whole box are skipped.
+*/
+static void bvri_box_accumulate(const uint8* row, uint64 width, uint64 channels, uint64 sample_size, uint32 scale, uint32* sums){
+    uint64 columns = (width / scale) * scale;
+
+    for (uint64 x = 0; x < columns; x++)
+    {
+        uint32* sum = sums + (x / scale) * channels;
+        
+        for (uint64 channel = 0; channel < channels; channel++)
+        {
+            if(sample_size == sizeof(uint16)){
+                sum[channel] += ((const uint16*)row)[x * channels + channel];
+            }
+            else {
+                sum[channel] += row[x * channels + channel];
+            }
+        }
+    }
+}
+
+/*
+    Write box filter's averages into target and reset sums.
+    `stride` is the number of samples between two written samples.
+*/
+static void bvri_box_resolve(uint32* sums, uint64 count, uint32 scale, uint64 sample_size, uint64 stride, uint8* target){
+    uint32 area = scale * scale;
+
+    for (uint64 i = 0; i < count; i++)
+    {
+        uint32 value = (sums[i] + area / 2) / area;
+
+        if(sample_size == sizeof(uint16)){
+            ((uint16*)target)[i * stride] = (uint16)value;
+        }
+        else {
+            target[i * stride] = (uint8)value;
+        }
+
+        sums[i] = 0;
+    }
+}
+
+/*
+    Box filter an already decoded image in place.
+    Used by formats that cannot be downscaled while decoding.
+*/
+static void bvri_image_downscale(bvr_image_t* image, uint32 scale){
+    scale = bvri_clamp_scale(scale, image->width, image->height);
+    if(scale <= 1 || !image->pixels){
+        return;
+    }
+
+    uint64 sample_size = bvri_sizeof_sample(image->depth);
+    uint64 pixel_size = bvri_sizeof_pixel(image);
+    uint64 width = image->width / scale;
+    uint64 height = image->height / scale;
+    uint64 plane_count = BVR_BUFFER_COUNT(image->layers);
+    if(!plane_count){
+        plane_count = 1;
+    }
+
+    uint32* sums = calloc(width * image->channels, sizeof(uint32));
+    BVR_ASSERT(sums);
+
+    BVRI_PROFILE_BEGIN(scatter);
+
+    // downscaled rows are always written behind the rows that are still read
+    for (uint64 plane = 0; plane < plane_count; plane++)
+    {
+        const uint8* source = image->pixels + plane * image->width * image->height * pixel_size;
+        uint8* target = image->pixels + plane * width * height * pixel_size;
+
+        for (uint64 y = 0; y < height * scale; y++)
+        {
+            bvri_box_accumulate(source + y * image->width * pixel_size, image->width, image->channels, sample_size, scale, sums);
+
+            if((y + 1) % scale == 0){
+                bvri_box_resolve(sums, width * image->channels, scale, sample_size, 1, target + (y / scale) * width * pixel_size);
+            }
+        }
+    }
+
+    BVRI_PROFILE_END(scatter);
+
+    free(sums);
+
+    for (uint64 layer = 0; layer < BVR_BUFFER_COUNT(image->layers); layer++)
+    {
+        bvr_layer_t* layer_ptr = &((bvr_layer_t*)image->layers.data)[layer];
+        layer_ptr->width /= (int)scale;
+        layer_ptr->height /= (int)scale;
+        layer_ptr->anchor_x /= (int)scale;
+        layer_ptr->anchor_y /= (int)scale;
+    }
+
+    image->width = width;
+    image->height = height;
+
+    uint8* pixels = realloc(image->pixels, width * height * pixel_size * plane_count);
+    if(pixels){
+        image->pixels = pixels;
+    }
+}
+
 #ifndef BVR_NO_PNG
 
 #include <png.h>
@@ -29,7 +205,7 @@ static void bvri_png_error(png_structp sptr, png_const_charp cc){
     BVR_ASSERT(0);
 }
 
-static int bvri_load_png(bvr_image_t* image, FILE* file){
+static int bvri_load_png(bvr_image_t* image, FILE* file, int flags){
     png_structp pngldr = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, bvri_png_error, NULL);
     BVR_ASSERT(pngldr);
 
@@ -41,6 +217,8 @@ static int bvri_load_png(bvr_image_t* image, FILE* file){
         return BVR_FAILED;
     }
 
+    BVRI_PROFILE_BEGIN(header);
+
     fseek(file, BVR_PNG_HEADER_LENGTH, SEEK_SET);
 
     png_init_io(pngldr, file);
@@ -65,7 +243,8 @@ static int bvri_load_png(bvr_image_t* image, FILE* file){
     }
 
     if(image->depth == 16){
-        png_set_strip_16(pngldr);
+        /* PNG stores samples as big-endian */
+        png_set_swap(pngldr);
     }
     else if(image->depth < 8){
         png_set_packing(pngldr);
@@ -73,9 +252,20 @@ static int bvri_load_png(bvr_image_t* image, FILE* file){
 
     png_read_update_info(pngldr, pnginfo);
     color_type = png_get_color_type(pngldr, pnginfo);
+    image->depth = png_get_bit_depth(pngldr, pnginfo);
+
+    BVRI_PROFILE_END(header);
 
     switch (color_type)
     {
+    case PNG_COLOR_TYPE_GRAY:
+        image->format = BVR_R;
+        image->channels = 1;
+        break;
+    case PNG_COLOR_TYPE_GRAY_ALPHA:
+        image->format = BVR_RG;
+        image->channels = 2;
+        break;
     case PNG_COLOR_TYPE_RGB:
         image->format = BVR_RGB;
         image->channels = 3;
@@ -87,27 +277,78 @@ static int bvri_load_png(bvr_image_t* image, FILE* file){
     default:
         BVR_PRINTF("color type %x is not supported!", color_type);
         png_destroy_read_struct(&pngldr, &pnginfo, NULL);
-        break;
+        return BVR_FAILED;
     }
 
     uint64 rowbytes = png_get_rowbytes(pngldr, pnginfo);
-    image->pixels = malloc(image->width * image->height * image->channels * sizeof(uint8));
-    BVR_ASSERT(image->pixels);
+    uint32 scale = bvri_clamp_scale(bvri_scale_denominator(flags), image->width, image->height);
+    int interlaced = png_get_interlace_type(pngldr, pnginfo) != PNG_INTERLACE_NONE;
+
+    if(scale > 1 && !interlaced){
+        // decode row per row and only keep box filtered rows, 
+        // rows that don't fill a whole box are never decoded.
+        uint64 width = image->width / scale;
+        uint64 height = image->height / scale;
+        uint64 sample_size = bvri_sizeof_sample(image->depth);
+        uint64 pixel_size = bvri_sizeof_pixel(image);
+
+        uint8* row = malloc(rowbytes);
+        uint32* sums = calloc(width * image->channels, sizeof(uint32));
+        BVR_ASSERT(row);
+        BVR_ASSERT(sums);
+
+        image->pixels = malloc(width * height * pixel_size);
+        BVR_ASSERT(image->pixels);
+
+        for (uint64 y = 0; y < height * scale; y++)
+        {
+            BVRI_PROFILE_BEGIN(decompress);
+            png_read_row(pngldr, row, NULL);
+            BVRI_PROFILE_END(decompress);
+
+            bvri_box_accumulate(row, image->width, image->channels, sample_size, scale, sums);
+
+            if((y + 1) % scale == 0){
+                // rows are stored bottom-up
+                bvri_box_resolve(
+                    sums, width * image->channels, scale, sample_size, 1, 
+                    image->pixels + (height - y / scale - 1) * width * pixel_size
+                );
+            }
+        }
 
-    uint8** rowp = malloc(image->height * sizeof(uint8*));
-    BVR_ASSERT(rowp);
+        image->width = width;
+        image->height = height;
 
-    for (uint64 i = 0; i < image->height; i++)
-    {
-        rowp[image->height - i - 1] = image->pixels + i * rowbytes;
+        free(sums);
+        free(row);
     }
+    else {
+        image->pixels = malloc(image->height * rowbytes);
+        BVR_ASSERT(image->pixels);
+
+        uint8** rowp = malloc(image->height * sizeof(uint8*));
+        BVR_ASSERT(rowp);
+
+        for (uint64 i = 0; i < image->height; i++)
+        {
+            rowp[image->height - i - 1] = image->pixels + i * rowbytes;
+        }
+
+        // libpng decompresses and scatters rows at once
+        BVRI_PROFILE_BEGIN(decompress);
+        png_read_image(pngldr, rowp);
+        BVRI_PROFILE_END(decompress);
 
-    png_read_image(pngldr, rowp);
+        free(rowp);
+
+        // interlaced images need every pass before being filtered
+        bvri_image_downscale(image, scale);
+    }
 
-    free(rowp);
     png_destroy_read_struct(&pngldr, &pnginfo, NULL);
         
-    return image->pixels == NULL;
+    return image->pixels != NULL;
 }
 
 #endif
@@ -163,6 +404,8 @@ static uint32 bvri_bmpmax(uint32 max, uint32 i){
 }
 
 static int bvri_load_bmp(bvr_image_t* image, FILE* file){
+    BVRI_PROFILE_BEGIN(header);
+
     fseek(file, 0, SEEK_SET);
 
     struct bvri_bmpheader_s header;
@@ -220,6 +463,8 @@ static int bvri_load_bmp(bvr_image_t* image, FILE* file){
     // seek to pixel array
     fseek(file, header.offset, SEEK_SET);
 
+    BVRI_PROFILE_END(header);
+
     image->width = header.width;
     image->height = abs(header.height);
     image->depth = 8;
@@ -241,6 +486,8 @@ static int bvri_load_bmp(bvr_image_t* image, FILE* file){
     image->pixels = malloc(image->width * image->height * image->channels);
     BVR_ASSERT(image->pixels);
 
+    BVRI_PROFILE_BEGIN(decompress);
+
     // RAW compression
     if(header.compression_method == 0){
         uint32 packed_bytes = 0;
@@ -297,6 +544,8 @@ static int bvri_load_bmp(bvr_image_t* image, FILE* file){
         BVR_ASSERT(0 || "compression not supported");
     }
 
+    BVRI_PROFILE_END(decompress);
+
     // try to free color palette
     free(header.palette);
 
@@ -408,7 +657,7 @@ static uint32 bvri_tif_sizeof(uint32 size){
     https://github.com/jkriege2/TinyTIFF/blob/master/src/tinytiffreader.c
     https://www.fileformat.info/format/tiff/egff.htm
 */
-static int bvri_load_tif(bvr_image_t* image, FILE* file){
+static int bvri_load_tif(bvr_image_t* image, FILE* file, int flags){
     fseek(file, 0, SEEK_SET);
     bvr_fread32_le(file); // id & version
     int idf_offset = bvr_fread32_le(file);
@@ -422,6 +671,8 @@ static int bvri_load_tif(bvr_image_t* image, FILE* file){
     // while we got a next image header
     while (idf.next)
     {
+        BVRI_PROFILE_BEGIN(header);
+
         // clear frame's data.
         memset(&frame, 0, sizeof(struct bvri_tifframe));
         
@@ -561,10 +812,12 @@ static int bvri_load_tif(bvr_image_t* image, FILE* file){
                     || frame.bits_per_sample == 24
                     || frame.bits_per_sample == 32);
         
+        BVRI_PROFILE_END(header);
+
         image->width = frame.width;
         image->height = frame.height;
         image->layers.size += sizeof(bvr_layer_t);
-        image->depth = frame.samples_per_pixel;
+        image->depth = 8;
 
         if(frame.planar_configuration == 1){
             /*BVR_PRINTF("strip count %i", frame.strip_count);
@@ -589,29 +842,77 @@ static int bvri_load_tif(bvr_image_t* image, FILE* file){
             }
 
             image->channels = frame.strip_count;
-            image->pixels = malloc(image->width * image->height * image->channels);
-            BVR_ASSERT(image->pixels);
 
-            for (uint64 strip = 0; strip < frame.strip_count; strip++)
-            {
-                uint8* strip_buffer = calloc(frame.strip_byte_counts[strip], sizeof(uint8));
-                BVR_ASSERT(strip_buffer);
+            uint32 scale = bvri_clamp_scale(bvri_scale_denominator(flags), image->width, image->height);
+            if(scale > 1){
+                // read each strip scanline per scanline and box filter them,
+                // scanlines that don't fill a whole box are skipped.
+                uint64 width = image->width / scale;
+                uint64 height = image->height / scale;
+
+                uint8* row = malloc(image->width);
+                uint32* sums = calloc(width, sizeof(uint32));
+                BVR_ASSERT(row);
+                BVR_ASSERT(sums);
 
-                // read the entire strip into a buffer
-                fseek(file, frame.strip_offsets[strip], SEEK_SET);
-                fread(strip_buffer, sizeof(uint8), frame.strip_byte_counts[strip], file);
+                image->pixels = malloc(width * height * image->channels);
+                BVR_ASSERT(image->pixels);
 
-                uint64 image_index = strip;
-                for (uint64 strip_index = 0; strip_index < frame.strip_byte_counts[strip]; strip_index++)
+                for (uint64 strip = 0; strip < frame.strip_count; strip++)
                 {
-                    // copy each pixels into the final image buffer
-                    image->pixels[image_index] = strip_buffer[strip_index];
-                    image_index += image->channels;
+                    fseek(file, frame.strip_offsets[strip], SEEK_SET);
+
+                    for (uint64 y = 0; y < height * scale; y++)
+                    {
+                        if(fread(row, sizeof(uint8), image->width, file) != image->width){
+                            break;
+                        }
+
+                        bvri_box_accumulate(row, image->width, 1, sizeof(uint8), scale, sums);
+
+                        if((y + 1) % scale == 0){
+                            bvri_box_resolve(
+                                sums, width, scale, sizeof(uint8), image->channels,
+                                image->pixels + (y / scale) * width * image->channels + strip
+                            );
+                        }
+                    }
                 }
-                
-                free(strip_buffer);
+
+                image->width = width;
+                image->height = height;
+
+                free(sums);
+                free(row);
             }
+            else {
+                image->pixels = malloc(image->width * image->height * image->channels);
+                BVR_ASSERT(image->pixels);
 
+                for (uint64 strip = 0; strip < frame.strip_count; strip++)
+                {
+                    uint8* strip_buffer = calloc(frame.strip_byte_counts[strip], sizeof(uint8));
+                    BVR_ASSERT(strip_buffer);
+
+                    // read the entire strip into a buffer
+                    BVRI_PROFILE_BEGIN(decompress);
+                    fseek(file, frame.strip_offsets[strip], SEEK_SET);
+                    fread(strip_buffer, sizeof(uint8), frame.strip_byte_counts[strip], file);
+                    BVRI_PROFILE_END(decompress);
+
+                    BVRI_PROFILE_BEGIN(scatter);
+                    uint64 image_index = strip;
+                    for (uint64 strip_index = 0; strip_index < frame.strip_byte_counts[strip]; strip_index++)
+                    {
+                        // copy each pixels into the final image buffer
+                        image->pixels[image_index] = strip_buffer[strip_index];
+                        image_index += image->channels;
+                    }
+                    BVRI_PROFILE_END(scatter);
+                
+                    free(strip_buffer);
+                }
+            }
         }
         else {
             BVR_ASSERT(0 || "configuration is not supported!");
@@ -721,6 +1022,276 @@ static void bvri_psd_read_pascal_string(bvr_string_t* string, FILE* file){
     }
 }
 
+/*
+    Unpack PackBits compressed data.
+    Return the number of bytes read from the packed buffer.
+*/
+static uint64 bvri_psd_unpack_rle(const uint8* packed, uint64 packed_length, uint8* unpacked, uint64 unpacked_length){
+    uint8 count = 0;
+    uint32 count_as_int = 0;
+    uint64 offset = 0;
+    uint64 readed_bytes = 0;
+
+    while (readed_bytes < packed_length && offset < unpacked_length)
+    {
+        count = packed[readed_bytes++];
+        
+        if(count == 0x80){
+            // byte == 128
+            // no-op
+        }
+        else if(count > 0x80){
+            // 0x81 < byte < 0xFF
+            count_as_int = (uint32)(0x101 - count);
+
+            if(offset + count_as_int > unpacked_length || readed_bytes >= packed_length){
+                break;
+            }
+
+            memset(&unpacked[offset], packed[readed_bytes++], count_as_int);
+            offset += count_as_int;
+        }
+        else {
+            // 0x00 < byte < 0x7F
+            count_as_int = (uint32)(count + 1);
+
+            if(offset + count_as_int > unpacked_length || readed_bytes + count_as_int > packed_length){
+                break;
+            }
+
+            memcpy(&unpacked[offset], &packed[readed_bytes], count_as_int);
+            offset += count_as_int;
+            readed_bytes += count_as_int;
+        }
+    }
+
+    // clear what's left if the data is corrupted
+    if(offset < unpacked_length){
+        memset(&unpacked[offset], 0, unpacked_length - offset);
+    }
+
+    return readed_bytes;
+}
+
+/*
+    Unpack a single layer's channel.
+    Channel's data starts with its compression mode.
+*/
+static int bvri_psd_unpack_channel(const uint8* data, uint64 length, uint32 columns, uint32 rows, uint8* unpacked){
+    uint16 compression;
+    
+    if(length < sizeof(uint16)){
+        return BVR_FAILED;
+    }
+
+    compression = (uint16)((data[0] << 8) | data[1]);
+    data += sizeof(uint16);
+    length -= sizeof(uint16);
+
+    if(compression == 0){
+        // RAW data
+        if(length < (uint64)columns * rows){
+            return BVR_FAILED;
+        }
+
+        memcpy(unpacked, data, (uint64)columns * rows);
+        return BVR_OK;
+    }
+    else if(compression == 1){
+        // RLE data, skip each row's packed length
+        if(length < rows * sizeof(uint16)){
+            return BVR_FAILED;
+        }
+
+        bvri_psd_unpack_rle(
+            data + rows * sizeof(uint16), length - rows * sizeof(uint16), 
+            unpacked, (uint64)columns * rows
+        );
+        return BVR_OK;
+    }
+
+    BVR_PRINTF("unsupported compression mode %i", compression);
+    return BVR_FAILED;
+}
+
+/*
+    Copy a PSD big-endian sample into an interleaved pixel buffer.
+*/
+static inline void bvri_psd_copy_sample(uint8* pixels, uint64 pixel_index, const uint8* plane, uint64 plane_index, uint64 sample_size){
+    if(sample_size == sizeof(uint16)){
+        ((uint16*)pixels)[pixel_index] = (uint16)((plane[plane_index * 2] << 8) | plane[plane_index * 2 + 1]);
+    }
+    else {
+        pixels[pixel_index] = plane[plane_index];
+    }
+}
+
+/*
+    Load the merged image stored at the end of the file.
+    File's cursor must be at the start of the image data section.
+*/
+static int bvri_psd_load_composite(bvr_image_t* image, FILE* file, struct bvri_psdheader_s* header, int flags){
+    uint16 compression;
+    uint64 channel_count;
+    uint64 sample_size;
+    uint64 row_length;
+    uint64 kept_rows;
+    uint32 scale;
+    uint32* sums;
+    uint8* row;
+
+    // packed rows, only used by RLE data
+    uint8* lengths = NULL;
+    uint8* packed = NULL;
+    uint64 packed_length = 0;
+    uint64 packed_offset = 0;
+
+    image->channels = 4; // we force 4 channels
+    image->format = BVR_RGBA;
+    image->depth = header->depth;
+
+    scale = bvri_clamp_scale(bvri_scale_denominator(flags), header->columns, header->rows);
+    image->width = header->columns / scale;
+    image->height = header->rows / scale;
+
+    channel_count = header->channels;
+    sample_size = bvri_sizeof_sample(image->depth);
+    row_length = header->columns * sample_size;
+    kept_rows = image->height * scale;
+
+    // only keep color and transparency channels
+    if(channel_count > image->channels){
+        channel_count = image->channels;
+    }
+
+    image->pixels = malloc((uint64)image->width * image->height * bvri_sizeof_pixel(image));
+    BVR_ASSERT(image->pixels);
+
+    // missing channels are opaque white 
+    memset(image->pixels, 0xFF, (uint64)image->width * image->height * bvri_sizeof_pixel(image));
+
+    row = malloc(row_length);
+    sums = calloc(image->width, sizeof(uint32));
+    BVR_ASSERT(row);
+    BVR_ASSERT(sums);
+
+    BVRI_PROFILE_BEGIN(decompress);
+
+    compression = bvr_freadu16_be(file);
+    if(compression == 1){
+        // RLE data, rows' packed lengths of all channels are stored first
+        uint64 row_count = (uint64)header->channels * header->rows;
+        lengths = malloc(row_count * sizeof(uint16));
+        BVR_ASSERT(lengths);
+
+        fread(lengths, sizeof(uint16), row_count, file);
+        for (uint64 y = 0; y < row_count; y++)
+        {
+            packed_length += (lengths[y * 2] << 8) | lengths[y * 2 + 1];
+        }
+
+        packed = malloc(packed_length);
+        BVR_ASSERT(packed);
+
+        packed_length = fread(packed, sizeof(uint8), packed_length, file);
+    }
+    else if(compression != 0) {
+        BVR_PRINTF("unsupported compression mode %i", compression);
+        channel_count = 0;
+    }
+
+    BVRI_PROFILE_END(decompress);
+
+    // each channel's plane is stored one after the other
+    for (uint64 channel = 0; channel < channel_count; channel++)
+    {
+        for (uint64 y = 0; y < header->rows; y++)
+        {
+            BVRI_PROFILE_BEGIN(decompress);
+
+            if(compression == 1){
+                uint64 row_index = channel * header->rows + y;
+                uint64 packed_row = (lengths[row_index * 2] << 8) | lengths[row_index * 2 + 1];
+
+                if(y < kept_rows && packed_offset < packed_length){
+                    bvri_psd_unpack_rle(
+                        packed + packed_offset, 
+                        packed_row < packed_length - packed_offset ? packed_row : packed_length - packed_offset, 
+                        row, row_length
+                    );
+                }
+
+                packed_offset += packed_row;
+            }
+            else if(y >= kept_rows){
+                // skip scanlines that don't fill a whole box
+                fseek(file, row_length * (header->rows - y), SEEK_CUR);
+                break;
+            }
+            else if(fread(row, sizeof(uint8), row_length, file) != row_length){
+                BVR_PRINT("merged image is truncated!");
+                break;
+            }
+
+            BVRI_PROFILE_END(decompress);
+
+            if(y >= kept_rows){
+                continue;
+            }
+
+            BVRI_PROFILE_BEGIN(scatter);
+
+            if(scale == 1){
+                for (uint64 x = 0; x < header->columns; x++)
+                {
+                    bvri_psd_copy_sample(image->pixels, (y * image->width + x) * image->channels + channel, row, x, sample_size);
+                }
+
+                BVRI_PROFILE_END(scatter);
+                continue;
+            }
+
+            // convert big-endian samples before filtering them
+            if(sample_size == sizeof(uint16)){
+                for (uint64 x = 0; x < header->columns; x++)
+                {
+                    bvri_psd_copy_sample(row, x, row, x, sample_size);
+                }
+            }
+
+            bvri_box_accumulate(row, header->columns, 1, sample_size, scale, sums);
+
+            if((y + 1) % scale == 0){
+                bvri_box_resolve(
+                    sums, image->width, scale, sample_size, image->channels,
+                    image->pixels + ((y / scale) * image->width * image->channels + channel) * sample_size
+                );
+            }
+
+            BVRI_PROFILE_END(scatter);
+        }
+    }
+
+    // grayscale images only have one color channel, their transparency was read in the green slot
+    if(header->mode == 1){
+        uint64 pixel_size = bvri_sizeof_pixel(image);
+        for (uint64 i = 0; i < (uint64)image->width * image->height; i++)
+        {
+            uint8* pixel = image->pixels + i * pixel_size;
+            memcpy(pixel + sample_size * 3, pixel + sample_size, sample_size);
+            memcpy(pixel + sample_size, pixel, sample_size);
+            memcpy(pixel + sample_size * 2, pixel, sample_size);
+        }
+    }
+
+    free(packed);
+    free(lengths);
+    free(sums);
+    free(row);
+
+    return BVR_OK;
+}
+
 /*
     Sources :
     https://docs.fileformat.com/image/psd/
@@ -728,7 +1299,7 @@ static void bvri_psd_read_pascal_string(bvr_string_t* string, FILE* file){
     https://www.adobe.com/devnet-apps/photoshop/fileformatashtml/#50577409_pgfId-1030196
     https://en.wikipedia.org/wiki/PackBits
 */
-static int bvri_load_psd(bvr_image_t* image, FILE* file){
+static int bvri_load_psd(bvr_image_t* image, FILE* file, int flags){
     struct bvri_psdheader_s header;
     
     struct {
@@ -755,18 +1326,7 @@ static int bvri_load_psd(bvr_image_t* image, FILE* file){
         struct bvri_psdlayer_s* layers;
     } layer_section;
 
-    struct {
-        short compression;
-        short channels;
-        short channel;
-        uint32 rows;
-        uint32 columns;
-        uint32 unpacked_length;
-        uint32 packed_length;
-        uint8* unpacked_buffer;
-        uint8* packed_buffer;
-        uint16* rle_pack_lengths;
-    } image_data_section;
+    BVRI_PROFILE_BEGIN(header);
 
     // reading psd's header
     // skip sig header
@@ -779,6 +1339,11 @@ static int bvri_load_psd(bvr_image_t* image, FILE* file){
     header.depth = bvr_freadu16_be(file);
     header.mode = bvr_freadu16_be(file);
 
+    if(header.depth != 8 && header.depth != 16){
+        BVR_PRINTF("psd depth %i is not supported!", header.depth);
+        return BVR_FAILED;
+    }
+
     // check for color mode section (if the size == 0, no section)
     color_mode_section.size = bvr_freadu32_be(file);
     color_mode_section.data = NULL;
@@ -823,6 +1388,15 @@ static int bvri_load_psd(bvr_image_t* image, FILE* file){
 
     layer_section.size = bvr_freadu32_be(file);
     layer_section.end_position = ftell(file) + layer_section.size;
+
+    // the merged image is stored right after the layer section.
+    // when layers aren't required, we skip the whole section.
+    if(BVR_HAS_FLAG(flags, BVR_IMAGE_LOAD_COMPOSITE) || !layer_section.size){
+        fseek(file, layer_section.end_position, SEEK_SET);
+        BVRI_PROFILE_END(header);
+        return bvri_psd_load_composite(image, file, &header, flags);
+    }
+
     {
         uint64 start_of_the_header = ftell(file);
 
@@ -837,6 +1411,13 @@ static int bvri_load_psd(bvr_image_t* image, FILE* file){
             layer_section.next_alpha_channel_is_global = 1;
         }
 
+        // document without any layer
+        if(!layer_section.layer_size || !layer_section.layer_count){
+            fseek(file, layer_section.end_position, SEEK_SET);
+            BVRI_PROFILE_END(header);
+            return bvri_psd_load_composite(image, file, &header, flags);
+        }
+
         layer_section.layers = NULL;
         layer_section.layers = calloc(layer_section.layer_count, sizeof(struct bvri_psdlayer_s));
         BVR_ASSERT(layer_section.layers);
@@ -930,16 +1511,15 @@ static int bvri_load_psd(bvr_image_t* image, FILE* file){
         BVR_ASSERT(0 || "image format not supported!");
         break;
     }
-
-    image->pixels = malloc(image->width * image->height * image->channels * layer_section.layer_count);
-    BVR_ASSERT(image->pixels);
-
-    memset(image->pixels, 0, image->width * image->height * image->channels * layer_section.layer_count);
     
     image->layers.size = layer_section.layer_count * image->layers.elemsize;
     image->layers.data = calloc(layer_section.layer_count, image->layers.elemsize);
     BVR_ASSERT(image->layers.data);
 
+    // channel's image data starts right after the last layer record, layer after layer.
+    // each channel's range is stored relatively to its layer's data.
+    uint64 channel_data_start = ftell(file);
+
     // initialize layers to make sure they're correct
     for (uint64 layer = 0; layer < layer_section.layer_count; layer++)
     {
@@ -957,184 +1537,66 @@ static int bvri_load_psd(bvr_image_t* image, FILE* file){
         if(layer_section.layers[layer].clipping){
             layer_ptr->flags |= BVR_LAYER_CLIPPED;
         }
-    }
 
-    image_data_section.unpacked_buffer = NULL;
-    image_data_section.packed_buffer = NULL;
-    image_data_section.rle_pack_lengths = NULL;
-    image_data_section.compression = bvr_freadu16_be(file);
-    {
-        if(image_data_section.compression == 0){
-            // proceed to RAW uncompression 
+        // remember where each channel is stored
+        layer_ptr->channels.elemsize = sizeof(bvr_layer_channel_t);
+        layer_ptr->channels.size = layer_section.layers[layer].channel_count * sizeof(bvr_layer_channel_t);
+        layer_ptr->channels.data = calloc(layer_section.layers[layer].channel_count, sizeof(bvr_layer_channel_t));
+        BVR_ASSERT(layer_ptr->channels.data);
 
-            BVR_ASSERT(0 || "unsupported compression mode");
-        }
-        else if(image_data_section.compression == 1){
-            // do RLE uncompression
-            for (uint64 layer = 0; layer < layer_section.layer_count; layer++)
-            {
-                int layer_width = layer_section.layers[layer].bounds[3] - layer_section.layers[layer].bounds[1];
-                int layer_height = layer_section.layers[layer].bounds[2] - layer_section.layers[layer].bounds[0];
-                int layer_anchor_x = layer_section.layers[layer].bounds[1];
-                int layer_anchor_y = layer_section.layers[layer].bounds[0];
+        layer_ptr->packed.elemsize = sizeof(uint8);
+        layer_ptr->packed.size = 0;
+        layer_ptr->packed.data = NULL;
+
+        for (uint64 channel = 0; channel < layer_section.layers[layer].channel_count; channel++)
+        {
+            bvr_layer_channel_t* channel_ptr = &((bvr_layer_channel_t*)layer_ptr->channels.data)[channel];
             
-                image_data_section.channels = layer_section.layers[layer].channel_count;
-                image_data_section.rle_pack_lengths = calloc(layer_height, sizeof(uint16));
-                BVR_ASSERT(image_data_section.rle_pack_lengths);
+            channel_ptr->id = layer_section.layers[layer].channels[channel].id;
+            channel_ptr->offset = layer_ptr->packed.size;
+            channel_ptr->length = layer_section.layers[layer].channels[channel].length;
 
-                for (uint64 channel = 0; channel < image_data_section.channels; channel++)
-                {
-                    uint64 readed_size;
+            layer_ptr->packed.size += channel_ptr->length;
+        }
+    }
 
-                    layer_section.layers[layer].channels[channel].position = ftell(file);
-                    image_data_section.channel = layer_section.layers[layer].channels[channel].id; 
-                    switch (image_data_section.channel)
-                    {
-                    case -1: // transparency
-                        {
-                            image_data_section.columns = layer_width;
-                            image_data_section.rows = layer_height;  
-                            image_data_section.channel = 3;
-                        }
-                        break;
-                    case -2: // layer or vector
-                        {
-                            image_data_section.columns = layer_width;
-                            image_data_section.rows = layer_height;
-                            image_data_section.channel = 0;
-                        }
-                        break;
-                    case -3: // layer mask
-                        {
-                            image_data_section.columns = layer_width;
-                            image_data_section.rows = layer_height;
-                            image_data_section.channel = 0;
-                        }
-                        break;
-                    
-                    case 1: // red
-                    case 2: // blue
-                    case 3: // green
-                    default: // color channel
-                        {
-                            image_data_section.columns = layer_width;
-                            image_data_section.rows = layer_height;
-                        }
-                        break;
-                    }
+    BVRI_PROFILE_END(header);
 
-                    image_data_section.packed_length = 0;
-                    image_data_section.unpacked_length = image_data_section.columns * image_data_section.rows;
+    // each layer keeps its own packed data, so that decoding a layer releases its share.
+    // layers are unpacked from these buffers when they're required.
+    BVRI_PROFILE_BEGIN(decompress);
+    fseek(file, channel_data_start, SEEK_SET);
+    for (uint64 layer = 0; layer < layer_section.layer_count; layer++)
+    {
+        bvr_layer_t* layer_ptr = &((bvr_layer_t*)image->layers.data)[layer];
+        if(!layer_ptr->packed.size){
+            continue;
+        }
 
-                    for (uint64 j = 0; j < image_data_section.rows; j++)
-                    {
-                        image_data_section.rle_pack_lengths[j] = bvr_freadu16_be(file);
-                        image_data_section.packed_length += image_data_section.rle_pack_lengths[j];
-                    }
-                    
-                    image_data_section.packed_buffer = calloc(image_data_section.packed_length, sizeof(uint8));
-                    image_data_section.unpacked_buffer = calloc(image_data_section.unpacked_length, sizeof(uint8));
-                    BVR_ASSERT(image_data_section.packed_buffer);
-                    BVR_ASSERT(image_data_section.unpacked_buffer);
-
-                    readed_size = fread(image_data_section.packed_buffer, sizeof(uint8), image_data_section.packed_length, file);
-                    if(readed_size != image_data_section.packed_length){
-                        BVR_PRINT("skipping layer");
-                        continue;
-                    }
+        layer_ptr->packed.data = malloc(layer_ptr->packed.size);
+        BVR_ASSERT(layer_ptr->packed.data);
 
-                    uint8 character = 0;
-                    uint8 count = 0;
-                    uint32 count_as_int = 0;
-                    uint64 offset = 0;
-                    uint64 readed_bytes = 0;
-                    while (readed_bytes < image_data_section.packed_length 
-                            && offset < image_data_section.unpacked_length)
-                    {
-                        BVR_ASSERT(readed_bytes < image_data_section.packed_length);
-                        BVR_ASSERT(offset < image_data_section.unpacked_length);
-
-                        if(readed_bytes < image_data_section.packed_length){
-                            count = image_data_section.packed_buffer[readed_bytes++];
-                            
-                            if(count == 0x80){
-                                // byte == 128
-                                // no-op
-                            }
-                            else if(count > 0x80){
-                                // 0x81 < byte < 0xFF
-                                count_as_int = (uint32)(0x101 - count);
-
-                                BVR_ASSERT(offset + count_as_int <= image_data_section.unpacked_length);
-
-                                memset(&image_data_section.unpacked_buffer[offset], 
-                                    image_data_section.packed_buffer[readed_bytes++],
-                                    count_as_int
-                                );
-
-                                offset += count_as_int;
-                            }
-                            else {
-                                // 0x00 < byte < 0x7F
-                                count_as_int = (uint32)(count + 1);
-
-                                BVR_ASSERT(offset + count_as_int <= image_data_section.unpacked_length);
-
-                                memcpy(&image_data_section.unpacked_buffer[offset],
-                                    &image_data_section.packed_buffer[readed_bytes],
-                                    count_as_int
-                                );
-
-                                offset += count_as_int;
-                                readed_bytes += count_as_int;
-                            }
-                        }
-                        else {
-                            memset(image_data_section.unpacked_buffer, 0, image_data_section.unpacked_length - offset);
-                            offset = image_data_section.unpacked_length;
-                        }
-                    }
+        uint64 read = fread(layer_ptr->packed.data, sizeof(uint8), layer_ptr->packed.size, file);
+        if(read != layer_ptr->packed.size){
+            BVR_PRINT("layers' data are truncated!");
+            layer_ptr->packed.size = read;
+        }
+    }
+    BVRI_PROFILE_END(decompress);
 
-                    for (uint64 strip = 0; strip < image_data_section.rows; strip++)
-                    {
-                        for (uint64 column = 0; column < image_data_section.columns; column++)
-                        {
-#ifndef BVR_NO_FLIP
-                            image->pixels[
-                                (((strip + layer_anchor_y) * image->width + column + layer_anchor_x) * image->channels + image_data_section.channel) +
-                                (image->width * image->height * image->channels * layer)
-                            ] = image_data_section.unpacked_buffer[strip * image_data_section.columns + column];
-#else
-                            image->pixels[
-                                ((strip * image->width + column) * image->channels + image_data_section.target_channel) +
-                                (image->width * image->height * image->channels * layer)
-                            ] = image_data_section.unpacked_buffer[strip * image_data_section.columns + column];
-#endif
-                        }
+    if(!BVR_HAS_FLAG(flags, BVRI_IMAGE_LAZY_LAYERS)){
+        uint64 layer_stride = image->width * image->height * bvri_sizeof_pixel(image);
 
-                    }
+        image->pixels = calloc(layer_stride * layer_section.layer_count, sizeof(uint8));
+        BVR_ASSERT(image->pixels);
 
-                    // seek to the end of the channel data
-                    fseek(file, 
-                        layer_section.layers[layer].channels[channel].position 
-                        + layer_section.layers[layer].channels[channel].length, 
-                        SEEK_SET
-                    );
-                    
-                    free(image_data_section.packed_buffer);
-                    free(image_data_section.unpacked_buffer);
-                    image_data_section.packed_buffer = NULL;
-                    image_data_section.unpacked_buffer = NULL;
-                }
-                
-                free(image_data_section.rle_pack_lengths);
-                image_data_section.rle_pack_lengths = NULL;
-            }
-            
-        }
-        else {
-            BVR_ASSERT(0 || "unsupported compression mode");
+        for (uint64 layer = 0; layer < layer_section.layer_count; layer++)
+        {
+            bvr_image_decode_layer(image, layer, image->pixels + layer_stride * layer);
         }
+
+        // layers are composed at full resolution before being filtered
+        bvri_image_downscale(image, bvri_scale_denominator(flags));
     }
 
     // freeing data
@@ -1153,6 +1615,117 @@ static int bvri_load_psd(bvr_image_t* image, FILE* file){
 
 #endif
 
+#ifndef BVR_NO_PSD
+
+static void bvri_release_layer_data(bvr_layer_t* layer){
+    free(layer->packed.data);
+    layer->packed.data = NULL;
+    layer->packed.size = 0;
+}
+
+#endif
+
+int bvr_image_decode_layer(bvr_image_t* image, uint32 layer, uint8* pixels){
+    BVR_ASSERT(image);
+    BVR_ASSERT(pixels);
+
+#ifndef BVR_NO_PSD
+    if(layer >= BVR_BUFFER_COUNT(image->layers)){
+        return BVR_FAILED;
+    }
+
+    bvr_layer_t* target = &((bvr_layer_t*)image->layers.data)[layer];
+    uint64 sample_size = bvri_sizeof_sample(image->depth);
+    uint8* unpacked;
+
+    // empty layers (like groups' dividers) have no pixels
+    if(target->width <= 0 || target->height <= 0){
+        bvri_release_layer_data(target);
+        target->flags |= BVR_LAYER_LOADED;
+        return BVR_OK;
+    }
+
+    if(!target->packed.data){
+        return BVR_FAILED;
+    }
+
+    unpacked = malloc(target->width * target->height * sample_size);
+    BVR_ASSERT(unpacked);
+
+    for (uint64 channel = 0; channel < BVR_BUFFER_COUNT(target->channels); channel++)
+    {
+        bvr_layer_channel_t* channel_ptr = &((bvr_layer_channel_t*)target->channels.data)[channel];
+        int image_channel;
+
+        switch (channel_ptr->id)
+        {
+        case -1: // transparency
+            image_channel = 3;
+            break;
+        case 0: // red
+        case 1: // green
+        case 2: // blue
+            image_channel = channel_ptr->id;
+            break;
+        default: // layer masks are not supported
+            continue;
+        }
+
+        if(image_channel >= image->channels){
+            continue;
+        }
+
+        BVRI_PROFILE_BEGIN(decompress);
+        if((uint64)channel_ptr->offset + channel_ptr->length > target->packed.size ||
+            !bvri_psd_unpack_channel(
+                (uint8*)target->packed.data + channel_ptr->offset, channel_ptr->length,
+                target->width * sample_size, target->height, unpacked)){
+
+            BVR_PRINT("skipping layer channel");
+            continue;
+        }
+        BVRI_PROFILE_END(decompress);
+
+        BVRI_PROFILE_BEGIN(scatter);
+        for (int strip = 0; strip < target->height; strip++)
+        {
+#ifndef BVR_NO_FLIP
+            int y = strip + target->anchor_y;
+            int x = target->anchor_x;
+#else
+            int y = strip;
+            int x = 0;
+#endif
+            if(y < 0 || y >= image->height){
+                continue;
+            }
+
+            for (int column = 0; column < target->width; column++)
+            {
+                if(x + column < 0 || x + column >= image->width){
+                    continue;
+                }
+
+                bvri_psd_copy_sample(
+                    pixels, (y * image->width + x + column) * image->channels + image_channel,
+                    unpacked, strip * target->width + column, sample_size
+                );
+            }
+        }
+        BVRI_PROFILE_END(scatter);
+    }
+
+    free(unpacked);
+
+    // layer is decoded, its packed data is useless
+    bvri_release_layer_data(target);
+    target->flags |= BVR_LAYER_LOADED;
+    return BVR_OK;
+#else
+    return BVR_FAILED;
+#endif
+}
+
 /*
     Create a default layer on an image.
     This layer will have the same size as the image.
@@ -1165,11 +1738,17 @@ static void bvri_create_empty_layer(bvr_image_t* image){
     image->layers.size = image->layers.elemsize;
 
     ((bvr_layer_t*)image->layers.data)[0].blend_mode = BVR_LAYER_BLEND_NORMAL;
-    ((bvr_layer_t*)image->layers.data)[0].flags = 0;
+    ((bvr_layer_t*)image->layers.data)[0].flags = BVR_LAYER_LOADED;
     ((bvr_layer_t*)image->layers.data)[0].width = image->width;
     ((bvr_layer_t*)image->layers.data)[0].height = image->height;
     ((bvr_layer_t*)image->layers.data)[0].anchor_x = 0;
     ((bvr_layer_t*)image->layers.data)[0].anchor_y = 0;
+    ((bvr_layer_t*)image->layers.data)[0].channels.data = NULL;
+    ((bvr_layer_t*)image->layers.data)[0].channels.size = 0;
+    ((bvr_layer_t*)image->layers.data)[0].channels.elemsize = sizeof(bvr_layer_channel_t);
+    ((bvr_layer_t*)image->layers.data)[0].packed.data = NULL;
+    ((bvr_layer_t*)image->layers.data)[0].packed.size = 0;
+    ((bvr_layer_t*)image->layers.data)[0].packed.elemsize = sizeof(uint8);
     
     bvr_create_string(&((bvr_layer_t*)image->layers.data)[0].name, "layer0");
 }
@@ -1205,12 +1784,14 @@ static void bvri_flip_image_vertically_raw(uint8* pixels, int stride, int width,
     }
 }
 
-int bvr_create_imagef(bvr_image_t* image, FILE* file){
+static int bvri_create_imagef(bvr_image_t* image, FILE* file, int flags){
     BVR_ASSERT(image);
     BVR_ASSERT(file);
 
     int status = 0;
 
+    BVRI_PROFILE_BEGIN(total);
+
     image->width = 0;
     image->height = 0;
     image->depth = 0;
@@ -1224,44 +1805,74 @@ int bvr_create_imagef(bvr_image_t* image, FILE* file){
     // I should change image format order so that it will reduce signature errors.
 #ifndef BVR_NO_PNG
     if(bvri_is_png(file)){ 
-        status = bvri_load_png(image, file);
+        status = bvri_load_png(image, file, flags);
     }
 #endif
 
 #ifndef BVR_NO_BMP
     if(bvri_is_bmp(file) && !status){
         status = bvri_load_bmp(image, file);
+
+        // bitmaps are downscaled once fully decoded
+        if(status){
+            bvri_image_downscale(image, bvri_scale_denominator(flags));
+        }
     }
 #endif
 
 #ifndef BVR_NO_TIF
     if(bvri_is_tif(file) && !status){
-        status = bvri_load_tif(image, file);
+        status = bvri_load_tif(image, file, flags);
     }
 #endif
 
 #ifndef BVR_NO_PSD
     if(bvri_is_psd(file) && !status){
-        status = bvri_load_psd(image, file);
+        status = bvri_load_psd(image, file, flags);
     }
 #endif
 
+    if(BVR_HAS_FLAG(flags, BVR_IMAGE_LOAD_REDUCE_16) && status){
+        bvr_image_reduce_depth(image);
+    }
+
 #ifndef BVR_NO_FLIP
     if(image->pixels && status){
+        BVRI_PROFILE_BEGIN(flip);
         bvr_flip_image_vertically(image);
+        BVRI_PROFILE_END(flip);
     }
 #endif
 
+    BVRI_PROFILE_END(total);
+
     return status;
 }
 
+#ifdef BVR_IMAGE_PROFILE
+
+bvr_image_profile_t* bvr_image_get_profile(void){
+    return &bvri_profile;
+}
+
+void bvr_image_reset_profile(void){
+    memset(&bvri_profile, 0, sizeof(bvr_image_profile_t));
+}
+
+#endif
+
+int bvr_create_imagef(bvr_image_t* image, FILE* file, int flags){
+    // lazy layers are only handled by layered textures
+    return bvri_create_imagef(image, file, flags & ~BVRI_IMAGE_LAZY_LAYERS);
+}
+
 int bvr_create_bitmap(bvr_image_t* bitmap, const char* path, int channel){
     BVR_ASSERT(bitmap);
     BVR_ASSERT(path);
 
     bvr_image_t image;
     FILE* file = fopen(path, "rb");
-    bvr_create_imagef(&image, file);
+    bvr_create_imagef(&image, file, 0);
     if(!image.pixels){
         fclose(file);
 
@@ -1271,7 +1882,7 @@ int bvr_create_bitmap(bvr_image_t* bitmap, const char* path, int channel){
 
     bitmap->width = image.width;
     bitmap->height = image.height;
-    bitmap->depth = image.depth;
+    bitmap->depth = 8;
     bitmap->format = BVR_R;
     bitmap->channels = 1;
     bitmap->layers.data = NULL;
@@ -1296,12 +1907,61 @@ void bvr_flip_image_vertically(bvr_image_t* image){
 
     for (uint64 layer = 0; layer < BVR_BUFFER_COUNT(image->layers); layer++){
         bvri_flip_image_vertically_raw(
-            &image->pixels[image->width * image->height * image->channels * layer],
-            image->width * image->channels, image->width, image->height, image->channels
+            &image->pixels[image->width * image->height * bvri_sizeof_pixel(image) * layer],
+            image->width * bvri_sizeof_pixel(image), image->width, image->height, image->channels
         );
     }
 }
 
+void bvr_image_reduce_depth(bvr_image_t* image){
+    BVR_ASSERT(image);
+
+    // 4x4 Bayer matrix
+    static const uint8 threshold[16] = {
+         0,  8,  2, 10,
+        12,  4, 14,  6,
+         3, 11,  1,  9,
+        15,  7, 13,  5
+    };
+
+    if(image->depth != 16 || !image->pixels){
+        return;
+    }
+
+    uint64 layer_count = BVR_BUFFER_COUNT(image->layers);
+    if(!layer_count){
+        layer_count = 1;
+    }
+
+    const uint16* source = (const uint16*)image->pixels;
+    uint8* target = image->pixels;
+
+    // target never overtakes source, so we can reduce in place
+    for (uint64 layer = 0; layer < layer_count; layer++)
+    {
+        for (uint64 y = 0; y < image->height; y++)
+        {
+            for (uint64 x = 0; x < image->width; x++)
+            {
+                // bias each sample by less than one 8-bit step before truncating
+                uint32 bias = threshold[(y & 3) * 4 + (x & 3)] * 4096 + 2048;
+
+                for (uint64 channel = 0; channel < image->channels; channel++)
+                {
+                    *target++ = (uint8)(((uint32)*source++ * 255 + bias) / 65535);
+                }
+            }
+        }
+    }
+
+    image->depth = 8;
+    
+    uint8* pixels = realloc(image->pixels, target - image->pixels);
+    if(pixels){
+        image->pixels = pixels;
+    }
+}
+
 int bvr_image_copy_channel(bvr_image_t* image, int channel, uint8* buffer){
     BVR_ASSERT(image);
     BVR_ASSERT(image->pixels);
@@ -1331,7 +1991,12 @@ int bvr_image_copy_channel(bvr_image_t* image, int channel, uint8* buffer){
     {
         for (uint64 x = 0; x < image->width; x++)
         {
-            buffer[y * image->width + x] = image->pixels[(y * image->width + x) * image->channels + channel];
+            if(image->depth == 16){
+                buffer[y * image->width + x] = ((uint16*)image->pixels)[(y * image->width + x) * image->channels + channel] >> 8;
+            }
+            else {
+                buffer[y * image->width + x] = image->pixels[(y * image->width + x) * image->channels + channel];
+            }
         }
     }
 }
@@ -1342,6 +2007,8 @@ void bvr_destroy_image(bvr_image_t* image){
     for (uint64 layer = 0; layer < BVR_BUFFER_COUNT(image->layers); layer++)
     {
         bvr_destroy_string(&((bvr_layer_t*)image->layers.data)[layer].name);
+        free(((bvr_layer_t*)image->layers.data)[layer].channels.data);
+        free(((bvr_layer_t*)image->layers.data)[layer].packed.data);
     }
     
 
@@ -1357,8 +2024,8 @@ static int bvri_sizeof_format(int format, int depth){
         {
         case BVR_R: return BVR_RED16;
         case BVR_RG: return BVR_RG16;
-        case BVR_RGB: case BVR_BGR: return BVR_RGB16;
-        case BVR_RGBA: case BVR_BGRA: return BVR_RGBA16;
+        case BVR_RGB: case BVR_BGR: return BVR_RGB16F;
+        case BVR_RGBA: case BVR_BGRA: return BVR_RGBA16F;
         default:
             return BVR_RED16;
         }
@@ -1375,6 +2042,13 @@ static int bvri_sizeof_format(int format, int depth){
     }
 }
 
+/*
+    Return pixel's component type used to upload image's pixels.
+*/
+static int bvri_sizeof_type(int depth){
+    return depth == 16 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_BYTE;
+}
+
 int bvr_create_texture_from_image(bvr_texture_t* texture, bvr_image_t* image, int filter, int wrap){
     BVR_ASSERT(texture);
     BVR_ASSERT(image);
@@ -1405,7 +2079,7 @@ int bvr_create_texture_from_image(bvr_texture_t* texture, bvr_image_t* image, in
     int internal_format = bvri_sizeof_format(image->format, image->depth);
 
     glTexStorage2D(GL_TEXTURE_2D, 1, internal_format, image->width, image->height);
-    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, image->width, image->height, format, GL_UNSIGNED_BYTE, image->pixels);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, image->width, image->height, format, bvri_sizeof_type(image->depth), image->pixels);
     glGenerateMipmap(GL_TEXTURE_2D);
 
     glBindTexture(GL_TEXTURE_2D, 0);
@@ -1416,11 +2090,11 @@ int bvr_create_texture_from_image(bvr_texture_t* texture, bvr_image_t* image, in
     return BVR_OK;
 }
 
-int bvr_create_texturef(bvr_texture_t* texture, FILE* file, int filter, int wrap){
+int bvr_create_texturef(bvr_texture_t* texture, FILE* file, int filter, int wrap, int flags){
     BVR_ASSERT(texture);
     BVR_ASSERT(file);
 
-    bvr_create_imagef(&texture->image, file);
+    bvr_create_imagef(&texture->image, file, flags);
     if(!texture->image.pixels){
         BVR_PRINT("invalid image!");
         return BVR_FAILED;
@@ -1458,7 +2132,7 @@ int bvr_create_texture_atlasf(bvr_texture_atlas_t* atlas, FILE* file,
 
     atlas->id = 0;
     
-    bvr_create_imagef(&atlas->image, file);
+    bvr_create_imagef(&atlas->image, file, 0);
     if(!atlas->image.pixels){
         BVR_PRINT("invalid image!");
         return BVR_FAILED;
@@ -1494,8 +2168,8 @@ int bvr_create_texture_atlasf(bvr_texture_atlas_t* atlas, FILE* file,
             glTexSubImage3D(
                 GL_TEXTURE_2D_ARRAY, 0, 0, 0,
                 y * (atlas->image.width / atlas->tile_width) + x,
-                atlas->tile_width, atlas->tile_height, 1, atlas->image.format, GL_UNSIGNED_BYTE,
-                atlas->image.pixels + ((y * atlas->tile_height * atlas->image.width + x * atlas->tile_width) * atlas->image.channels)
+                atlas->tile_width, atlas->tile_height, 1, atlas->image.format, bvri_sizeof_type(atlas->image.depth),
+                atlas->image.pixels + ((y * atlas->tile_height * atlas->image.width + x * atlas->tile_width) * bvri_sizeof_pixel(&atlas->image))
             );
         }
     }
@@ -1532,8 +2206,9 @@ int bvr_create_layered_texturef(bvr_layered_texture_t* texture, FILE* file, int
 
     texture->id = 0;
 
-    bvr_create_imagef(&texture->image, file);
-    if(!texture->image.pixels){
+    // layers that hold packed data are only decoded when they're required
+    bvri_create_imagef(&texture->image, file, BVRI_IMAGE_LAZY_LAYERS);
+    if(!texture->image.pixels && !texture->image.layers.data){
         BVR_PRINT("invalid image!");
         return BVR_FAILED;
     }
@@ -1565,7 +2240,7 @@ int bvr_create_layered_texturef(bvr_layered_texture_t* texture, FILE* file, int
         texture->image.layers.size / sizeof(bvr_layer_t)
     );
 
-    for (uint64 layer = 0; layer < texture->image.layers.size / sizeof(bvr_layer_t); layer++)
+    for (uint64 layer = 0; layer < texture->image.layers.size / sizeof(bvr_layer_t) && texture->image.pixels; layer++)
     {
 
 #ifndef BVR_NO_FLIP
@@ -1576,8 +2251,8 @@ int bvr_create_layered_texturef(bvr_layered_texture_t* texture, FILE* file, int
             layer,
             texture->image.width, 
             texture->image.height, 
-            1, texture->image.format, GL_UNSIGNED_BYTE,
-            texture->image.pixels + texture->image.width * texture->image.height * texture->image.channels * layer
+            1, texture->image.format, bvri_sizeof_type(texture->image.depth),
+            texture->image.pixels + texture->image.width * texture->image.height * bvri_sizeof_pixel(&texture->image) * layer
         );
 #else
         glTexSubImage3D(
@@ -1587,8 +2262,8 @@ int bvr_create_layered_texturef(bvr_layered_texture_t* texture, FILE* file, int
             layer,
             ((bvr_layer_t*)texture->image.layers.data)[layer].width, 
             ((bvr_layer_t*)texture->image.layers.data)[layer].height, 
-            1, texture->image.format, GL_UNSIGNED_BYTE,
-            texture->image.pixels + texture->image.width * texture->image.height * texture->image.channels * layer
+            1, texture->image.format, bvri_sizeof_type(texture->image.depth),
+            texture->image.pixels + texture->image.width * texture->image.height * bvri_sizeof_pixel(&texture->image) * layer
         );
 #endif
     }
@@ -1601,6 +2276,69 @@ int bvr_create_layered_texturef(bvr_layered_texture_t* texture, FILE* file, int
     return BVR_OK;
 }
 
+int bvr_layered_texture_load_layer(bvr_layered_texture_t* texture, uint32 layer){
+    BVR_ASSERT(texture);
+
+    if(layer >= BVR_BUFFER_COUNT(texture->image.layers)){
+        return BVR_FAILED;
+    }
+
+    bvr_layer_t* target = &((bvr_layer_t*)texture->image.layers.data)[layer];
+    if(BVR_HAS_FLAG(target->flags, BVR_LAYER_LOADED)){
+        return BVR_OK;
+    }
+
+    uint64 layer_stride = texture->image.width * texture->image.height * bvri_sizeof_pixel(&texture->image);
+    uint8* pixels = calloc(layer_stride, sizeof(uint8));
+    BVR_ASSERT(pixels);
+
+    if(!bvr_image_decode_layer(&texture->image, layer, pixels)){
+        free(pixels);
+        return BVR_FAILED;
+    }
+
+#ifndef BVR_NO_FLIP
+    bvri_flip_image_vertically_raw(pixels, 
+        texture->image.width * bvri_sizeof_pixel(&texture->image), 
+        texture->image.width, texture->image.height, texture->image.channels
+    );
+#endif
+
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texture->id);
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, texture->image.width);
+    glPixelStorei(GL_UNPACK_IMAGE_HEIGHT, texture->image.height);
+
+#ifndef BVR_NO_FLIP
+    glTexSubImage3D(
+        GL_TEXTURE_2D_ARRAY, 0, 
+        0, 
+        0,
+        layer,
+        texture->image.width, 
+        texture->image.height, 
+        1, texture->image.format, bvri_sizeof_type(texture->image.depth),
+        pixels
+    );
+#else
+    glTexSubImage3D(
+        GL_TEXTURE_2D_ARRAY, 0, 
+        target->anchor_x, 
+        target->anchor_y,
+        layer,
+        target->width, 
+        target->height, 
+        1, texture->image.format, bvri_sizeof_type(texture->image.depth),
+        pixels
+    );
+#endif
+
+    free(pixels);
+
+    return BVR_OK;
+}
+
 void bvr_layered_texture_enable(bvr_layered_texture_t* texture, int unit){
     glActiveTexture(unit);
     glBindTexture(GL_TEXTURE_2D_ARRAY, texture->id);
@@ -1615,4 +2353,308 @@ void bvr_destroy_layered_texture(bvr_layered_texture_t* texture){
 
     glDeleteTextures(1, &texture->id);
     bvr_destroy_image(&texture->image);
-}
\ No newline at end of file
+}
+
+#define BVR_THUMBNAIL_SIG "BVRT"
+
+struct bvri_thumbnail_header_s {
+    char sig[4];
+    int64 source_time;
+
+    uint32 width, height;
+    int format;
+    uint8 channels;
+};
+
+/*
+    Read image's dimensions from its header without decoding it.
+*/
+static int bvri_probe_image_size(FILE* file, uint32* width, uint32* height){
+#ifndef BVR_NO_PNG
+    if(bvri_is_png(file)){
+        fseek(file, 16, SEEK_SET);
+        *width = bvr_freadu32_be(file);
+        *height = bvr_freadu32_be(file);
+        return BVR_OK;
+    }
+#endif
+
+#ifndef BVR_NO_BMP
+    if(bvri_is_bmp(file)){
+        fseek(file, 18, SEEK_SET);
+        *width = bvr_freadu32_le(file);
+        *height = abs(bvr_fread32_le(file));
+        return BVR_OK;
+    }
+#endif
+
+#ifndef BVR_NO_PSD
+    if(bvri_is_psd(file)){
+        fseek(file, 14, SEEK_SET);
+        *height = bvr_freadu32_be(file);
+        *width = bvr_freadu32_be(file);
+        return BVR_OK;
+    }
+#endif
+
+    return BVR_FAILED;
+}
+
+/*
+    Return the downscale denominator that fits an image into a thumbnail.
+*/
+static uint32 bvri_thumbnail_scale(uint32 width, uint32 height){
+    uint32 scale = (width > height ? width : height) / BVR_THUMBNAIL_SIZE;
+    
+    if(scale > 0xFF){
+        scale = 0xFF;
+    }
+    return scale ? scale : 1;
+}
+
+static int bvri_read_thumbnail_cache(const char* path, int64 source_time, bvr_image_t* image){
+    struct bvri_thumbnail_header_s header;
+    FILE* file = fopen(path, "rb");
+    if(!file){
+        return BVR_FAILED;
+    }
+
+    // outdated thumbnails are regenerated
+    if(fread(&header, sizeof(header), 1, file) != 1 || 
+        memcmp(header.sig, BVR_THUMBNAIL_SIG, sizeof(header.sig)) != 0 || 
+        header.source_time != source_time){
+        
+        fclose(file);
+        return BVR_FAILED;
+    }
+
+    image->width = header.width;
+    image->height = header.height;
+    image->depth = 8;
+    image->format = header.format;
+    image->channels = header.channels;
+    image->pixels = malloc((uint64)image->width * image->height * image->channels);
+    BVR_ASSERT(image->pixels);
+
+    if(fread(image->pixels, image->channels, (uint64)image->width * image->height, file) != (uint64)image->width * image->height){
+        free(image->pixels);
+        image->pixels = NULL;
+    }
+
+    fclose(file);
+    return image->pixels != NULL;
+}
+
+static void bvri_write_thumbnail_cache(const char* path, int64 source_time, bvr_image_t* image){
+    struct bvri_thumbnail_header_s header;
+    FILE* file = fopen(path, "wb");
+    if(!file){
+        return;
+    }
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.sig, BVR_THUMBNAIL_SIG, sizeof(header.sig));
+    header.source_time = source_time;
+    header.width = image->width;
+    header.height = image->height;
+    header.format = image->format;
+    header.channels = image->channels;
+
+    fwrite(&header, sizeof(header), 1, file);
+    fwrite(image->pixels, image->channels, (uint64)image->width * image->height, file);
+    fclose(file);
+}
+
+/*
+    Load a thumbnail from the disk cache or decode it from its source.
+    Runs on the worker thread.
+*/
+static int bvri_load_thumbnail(bvr_thumbnail_generator_t* generator, bvr_thumbnail_t* thumbnail){
+    SDL_PathInfo info;
+    char cache_path[BVR_BUFFER_SIZE];
+    bvr_image_t* image = &thumbnail->texture.image;
+    uint32 width, height;
+    FILE* file;
+
+    if(!SDL_GetPathInfo(thumbnail->path.string, &info)){
+        return BVR_FAILED;
+    }
+
+    snprintf(cache_path, sizeof(cache_path), "%s%s.bvrt", generator->cache_path.string, thumbnail->id);
+    if(bvri_read_thumbnail_cache(cache_path, info.modify_time, image)){
+        return BVR_OK;
+    }
+
+    file = fopen(thumbnail->path.string, "rb");
+    if(!file){
+        return BVR_FAILED;
+    }
+
+    // only decode what the thumbnail needs
+    int flags = BVR_IMAGE_LOAD_COMPOSITE | BVR_IMAGE_LOAD_REDUCE_16;
+    if(bvri_probe_image_size(file, &width, &height)){
+        flags |= BVR_IMAGE_LOAD_SCALE(bvri_thumbnail_scale(width, height));
+    }
+
+    bvr_create_imagef(image, file, flags);
+    fclose(file);
+
+    if(!image->pixels){
+        return BVR_FAILED;
+    }
+
+    // for formats that couldn't be probed
+    bvri_image_downscale(image, bvri_thumbnail_scale(image->width, image->height));
+    bvri_write_thumbnail_cache(cache_path, info.modify_time, image);
+
+    return BVR_OK;
+}
+
+static int bvri_thumbnail_worker(void* data){
+    bvr_thumbnail_generator_t* generator = (bvr_thumbnail_generator_t*)data;
+
+    SDL_LockMutex(generator->lock);
+    while (generator->running)
+    {
+        bvr_thumbnail_t* thumbnail = NULL;
+        for (uint64 i = 0; i < BVR_BUFFER_COUNT(generator->thumbnails); i++)
+        {
+            thumbnail = ((bvr_thumbnail_t**)generator->thumbnails.data)[i];
+            if(thumbnail->state == BVR_THUMBNAIL_QUEUED){
+                break;
+            }
+            thumbnail = NULL;
+        }
+        
+        if(!thumbnail){
+            SDL_WaitCondition(generator->signal, generator->lock);
+            continue;
+        }
+
+        thumbnail->state = BVR_THUMBNAIL_LOADING;
+        SDL_UnlockMutex(generator->lock);
+
+        int status = bvri_load_thumbnail(generator, thumbnail);
+        
+        SDL_LockMutex(generator->lock);
+        thumbnail->state = status ? BVR_THUMBNAIL_READY : BVR_THUMBNAIL_FAILED;
+    }
+    SDL_UnlockMutex(generator->lock);
+
+    return 0;
+}
+
+int bvr_create_thumbnail_generator(bvr_thumbnail_generator_t* generator, const char* cache_path){
+    BVR_ASSERT(generator);
+    BVR_ASSERT(cache_path);
+
+    generator->thumbnails.data = NULL;
+    generator->thumbnails.size = 0;
+    generator->thumbnails.elemsize = sizeof(bvr_thumbnail_t*);
+    generator->running = 1;
+
+    bvr_create_string(&generator->cache_path, cache_path);
+    SDL_CreateDirectory(cache_path);
+
+    generator->lock = SDL_CreateMutex();
+    generator->signal = SDL_CreateCondition();
+    generator->thread = SDL_CreateThread(bvri_thumbnail_worker, "bvr_thumbnails", generator);
+
+    if(!generator->lock || !generator->signal || !generator->thread){
+        BVR_PRINT("failed to create thumbnail worker!");
+        return BVR_FAILED;
+    }
+
+    return BVR_OK;
+}
+
+bvr_thumbnail_t* bvr_request_thumbnail(bvr_thumbnail_generator_t* generator, bvr_asset_t* asset){
+    BVR_ASSERT(generator);
+    BVR_ASSERT(asset);
+
+    bvr_thumbnail_t* thumbnail = NULL;
+
+    SDL_LockMutex(generator->lock);
+    for (uint64 i = 0; i < BVR_BUFFER_COUNT(generator->thumbnails); i++)
+    {
+        if(bvr_uuid_equals(((bvr_thumbnail_t**)generator->thumbnails.data)[i]->id, asset->id)){
+            thumbnail = ((bvr_thumbnail_t**)generator->thumbnails.data)[i];
+            break;
+        }
+    }
+
+    if(!thumbnail){
+        thumbnail = calloc(1, sizeof(bvr_thumbnail_t));
+        BVR_ASSERT(thumbnail);
+
+        bvr_copy_uuid(asset->id, thumbnail->id);
+        bvr_string_create_and_copy(&thumbnail->path, &asset->path);
+        thumbnail->state = BVR_THUMBNAIL_QUEUED;
+        thumbnail->texture.image.layers.elemsize = sizeof(bvr_layer_t);
+
+        generator->thumbnails.data = realloc(generator->thumbnails.data, generator->thumbnails.size + generator->thumbnails.elemsize);
+        BVR_ASSERT(generator->thumbnails.data);
+
+        ((bvr_thumbnail_t**)generator->thumbnails.data)[BVR_BUFFER_COUNT(generator->thumbnails)] = thumbnail;
+        generator->thumbnails.size += generator->thumbnails.elemsize;
+
+        SDL_SignalCondition(generator->signal);
+    }
+    SDL_UnlockMutex(generator->lock);
+
+    return thumbnail;
+}
+
+void bvr_thumbnail_generator_update(bvr_thumbnail_generator_t* generator){
+    BVR_ASSERT(generator);
+
+    SDL_LockMutex(generator->lock);
+    for (uint64 i = 0; i < BVR_BUFFER_COUNT(generator->thumbnails); i++)
+    {
+        bvr_thumbnail_t* thumbnail = ((bvr_thumbnail_t**)generator->thumbnails.data)[i];
+        
+        if(thumbnail->state == BVR_THUMBNAIL_READY && !thumbnail->texture.id){
+            bvr_create_texture_from_image(&thumbnail->texture, &thumbnail->texture.image, BVR_TEXTURE_FILTER_LINEAR, BVR_TEXTURE_WRAP_CLAMP_TO_EDGE);
+        }
+    }
+    SDL_UnlockMutex(generator->lock);
+}
+
+void bvr_destroy_thumbnail_generator(bvr_thumbnail_generator_t* generator){
+    BVR_ASSERT(generator);
+
+    if(generator->thread){
+        SDL_LockMutex(generator->lock);
+        generator->running = 0;
+        SDL_SignalCondition(generator->signal);
+        SDL_UnlockMutex(generator->lock);
+
+        SDL_WaitThread(generator->thread, NULL);
+        generator->thread = NULL;
+    }
+
+    for (uint64 i = 0; i < BVR_BUFFER_COUNT(generator->thumbnails); i++)
+    {
+        bvr_thumbnail_t* thumbnail = ((bvr_thumbnail_t**)generator->thumbnails.data)[i];
+        
+        if(thumbnail->texture.id){
+            bvr_destroy_texture(&thumbnail->texture);
+        }
+        else {
+            bvr_destroy_image(&thumbnail->texture.image);
+        }
+
+        bvr_destroy_string(&thumbnail->path);
+        free(thumbnail);
+    }
+
+    SDL_DestroyCondition(generator->signal);
+    SDL_DestroyMutex(generator->lock);
+    bvr_destroy_string(&generator->cache_path);
+    
+    free(generator->thumbnails.data);
+    generator->thumbnails.data = NULL;
+    generator->thumbnails.size = 0;
+    generator->lock = NULL;
+    generator->signal = NULL;
+}
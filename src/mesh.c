@@ -1,6 +1,7 @@
 #include <BVR/mesh.h>
 #include <BVR/math.h>
 #include <BVR/buffer.h>
+#include <BVR/file.h>
 #include <BVR/physics.h>
 
 #include <malloc.h>
@@ -9,704 +10,5153 @@
 
 #include <GLAD/glad.h>
 
-static int bvri_create_mesh_buffers(bvr_mesh_t* mesh, uint64 vertices_size, uint64 element_size, 
-    int vertex_type, int element_type, bvr_mesh_array_attrib_t attrib);
+#include <SDL3/SDL_thread.h>
+#include <SDL3/SDL_mutex.h>
+#include <SDL3/SDL_cpuinfo.h>
+#include <SDL3/SDL_filesystem.h>
+#include <SDL3/SDL_timer.h>
 
-#ifndef BVR_NO_OBJ
+#ifndef BVR_NO_GLTF
+#include <json.h>
+#endif
 
-#include <ctype.h>
+static int bvri_create_mesh_buffers(bvr_mesh_t* mesh, uint64 vertices_size, uint64 element_size, 
+    void* vertices, void* elements, int vertex_type, int element_type, bvr_mesh_array_attrib_t attrib);
+static int bvri_upload_mesh_buffers(bvr_mesh_t* mesh, uint64 vertices_size, uint64 element_size, 
+    void* vertices, void* elements, int vertex_type, bvr_mesh_array_attrib_t attrib);
+static void bvri_set_mesh_positions(bvr_mesh_t* mesh, float* positions, uint32 vertex_count, uint8 components);
 
-static int bvri_objreadline(char* buffer, FILE* file){
-    int c;
-    while (c = getc(file), c != EOF && c != '\n') {
-        *buffer++ = c;
-    }
+/*
+    Buffers' content of a mesh loaded in background, kept until the render thread creates its buffers.
+*/
+struct bvri_mesh_upload_s {
+    void* vertices;
+    void* elements;
+
+    uint64 vertices_size;
+    uint64 element_size;
+    int vertex_type;
+    bvr_mesh_array_attrib_t attrib;
+};
 
-    *buffer = '\0';
+/*
+    Set on the mesh loader's thread, while a mesh is being loaded.
+*/
+static SDL_TLSID __mesh_upload;
 
-    return c != EOF;
-}
+#ifndef BVR_MESH_CACHE_SIZE
+    #define BVR_MESH_CACHE_SIZE 16
+#endif
 
-static char* bvri_objparseint(char* buffer, int* v){
-    int sig = + 1;
-    int num = 0;
+void bvr_mesh_statistics(bvr_mesh_statistics_t* statistics, const void* elements, int element_type, 
+    uint32 element_count, uint32 vertex_count){
+    
+    BVR_ASSERT(statistics);
+    BVR_ASSERT(elements || !element_count);
 
-    if(*buffer == '-'){
-        sig = -1;
-        buffer++;
+    statistics->acmr = 0.0f;
+    statistics->atvr = 0.0f;
+
+    if(element_count < 3 || !vertex_count){
+        return;
     }
 
-    while (isdigit(*buffer))
+    // simulate a FIFO cache, timestamps tell if a vertex is still cached
+    uint32* timestamps = calloc(vertex_count, sizeof(uint32));
+    BVR_ASSERT(timestamps);
+
+    uint32 time = BVR_MESH_CACHE_SIZE + 1;
+    uint32 misses = 0;
+
+    for (uint32 i = 0; i < element_count; i++)
     {
-        num = 10 * num + (*buffer++ - '0');
+        uint32 index = element_type == BVR_UNSIGNED_INT16 ? ((uint16*)elements)[i] : ((uint32*)elements)[i];
+        BVR_ASSERT(index < vertex_count);
+
+        if(time - timestamps[index] > BVR_MESH_CACHE_SIZE){
+            timestamps[index] = time++;
+            misses++;
+        }
     }
-    
-    *v = sig * num;
 
-    return buffer;
+    free(timestamps);
+
+    statistics->acmr = (float)misses / (element_count / 3);
+    statistics->atvr = (float)misses / vertex_count;
 }
 
-static char* bvri_objparsefloat(char* buffer, float* v){
-    double sig = +1, p = +1;
-    double num = 0.0;
-    double fra = 0.0;
-    double div = 1.0;
-    uint32 e = 0;
+#ifndef BVR_NO_MESH_OPTIMIZATION
 
-    if(*buffer == '-'){
-        sig = -1;
-        buffer++;
-    }
-    else if(*buffer == '+'){
-        sig = +1;
-        buffer++;
-    }
+/*
+    Triangles adjacent to each vertex.
+*/
+struct bvri_adjacency_s {
+    uint32* offsets;
+    uint32* counts;
+    uint32* triangles;
+};
 
-    while (isdigit(*buffer))
+static void bvri_create_adjacency(struct bvri_adjacency_s* adjacency, const uint32* elements, uint32 element_count, uint32 vertex_count){
+    adjacency->offsets = malloc(vertex_count * sizeof(uint32));
+    adjacency->counts = calloc(vertex_count, sizeof(uint32));
+    adjacency->triangles = malloc(element_count * sizeof(uint32));
+    BVR_ASSERT(adjacency->offsets && adjacency->counts && adjacency->triangles);
+
+    for (uint32 i = 0; i < element_count; i++)
     {
-        num = 10 * num + (double)(*buffer++ - '0');
+        adjacency->counts[elements[i]]++;
     }
-    
-    if(*buffer == '.'){
-        buffer++;
+
+    uint32 offset = 0;
+    for (uint32 vertex = 0; vertex < vertex_count; vertex++)
+    {
+        adjacency->offsets[vertex] = offset;
+        offset += adjacency->counts[vertex];
+        adjacency->counts[vertex] = 0;
     }
 
-    while (isdigit(*buffer))
+    for (uint32 i = 0; i < element_count; i++)
     {
-        fra = 10.0 * fra + (double)(*buffer++ - '0');
-        div *= 10.0;
+        uint32 vertex = elements[i];
+        adjacency->triangles[adjacency->offsets[vertex] + adjacency->counts[vertex]++] = i / 3;
     }
+}
 
-    num += fra / div;
-    
-    BVR_ASSERT(*buffer == 'E' || *buffer == 'e' || "powers aren't supported :(");
+static void bvri_destroy_adjacency(struct bvri_adjacency_s* adjacency){
+    free(adjacency->offsets);
+    free(adjacency->counts);
+    free(adjacency->triangles);
+}
 
-    *v = (float)sig * num;
+/*
+    Reorder triangles for the post-transform vertex cache with Tipsify 
+    (Sander, Nehab and Barczak, "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw").
+    `clusters` receives the first triangle of each cluster, a new cluster starts each time the fanning
+    vertex is not adjacent to the previous one. Returns the cluster count.
+*/
+static uint32 bvri_optimize_vertex_cache(uint32* elements, uint32 element_count, uint32 vertex_count, uint32* clusters){
+    uint32 triangle_count = element_count / 3;
+    uint32 cluster_count = 0;
 
-    return buffer;
-}
+    struct bvri_adjacency_s adjacency;
+    bvri_create_adjacency(&adjacency, elements, element_count, vertex_count);
 
-static int bvri_is_obj(FILE* file){
-    fseek(file, 0, SEEK_SET);
+    uint32* live = malloc(vertex_count * sizeof(uint32));
+    uint32* timestamps = calloc(vertex_count, sizeof(uint32));
+    uint32* dead_ends = malloc(element_count * sizeof(uint32));
+    uint32* output = malloc(element_count * sizeof(uint32));
+    uint8* emitted = calloc(triangle_count, sizeof(uint8));
+    BVR_ASSERT(live && timestamps && dead_ends && output && emitted);
 
-    char sig[32];
+    memcpy(live, adjacency.counts, vertex_count * sizeof(uint32));
 
-    // check 5 first lines
-    for (uint64 i = 0; i < 5; i++)
+    uint32 dead_end_count = 0;
+    uint32 output_count = 0;
+    uint32 time = BVR_MESH_CACHE_SIZE + 1;
+    uint32 cursor = 0;
+    int64 fanning = -1;
+
+    while (1)
     {
-        bvri_objreadline(sig, file);
-        if(sig[0] == '#'){
-            continue;
+        // pick the next fanning vertex
+        if(fanning < 0){
+            while (dead_end_count && fanning < 0)
+            {
+                uint32 vertex = dead_ends[--dead_end_count];
+                if(live[vertex]){
+                    fanning = vertex;
+                }
+            }
+            
+            while (cursor < vertex_count && fanning < 0)
+            {
+                if(live[cursor]){
+                    fanning = cursor;
+                }
+                cursor++;
+            }
+
+            if(fanning < 0){
+                break;
+            }
+
+            clusters[cluster_count++] = output_count / 3;
         }
 
-        if(!strncmp(sig, "mtllib ", 7)){
-            return BVR_OK;
+        // emit every triangle around the fanning vertex
+        const uint32* triangles = adjacency.triangles + adjacency.offsets[fanning];
+        for (uint32 i = 0; i < adjacency.counts[fanning]; i++)
+        {
+            uint32 triangle = triangles[i];
+            if(emitted[triangle]){
+                continue;
+            }
+
+            emitted[triangle] = 1;
+            for (uint32 corner = 0; corner < 3; corner++)
+            {
+                uint32 vertex = elements[triangle * 3 + corner];
+
+                output[output_count++] = vertex;
+                dead_ends[dead_end_count++] = vertex;
+                live[vertex]--;
+
+                if(time - timestamps[vertex] > BVR_MESH_CACHE_SIZE){
+                    timestamps[vertex] = time++;
+                }
+            }
         }
 
-        if(sig[0] == 'o' && sig[1] == ' '){
-            return BVR_OK;
+        // prefer the vertex of the last triangles that will still be cached once its triangles are emitted
+        int64 best = -1;
+        int64 best_priority = -1;
+        for (uint32 i = 0; i < adjacency.counts[fanning]; i++)
+        {
+            for (uint32 corner = 0; corner < 3; corner++)
+            {
+                uint32 vertex = elements[triangles[i] * 3 + corner];
+                if(!live[vertex]){
+                    continue;
+                }
+
+                int64 priority = 0;
+                if(time - timestamps[vertex] + 2 * live[vertex] <= BVR_MESH_CACHE_SIZE){
+                    priority = time - timestamps[vertex];
+                }
+
+                if(priority > best_priority){
+                    best_priority = priority;
+                    best = vertex;
+                }
+            }
         }
+
+        fanning = best;
     }
-    
-    return BVR_FAILED;
+
+    BVR_ASSERT(output_count == element_count);
+    memcpy(elements, output, element_count * sizeof(uint32));
+
+    free(live);
+    free(timestamps);
+    free(dead_ends);
+    free(output);
+    free(emitted);
+    bvri_destroy_adjacency(&adjacency);
+
+    return cluster_count;
+}
+
+struct bvri_cluster_s {
+    uint32 first;
+    uint32 count;
+    float sort;
+};
+
+static int bvri_compare_clusters(const void* a, const void* b){
+    float sa = ((const struct bvri_cluster_s*)a)->sort;
+    float sb = ((const struct bvri_cluster_s*)b)->sort;
+    return (sa < sb) - (sa > sb);
 }
 
 /*
-    Push back a new vertex group as the targetted group
+    Sort clusters so that the ones facing out of the mesh are drawn first,
+    they are the most likely to occlude the others.
 */
-static bvr_vertex_group_t* bvri_objpushgrp(struct bvr_buffer_s* group, bvr_string_t* name){
-    bvr_vertex_group_t* vertex_group;
+static void bvri_optimize_overdraw(uint32* elements, uint32 element_count, const float* vertices, uint32 stride,
+    const uint32* clusters, uint32 cluster_count){
 
-    if(group->data){
-        group->data = realloc(group->data, group->size + group->elemsize);
-        BVR_ASSERT(group->data);
-
-        vertex_group = (bvr_vertex_group_t*)group->data + group->size;
-        group->size += group->elemsize;
+    if(cluster_count < 2){
+        return;
     }
-    else {
-        group->data = malloc(group->elemsize);
-        group->size += group->elemsize;
 
-        vertex_group = (bvr_vertex_group_t*)group->data;
+    struct bvri_cluster_s* sorted = malloc(cluster_count * sizeof(struct bvri_cluster_s));
+    BVR_ASSERT(sorted);
+
+    // mesh's centroid
+    vec3 center = {0.0f, 0.0f, 0.0f};
+    for (uint32 i = 0; i < element_count; i++)
+    {
+        vec3_add(center, center, &vertices[elements[i] * stride]);
     }
+    vec3_scale(center, center, 1.0f / element_count);
 
-    bvr_string_create_and_copy(&vertex_group->name, name);
-    vertex_group->element_count = 0;
-    return vertex_group;
-}
+    for (uint32 cluster = 0; cluster < cluster_count; cluster++)
+    {
+        sorted[cluster].first = clusters[cluster] * 3;
+        sorted[cluster].count = (cluster + 1 < cluster_count ? clusters[cluster + 1] * 3 : element_count) - sorted[cluster].first;
 
-struct bvri_objobject_s {
-    bvr_string_t name;
-    bvr_string_t material;
+        // area weighted normal and centroid of the cluster
+        vec3 normal = {0.0f, 0.0f, 0.0f};
+        vec3 centroid = {0.0f, 0.0f, 0.0f};
+        float area = 0.0f;
 
-    vec3 vertex[BVR_BUFFER_SIZE];
-    vec2 uvs[BVR_BUFFER_SIZE];
-    vec3 normals[BVR_BUFFER_SIZE];
-    struct {
-        uint32 vertex[4];
-        uint32 uv[4];
-        uint32 normal[4];
+        for (uint32 i = sorted[cluster].first; i < sorted[cluster].first + sorted[cluster].count; i += 3)
+        {
+            const float* a = &vertices[elements[i + 0] * stride];
+            const float* b = &vertices[elements[i + 1] * stride];
+            const float* c = &vertices[elements[i + 2] * stride];
 
-        uint8 edges;
-    } faces[BVR_BUFFER_SIZE];
+            vec3 ab, ac, cross;
+            vec3_sub(ab, b, a);
+            vec3_sub(ac, c, a);
 
-    bvr_mesh_buffer_t vertices;
-    bvr_mesh_buffer_t elements;
+            cross[0] = ab[1] * ac[2] - ab[2] * ac[1];
+            cross[1] = ab[2] * ac[0] - ab[0] * ac[2];
+            cross[2] = ab[0] * ac[1] - ab[1] * ac[0];
 
-    struct bvr_buffer_s vertex_group;
-    bvr_vertex_group_t* group;
+            float triangle_area = vec3_len(cross);
+            vec3_add(normal, normal, cross);
 
-    uint32 vertex_count;
-    uint32 uv_count;
-    uint32 normal_count;
-    uint32 face_count;
-};
+            for (uint32 axis = 0; axis < 3; axis++)
+            {
+                centroid[axis] += (a[axis] + b[axis] + c[axis]) * triangle_area / 3.0f;
+            }
+            area += triangle_area;
+        }
 
-static int bvri_load_obj(bvr_mesh_t* mesh, FILE* file){
-    BVR_ASSERT(mesh);
+        if(area > 0.0f){
+            vec3_scale(centroid, centroid, 1.0f / area);
+            vec3_scale(normal, normal, 1.0f / vec3_len(normal));
+        }
 
-    struct bvri_objobject_s object;
+        vec3_sub(centroid, centroid, center);
+        sorted[cluster].sort = vec3_dot(centroid, normal);
+    }
 
-    object.vertex_count = 0;
-    object.uv_count = 0;
-    object.normal_count = 0;
-    object.face_count = 0;
-    object.group = NULL;
+    qsort(sorted, cluster_count, sizeof(struct bvri_cluster_s), bvri_compare_clusters);
 
-    object.vertex_group.data = NULL;
-    object.vertex_group.elemsize = sizeof(bvr_vertex_group_t);
-    object.vertex_group.size = 0;
+    uint32* output = malloc(element_count * sizeof(uint32));
+    BVR_ASSERT(output);
 
-    object.elements.data = NULL;
-    object.vertices.data = NULL;
-    object.elements.count = 0;
-    object.vertices.count = 0;
-    object.elements.type = BVR_UNSIGNED_INT32;
-    object.vertices.type = BVR_FLOAT;
+    uint32 output_count = 0;
+    for (uint32 cluster = 0; cluster < cluster_count; cluster++)
+    {
+        memcpy(&output[output_count], &elements[sorted[cluster].first], sorted[cluster].count * sizeof(uint32));
+        output_count += sorted[cluster].count;
+    }
 
-    mesh->stride = 3;
-    if(mesh->attrib >= BVR_MESH_ATTRIB_V2UV2) mesh->stride += 2;
-    if(mesh->attrib == BVR_MESH_ATTRIB_V3UV2N3) mesh->stride += 3;
+    memcpy(elements, output, element_count * sizeof(uint32));
 
-    bvr_create_string(&object.name, NULL);
-    bvr_create_string(&object.material, NULL);
+    free(output);
+    free(sorted);
+}
 
-    char* cursor;
-    char buffer[256];
-    while(bvri_objreadline(buffer, file)){
-        switch (buffer[0])
-        {
-        case '#':
-            /* skip */
-            break;
-        
-        case 'm':
-            bvr_create_string(&object.material, &buffer[7]);
-            break;    
+/*
+    Reorder vertices by first use, so that vertex fetches are sequential.
+    Unused vertices are dropped. Returns the new vertex count.
+*/
+static uint32 bvri_optimize_vertex_fetch(float* vertices, uint32 stride, uint32 vertex_count, uint32* elements, uint32 element_count){
+    uint32* remap = malloc(vertex_count * sizeof(uint32));
+    float* output = malloc((uint64)vertex_count * stride * sizeof(float));
+    BVR_ASSERT(remap && output);
 
-        case 'o':
-            bvr_create_string(&object.name, &buffer[2]);
-            object.group = bvri_objpushgrp(&object.vertex_group, &object.name);
-            object.group->element_offset = object.elements.count;
-            break;
+    memset(remap, 0xFF, vertex_count * sizeof(uint32));
 
-        case 'v':
-            {
-                cursor = NULL;
+    uint32 count = 0;
+    for (uint32 i = 0; i < element_count; i++)
+    {
+        uint32 vertex = elements[i];
+        if(remap[vertex] == 0xFFFFFFFF){
+            memcpy(&output[(uint64)count * stride], &vertices[(uint64)vertex * stride], stride * sizeof(float));
+            remap[vertex] = count++;
+        }
 
-                if(buffer[1] == 'n' && mesh->stride >= 8){
-                    BVR_ASSERT(object.normal_count < BVR_BUFFER_SIZE);
+        elements[i] = remap[vertex];
+    }
 
-                    cursor = bvri_objparsefloat(&buffer[3], &object.normals[object.normal_count][0]);
-                    cursor = bvri_objparsefloat(++cursor, &object.normals[object.normal_count][1]);
-                    cursor = bvri_objparsefloat(++cursor, &object.normals[object.normal_count][2]);
-                    object.normal_count++;
-                }
-                else if(buffer[1] == 't' && mesh->stride >= 5){
-                    BVR_ASSERT(object.uv_count < BVR_BUFFER_SIZE);
-                    
-                    cursor = bvri_objparsefloat(&buffer[3], &object.uvs[object.uv_count][0]);
-                    cursor = bvri_objparsefloat(++cursor, &object.uvs[object.uv_count][1]);
-                    object.uv_count++;
-                }
-                else if(buffer[1] == ' '){
-                    BVR_ASSERT(object.vertex_count < BVR_BUFFER_SIZE);
+    memcpy(vertices, output, (uint64)count * stride * sizeof(float));
 
-                    cursor = bvri_objparsefloat(&buffer[2], &object.vertex[object.vertex_count][0]);
-                    cursor = bvri_objparsefloat(++cursor, &object.vertex[object.vertex_count][1]);
-                    cursor = bvri_objparsefloat(++cursor, &object.vertex[object.vertex_count][2]);
-                    object.vertex_count++;
-                }
-            }   
-            break;
-        
-        case 'f': 
-            {
-                BVR_ASSERT(object.face_count < BVR_BUFFER_SIZE);
+    free(output);
+    free(remap);
 
-                cursor = &buffer[1];
-                object.faces[object.face_count].edges = 0;
-                
-                while (*cursor != '\0')
-                {
-                    cursor = bvri_objparseint(++cursor, &object.faces[object.face_count].vertex[object.faces[object.face_count].edges]);    
-                    cursor = bvri_objparseint(++cursor, &object.faces[object.face_count].uv[object.faces[object.face_count].edges]);    
-                    cursor = bvri_objparseint(++cursor, &object.faces[object.face_count].normal[object.faces[object.face_count].edges]);    
+    return count;
+}
 
-                    object.faces[object.face_count].edges++;
-                    object.vertices.count += mesh->stride;
-                }
-                
-                if(object.faces[object.face_count].edges == 4){
-                    object.elements.count += 6;
-                    object.group->element_count += 6;
-                }
-                else {
-                    object.elements.count += 3;
-                    object.group->element_count += 3;
-                }
+/*
+    Optimize a 3D mesh made of float vertices, each vertex group is optimized on its own.
+    Returns the new vertex count.
+*/
+static uint32 bvri_optimize_mesh(float* vertices, uint32 stride, uint32 vertex_count, 
+    uint32* elements, uint32 element_count, struct bvr_buffer_s* vertex_groups){
 
-                object.face_count++;
-            }
-            break;
+#ifdef BVR_MESH_STATISTICS
+    bvr_mesh_statistics_t before, after;
+    bvr_mesh_statistics(&before, elements, BVR_UNSIGNED_INT32, element_count, vertex_count);
+#endif
 
-        default:
-            break;
+    uint32* clusters = malloc((element_count / 3 + 1) * sizeof(uint32));
+    BVR_ASSERT(clusters);
+
+    for (uint64 group = 0; group < BVR_BUFFER_COUNT((*vertex_groups)); group++)
+    {
+        bvr_vertex_group_t* vertex_group = &((bvr_vertex_group_t*)vertex_groups->data)[group];
+        if(vertex_group->element_count < 3){
+            continue;
         }
-    }
 
-    if(!object.elements.count || !object.vertices.count){
-        BVR_PRINT("failed to load mesh :(");
-        goto bvr_objfailed;
+        uint32* group_elements = elements + vertex_group->element_offset;
+        uint32 cluster_count = bvri_optimize_vertex_cache(group_elements, vertex_group->element_count, vertex_count, clusters);
+        bvri_optimize_overdraw(group_elements, vertex_group->element_count, vertices, stride, clusters, cluster_count);
     }
 
-    if(bvri_create_mesh_buffers(mesh, 
-        object.vertices.count * sizeof(float), 
-        object.elements.count * sizeof(uint32),
-        object.vertices.type, object.elements.type, mesh->attrib) == BVR_FAILED){
+    free(clusters);
 
-        BVR_PRINT("failed to create object buffers");
-        goto bvr_objfailed;
-    }
+    vertex_count = bvri_optimize_vertex_fetch(vertices, stride, vertex_count, elements, element_count);
 
-    mesh->vertex_groups.size = object.vertex_group.size;
-    mesh->vertex_groups.data = object.vertex_group.data;
+#ifdef BVR_MESH_STATISTICS
+    bvr_mesh_statistics(&after, elements, BVR_UNSIGNED_INT32, element_count, vertex_count);
+    BVR_PRINTF("mesh optimized, ACMR %.3f -> %.3f, ATVR %.3f -> %.3f", before.acmr, after.acmr, before.atvr, after.atvr);
+#endif
 
-    glBindBuffer(GL_ARRAY_BUFFER, mesh->vertex_buffer);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->element_buffer);
+    return vertex_count;
+}
 
-    uint64 vertex = 0, element = 0;
-    for (uint64 face = 0; face < object.face_count; face++)
-    {
-        BVR_ASSERT(object.faces[face].edges == 3 || object.faces[face].edges == 4);
 
-        if(object.faces[face].edges == 4){
-            BVR_ASSERT(0 || "not supported");
-        }
-        else {
-            BVR_ASSERT(element + 3 <= object.elements.count);
+#ifndef BVR_NO_MESH_LOD
 
-            const uint32 elements_values[3] = {element, element + 1, element + 2};
-            glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, element * sizeof(uint32), sizeof(elements_values), elements_values);
-            element += 3;
-        }
+/*
+    Weight of border planes, keeping open edges in place.
+*/
+#define BVRI_LOD_BORDER_WEIGHT 10.0
 
-        for (uint64 i = 0; i < object.faces[face].edges; i++)
-        {
-            BVR_ASSERT(vertex + 8 <= object.vertices.count);
+/*
+    Weight of attributes (uvs, normals) differences, relative to mesh's radius.
+*/
+#define BVRI_LOD_ATTRIBUTE_WEIGHT 0.05
 
-            glBufferSubData(GL_ARRAY_BUFFER, (vertex + 0) * sizeof(float), sizeof(vec3), object.vertex[object.faces[face].vertex[i] - 1]);
-            glBufferSubData(GL_ARRAY_BUFFER, (vertex + 3) * sizeof(float), sizeof(vec2), object.uvs[object.faces[face].uv[i] - 1]);
-            glBufferSubData(GL_ARRAY_BUFFER, (vertex + 5) * sizeof(float), sizeof(vec3), object.normals[object.faces[face].normal[i] - 1]);
-            vertex += 8;
-        }
-        
-    }
-    
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+#define BVRI_LOD_NONE 0xFFFFFFFF
 
-    bvr_destroy_string(&object.name);
-    bvr_destroy_string(&object.material);
+enum bvri_lod_vertex_e {
+    BVRI_LOD_VERTEX_MANIFOLD,
+    BVRI_LOD_VERTEX_BORDER,
+    BVRI_LOD_VERTEX_LOCKED
+};
 
-    free(object.vertices.data);
-    free(object.elements.data);
+/*
+    Symmetric matrix A, vector b and constant c of the sum of squared distances to planes,
+    error(p) = p.A.p + 2 b.p + c, weighted by planes' area.
+*/
+struct bvri_quadric_s {
+    double a00, a11, a22, a01, a02, a12;
+    double b0, b1, b2;
+    double c;
+    double weight;
+};
 
-    return BVR_OK;
+static void bvri_quadric_add_plane(struct bvri_quadric_s* quadric, const double* normal, double distance, double weight){
+    quadric->a00 += weight * normal[0] * normal[0];
+    quadric->a11 += weight * normal[1] * normal[1];
+    quadric->a22 += weight * normal[2] * normal[2];
+    quadric->a01 += weight * normal[0] * normal[1];
+    quadric->a02 += weight * normal[0] * normal[2];
+    quadric->a12 += weight * normal[1] * normal[2];
+    quadric->b0 += weight * normal[0] * distance;
+    quadric->b1 += weight * normal[1] * distance;
+    quadric->b2 += weight * normal[2] * distance;
+    quadric->c += weight * distance * distance;
+    quadric->weight += weight;
+}
 
-bvr_objfailed:
-    bvr_destroy_string(&object.name);
-    bvr_destroy_string(&object.material);
+static void bvri_quadric_add(struct bvri_quadric_s* quadric, const struct bvri_quadric_s* other){
+    double* target = (double*)quadric;
+    const double* source = (const double*)other;
 
-    for (uint64 i = 0; i < BVR_BUFFER_COUNT(object.vertex_group); i++)
+    for (uint32 i = 0; i < sizeof(struct bvri_quadric_s) / sizeof(double); i++)
     {
-        bvr_destroy_string(&((bvr_vertex_group_t*)object.vertex_group.data)[0].name);
+        target[i] += source[i];
     }
+}
+
+/*
+    Mean squared distance of a point to quadric's planes.
+*/
+static double bvri_quadric_error(const struct bvri_quadric_s* quadric, const float* p){
+    double rx = quadric->a00 * p[0] + quadric->a01 * p[1] + quadric->a02 * p[2];
+    double ry = quadric->a01 * p[0] + quadric->a11 * p[1] + quadric->a12 * p[2];
+    double rz = quadric->a02 * p[0] + quadric->a12 * p[1] + quadric->a22 * p[2];
     
-    free(object.vertex_group.data);
-    free(object.vertices.data);
-    free(object.elements.data);
+    double error = rx * p[0] + ry * p[1] + rz * p[2];
+    error += 2.0 * (quadric->b0 * p[0] + quadric->b1 * p[1] + quadric->b2 * p[2]);
+    error += quadric->c;
 
-    return BVR_FAILED;
+    return quadric->weight > 0.0 ? fabs(error) / quadric->weight : 0.0;
 }
 
-#endif
+/*
+    Unnormalized normal of a triangle, its length is twice triangle's area.
+*/
+static double bvri_lod_triangle_normal(double* normal, const float* a, const float* b, const float* c){
+    double ab[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+    double ac[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
 
-int bvr_create_meshf(bvr_mesh_t* mesh, FILE* file, bvr_mesh_array_attrib_t attrib){
-    BVR_ASSERT(mesh);
-    BVR_ASSERT(file);
+    normal[0] = ab[1] * ac[2] - ab[2] * ac[1];
+    normal[1] = ab[2] * ac[0] - ab[0] * ac[2];
+    normal[2] = ab[0] * ac[1] - ab[1] * ac[0];
 
-    int status = 0;
+    return sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+}
 
-    mesh->array_buffer = 0;
-    mesh->vertex_buffer = 0;
-    mesh->element_buffer = 0;
-    mesh->vertex_count = 0;
-    mesh->element_count = 0;
-    mesh->element_type = 0;
-    mesh->attrib_count = 0;
-    mesh->stride = 0;
-    mesh->attrib = attrib;
+/*
+    Vertices sharing the same position (wedges) are simplified as a single vertex,
+    their attributes are only used to pick the wedge a collapsed corner moves to.
+*/
+struct bvri_simplifier_s {
+    const float* vertices;
+    uint32 stride;
+    uint32 vertex_count;
 
-    mesh->vertex_groups.size = 0;
-    mesh->vertex_groups.elemsize = sizeof(bvr_vertex_group_t);
-    mesh->vertex_groups.data = NULL;
+    uint32* remap;  /* first vertex with the same position */
+    uint32* wedges; /* next vertex with the same position, circular */
+    uint8* locked;  /* vertices that must not move */
 
-#ifndef BVR_NO_OBJ
-    if(bvri_is_obj(file)){
-        status = bvri_load_obj(mesh, file);
-    }
-#endif
+    double attribute_weight;
+};
 
-    if(!status){
-        BVR_PRINT("failed to load model");
-    }
+struct bvri_lod_position_s {
+    const float* position;
+    uint32 vertex;
+};
 
-    return status;
-}
+static int bvri_lod_compare_positions(const void* a, const void* b){
+    const struct bvri_lod_position_s* pa = (const struct bvri_lod_position_s*)a;
+    const struct bvri_lod_position_s* pb = (const struct bvri_lod_position_s*)b;
 
-int bvr_create_meshv(bvr_mesh_t* mesh, bvr_mesh_buffer_t* vertices, bvr_mesh_buffer_t* elements, bvr_mesh_array_attrib_t attrib){
+    for (uint32 axis = 0; axis < 3; axis++)
+    {
+        if(pa->position[axis] != pb->position[axis]){
+            return pa->position[axis] < pb->position[axis] ? -1 : 1;
+        }
+    }
+    
+    return (int)(pa->vertex > pb->vertex) - (int)(pa->vertex < pb->vertex);
+}
+
+static void bvri_create_simplifier(struct bvri_simplifier_s* simplifier, const float* vertices, uint32 stride, uint32 vertex_count){
+    simplifier->vertices = vertices;
+    simplifier->stride = stride;
+    simplifier->vertex_count = vertex_count;
+    simplifier->remap = malloc(vertex_count * sizeof(uint32));
+    simplifier->wedges = malloc(vertex_count * sizeof(uint32));
+    simplifier->locked = calloc(vertex_count, sizeof(uint8));
+
+    struct bvri_lod_position_s* sorted = malloc(vertex_count * sizeof(struct bvri_lod_position_s));
+    BVR_ASSERT(simplifier->remap && simplifier->wedges && simplifier->locked && sorted);
+
+    vec3 min, max;
+    vec3_copy(min, vertices);
+    vec3_copy(max, vertices);
+
+    for (uint32 vertex = 0; vertex < vertex_count; vertex++)
+    {
+        sorted[vertex].position = &vertices[vertex * stride];
+        sorted[vertex].vertex = vertex;
+
+        for (uint32 axis = 0; axis < 3; axis++)
+        {
+            min[axis] = fminf(min[axis], vertices[vertex * stride + axis]);
+            max[axis] = fmaxf(max[axis], vertices[vertex * stride + axis]);
+        }
+    }
+
+    qsort(sorted, vertex_count, sizeof(struct bvri_lod_position_s), bvri_lod_compare_positions);
+
+    // link each run of equal positions
+    for (uint32 first = 0, last; first < vertex_count; first = last)
+    {
+        for (last = first + 1; last < vertex_count && 
+            !memcmp(sorted[first].position, sorted[last].position, 3 * sizeof(float)); last++);
+
+        for (uint32 i = first; i < last; i++)
+        {
+            simplifier->remap[sorted[i].vertex] = sorted[first].vertex;
+            simplifier->wedges[sorted[i].vertex] = sorted[i + 1 < last ? i + 1 : first].vertex;
+        }
+    }
+
+    free(sorted);
+
+    vec3 extent;
+    vec3_sub(extent, max, min);
+    simplifier->attribute_weight = BVRI_LOD_ATTRIBUTE_WEIGHT * vec3_len(extent) * 0.5;
+    simplifier->attribute_weight *= simplifier->attribute_weight;
+}
+
+static void bvri_destroy_simplifier(struct bvri_simplifier_s* simplifier){
+    free(simplifier->remap);
+    free(simplifier->wedges);
+    free(simplifier->locked);
+}
+
+/*
+    Returns true if a triangle around `from` has the edge from -> to.
+*/
+static int bvri_lod_has_edge(struct bvri_adjacency_s* adjacency, const uint32* elements, uint32 from, uint32 to){
+    for (uint32 i = 0; i < adjacency->counts[from]; i++)
+    {
+        const uint32* triangle = &elements[adjacency->triangles[adjacency->offsets[from] + i] * 3];
+        for (uint32 corner = 0; corner < 3; corner++)
+        {
+            if(triangle[corner] == from && triangle[(corner + 1) % 3] == to){
+                return 1;
+            }
+        }
+    }
+    
+    return 0;
+}
+
+/*
+    Squared distance between two vertices' attributes.
+*/
+static double bvri_lod_attribute_distance(struct bvri_simplifier_s* simplifier, uint32 a, uint32 b){
+    const float* va = &simplifier->vertices[a * simplifier->stride];
+    const float* vb = &simplifier->vertices[b * simplifier->stride];
+
+    double distance = 0.0;
+    for (uint32 i = 3; i < simplifier->stride; i++)
+    {
+        distance += (double)(va[i] - vb[i]) * (va[i] - vb[i]);
+    }
+    
+    return distance;
+}
+
+/*
+    Get the wedge of `position` with the closest attributes to `vertex`.
+*/
+static uint32 bvri_lod_nearest_wedge(struct bvri_simplifier_s* simplifier, uint32 vertex, uint32 position, double* distance){
+    uint32 nearest = position;
+    *distance = bvri_lod_attribute_distance(simplifier, vertex, position);
+
+    for (uint32 wedge = simplifier->wedges[position]; wedge != position; wedge = simplifier->wedges[wedge])
+    {
+        double wedge_distance = bvri_lod_attribute_distance(simplifier, vertex, wedge);
+        if(wedge_distance < *distance){
+            *distance = wedge_distance;
+            nearest = wedge;
+        }
+    }
+    
+    return nearest;
+}
+
+/*
+    Returns true if moving `source` onto `target` keeps the surface manifold and flips no triangle.
+*/
+static int bvri_lod_can_collapse(struct bvri_simplifier_s* simplifier, struct bvri_adjacency_s* adjacency, 
+    const uint32* elements, uint32 source, uint32 target, uint32* stamps, uint32* stamp){
+    
+    const float* target_position = &simplifier->vertices[target * simplifier->stride];
+    uint32 shared = 0, common = 0;
+
+    // link condition, both vertices must only share the neighbors of their shared triangles
+    (*stamp) += 2;
+    for (uint32 i = 0; i < adjacency->counts[source]; i++)
+    {
+        const uint32* triangle = &elements[adjacency->triangles[adjacency->offsets[source] + i] * 3];
+        shared += triangle[0] == target || triangle[1] == target || triangle[2] == target;
+
+        for (uint32 corner = 0; corner < 3; corner++)
+        {
+            stamps[triangle[corner]] = *stamp;
+        }
+    }
+
+    for (uint32 i = 0; i < adjacency->counts[target]; i++)
+    {
+        const uint32* triangle = &elements[adjacency->triangles[adjacency->offsets[target] + i] * 3];
+        for (uint32 corner = 0; corner < 3; corner++)
+        {
+            if(triangle[corner] != source && triangle[corner] != target && stamps[triangle[corner]] == *stamp){
+                stamps[triangle[corner]] = *stamp + 1;
+                common++;
+            }
+        }
+    }
+
+    if(common > shared){
+        return 0;
+    }
+
+    // triangles moving with the source must keep their orientation
+    for (uint32 i = 0; i < adjacency->counts[source]; i++)
+    {
+        const uint32* triangle = &elements[adjacency->triangles[adjacency->offsets[source] + i] * 3];
+        if(triangle[0] == target || triangle[1] == target || triangle[2] == target){
+            continue;
+        }
+
+        const float* positions[3];
+        const float* moved[3];
+        for (uint32 corner = 0; corner < 3; corner++)
+        {
+            positions[corner] = &simplifier->vertices[triangle[corner] * simplifier->stride];
+            moved[corner] = triangle[corner] == source ? target_position : positions[corner];
+        }
+
+        double before[3], after[3];
+        bvri_lod_triangle_normal(before, positions[0], positions[1], positions[2]);
+        if(bvri_lod_triangle_normal(after, moved[0], moved[1], moved[2]) <= 0.0 || 
+            before[0] * after[0] + before[1] * after[1] + before[2] * after[2] <= 0.0){
+            return 0;
+        }
+    }
+    
+    return 1;
+}
+
+struct bvri_lod_collapse_s {
+    uint32 source;
+    uint32 target;
+    double cost;
+    double error;
+};
+
+static int bvri_lod_compare_collapses(const void* a, const void* b){
+    double ca = ((const struct bvri_lod_collapse_s*)a)->cost;
+    double cb = ((const struct bvri_lod_collapse_s*)b)->cost;
+    return (ca > cb) - (ca < cb);
+}
+
+/*
+    Simplify a triangle list in place by quadric error edge collapses
+    (Garland and Heckbert, "Surface Simplification Using Quadric Error Metrics"),
+    vertices only collapse onto their neighbors so the vertex buffer is kept as is.
+    Each pass collapses the cheapest independent edges, until `target_count` elements remain
+    or nothing can be collapsed. Returns the new element count, `result_error` receives 
+    the largest distance between the simplified surface and the source one.
+*/
+static uint32 bvri_simplify(struct bvri_simplifier_s* simplifier, uint32* elements, uint32 element_count, 
+    uint32 target_count, float* result_error){
+
+    const uint32 vertex_count = simplifier->vertex_count;
+    uint32 triangle_count = element_count / 3;
+
+    uint32* positions = malloc(element_count * sizeof(uint32));
+    uint8* kinds = malloc(vertex_count * sizeof(uint8));
+    uint32* moved = malloc(vertex_count * sizeof(uint32));
+    uint32* best = malloc(vertex_count * sizeof(uint32));
+    uint32* stamps = calloc(vertex_count, sizeof(uint32));
+    struct bvri_quadric_s* quadrics = calloc(vertex_count, sizeof(struct bvri_quadric_s));
+    struct bvri_lod_collapse_s* collapses = malloc(vertex_count * sizeof(struct bvri_lod_collapse_s));
+    BVR_ASSERT(positions && kinds && moved && best && stamps && quadrics && collapses);
+
+    uint32 stamp = 0;
+    double error = 0.0;
+
+    // topology is built on positions, so that attribute seams stay connected
+    for (uint32 i = 0; i < element_count; i++)
+    {
+        positions[i] = simplifier->remap[elements[i]];
+    }
+
+    for (uint32 vertex = 0; vertex < vertex_count; vertex++)
+    {
+        moved[vertex] = vertex;
+    }
+
+    struct bvri_adjacency_s adjacency;
+    bvri_create_adjacency(&adjacency, positions, element_count, vertex_count);
+
+    // vertices with a single open fan are borders, anything more complex is locked
+    for (uint32 vertex = 0; vertex < vertex_count; vertex++)
+    {
+        uint32 open_out = 0, open_in = 0;
+        for (uint32 i = 0; i < adjacency.counts[vertex]; i++)
+        {
+            const uint32* triangle = &positions[adjacency.triangles[adjacency.offsets[vertex] + i] * 3];
+            for (uint32 corner = 0; corner < 3; corner++)
+            {
+                if(triangle[corner] != vertex){
+                    continue;
+                }
+
+                open_out += !bvri_lod_has_edge(&adjacency, positions, triangle[(corner + 1) % 3], vertex);
+                open_in += !bvri_lod_has_edge(&adjacency, positions, vertex, triangle[(corner + 2) % 3]);
+            }
+        }
+
+        if(simplifier->locked[vertex]){
+            kinds[vertex] = BVRI_LOD_VERTEX_LOCKED;
+        }
+        else if(!open_out && !open_in){
+            kinds[vertex] = BVRI_LOD_VERTEX_MANIFOLD;
+        }
+        else if(open_out == 1 && open_in == 1){
+            kinds[vertex] = BVRI_LOD_VERTEX_BORDER;
+        }
+        else {
+            kinds[vertex] = BVRI_LOD_VERTEX_LOCKED;
+        }
+    }
+
+    // accumulate triangles' planes and borders' perpendicular planes
+    for (uint32 triangle = 0; triangle < triangle_count; triangle++)
+    {
+        const uint32* corners = &positions[triangle * 3];
+        const float* p[3];
+        for (uint32 corner = 0; corner < 3; corner++)
+        {
+            p[corner] = &simplifier->vertices[corners[corner] * simplifier->stride];
+        }
+
+        double normal[3];
+        double length = bvri_lod_triangle_normal(normal, p[0], p[1], p[2]);
+        if(length <= 0.0){
+            continue;
+        }
+
+        normal[0] /= length;
+        normal[1] /= length;
+        normal[2] /= length;
+        
+        double distance = -(normal[0] * p[0][0] + normal[1] * p[0][1] + normal[2] * p[0][2]);
+        for (uint32 corner = 0; corner < 3; corner++)
+        {
+            bvri_quadric_add_plane(&quadrics[corners[corner]], normal, distance, length * 0.5);
+        }
+
+        for (uint32 corner = 0; corner < 3; corner++)
+        {
+            uint32 a = corners[corner], b = corners[(corner + 1) % 3];
+            if(bvri_lod_has_edge(&adjacency, positions, b, a)){
+                continue;
+            }
+
+            const float* pa = p[corner];
+            const float* pb = p[(corner + 1) % 3];
+            double edge[3] = {pb[0] - pa[0], pb[1] - pa[1], pb[2] - pa[2]};
+            double border[3] = {
+                edge[1] * normal[2] - edge[2] * normal[1],
+                edge[2] * normal[0] - edge[0] * normal[2],
+                edge[0] * normal[1] - edge[1] * normal[0]
+            };
+
+            double edge_length = sqrt(edge[0] * edge[0] + edge[1] * edge[1] + edge[2] * edge[2]);
+            if(edge_length <= 0.0){
+                continue;
+            }
+
+            border[0] /= edge_length;
+            border[1] /= edge_length;
+            border[2] /= edge_length;
+
+            double border_distance = -(border[0] * pa[0] + border[1] * pa[1] + border[2] * pa[2]);
+            bvri_quadric_add_plane(&quadrics[a], border, border_distance, edge_length * edge_length * BVRI_LOD_BORDER_WEIGHT);
+            bvri_quadric_add_plane(&quadrics[b], border, border_distance, edge_length * edge_length * BVRI_LOD_BORDER_WEIGHT);
+        }
+    }
+
+    while (triangle_count * 3 > target_count)
+    {
+        // find the cheapest collapse of each vertex
+        uint32 collapse_count = 0;
+        memset(best, 0xFF, vertex_count * sizeof(uint32));
+
+        for (uint32 i = 0; i < triangle_count * 3; i++)
+        {
+            uint32 a = positions[i];
+            uint32 b = positions[i - i % 3 + (i + 1) % 3];
+            int open = (kinds[a] == BVRI_LOD_VERTEX_BORDER || kinds[b] == BVRI_LOD_VERTEX_BORDER) && 
+                !bvri_lod_has_edge(&adjacency, positions, b, a);
+
+            for (uint32 direction = 0; direction < 2; direction++)
+            {
+                uint32 source = direction ? b : a;
+                uint32 target = direction ? a : b;
+
+                if(kinds[source] == BVRI_LOD_VERTEX_LOCKED || source == target){
+                    continue;
+                }
+
+                // borders only slide along their border
+                if(kinds[source] == BVRI_LOD_VERTEX_BORDER && (!open || kinds[target] == BVRI_LOD_VERTEX_MANIFOLD)){
+                    continue;
+                }
+
+                struct bvri_quadric_s quadric = quadrics[source];
+                bvri_quadric_add(&quadric, &quadrics[target]);
+                
+                double distance = bvri_quadric_error(&quadric, &simplifier->vertices[target * simplifier->stride]);
+                double cost = distance;
+
+                uint32 wedge = source;
+                do {
+                    double attribute_distance;
+                    bvri_lod_nearest_wedge(simplifier, wedge, target, &attribute_distance);
+                    cost += attribute_distance * simplifier->attribute_weight;
+
+                    wedge = simplifier->wedges[wedge];
+                } while (wedge != source);
+
+                if(best[source] == BVRI_LOD_NONE){
+                    best[source] = collapse_count++;
+                    collapses[best[source]].source = source;
+                }
+                else if(collapses[best[source]].cost <= cost){
+                    continue;
+                }
+
+                collapses[best[source]].target = target;
+                collapses[best[source]].cost = cost;
+                collapses[best[source]].error = distance;
+            }
+        }
+
+        qsort(collapses, collapse_count, sizeof(struct bvri_lod_collapse_s), bvri_lod_compare_collapses);
+
+        // collapse independent edges, vertices around a collapse are locked until the next pass
+        uint32 remaining = triangle_count;
+        uint32 collapsed = 0;
+
+        uint32* locks = best;
+        memset(locks, 0, vertex_count * sizeof(uint32));
+
+        for (uint32 i = 0; i < collapse_count && remaining * 3 > target_count; i++)
+        {
+            uint32 source = collapses[i].source;
+            uint32 target = collapses[i].target;
+
+            if(locks[source] || locks[target] || 
+                !bvri_lod_can_collapse(simplifier, &adjacency, positions, source, target, stamps, &stamp)){
+                continue;
+            }
+
+            uint32 wedge = source;
+            do {
+                double attribute_distance;
+                moved[wedge] = bvri_lod_nearest_wedge(simplifier, wedge, target, &attribute_distance);
+
+                wedge = simplifier->wedges[wedge];
+            } while (wedge != source);
+
+            bvri_quadric_add(&quadrics[target], &quadrics[source]);
+            error = collapses[i].error > error ? collapses[i].error : error;
+
+            for (uint32 t = 0; t < adjacency.counts[source]; t++)
+            {
+                const uint32* triangle = &positions[adjacency.triangles[adjacency.offsets[source] + t] * 3];
+                remaining -= triangle[0] == target || triangle[1] == target || triangle[2] == target;
+
+                locks[triangle[0]] = 1;
+                locks[triangle[1]] = 1;
+                locks[triangle[2]] = 1;
+            }
+
+            collapsed++;
+        }
+
+        if(!collapsed){
+            break;
+        }
+
+        // move collapsed corners and drop degenerated triangles
+        uint32 count = 0;
+        for (uint32 triangle = 0; triangle < triangle_count; triangle++)
+        {
+            uint32 a = moved[elements[triangle * 3 + 0]];
+            uint32 b = moved[elements[triangle * 3 + 1]];
+            uint32 c = moved[elements[triangle * 3 + 2]];
+            uint32 pa = simplifier->remap[a], pb = simplifier->remap[b], pc = simplifier->remap[c];
+
+            if(pa == pb || pb == pc || pa == pc){
+                continue;
+            }
+
+            elements[count * 3 + 0] = a;
+            elements[count * 3 + 1] = b;
+            elements[count * 3 + 2] = c;
+            positions[count * 3 + 0] = pa;
+            positions[count * 3 + 1] = pb;
+            positions[count * 3 + 2] = pc;
+            count++;
+        }
+
+        triangle_count = count;
+
+        bvri_destroy_adjacency(&adjacency);
+        bvri_create_adjacency(&adjacency, positions, triangle_count * 3, vertex_count);
+    }
+
+    bvri_destroy_adjacency(&adjacency);
+
+    free(positions);
+    free(kinds);
+    free(moved);
+    free(best);
+    free(stamps);
+    free(quadrics);
+    free(collapses);
+
+    *result_error = (float)sqrt(error);
+    return triangle_count * 3;
+}
+
+/*
+    Generate mesh's levels of details, each level is simplified from the previous one
+    and its element ranges are appended to `elements`.
+*/
+static void bvri_generate_lods(bvr_mesh_t* mesh, const float* vertices, uint32 stride, uint32 vertex_count, 
+    bvr_mesh_buffer_t* elements, struct bvr_buffer_s* vertex_groups){
+
+    const uint64 group_count = BVR_BUFFER_COUNT((*vertex_groups));
+    if(!group_count || !vertex_count){
+        return;
+    }
+
+    struct bvri_simplifier_s simplifier;
+    bvri_create_simplifier(&simplifier, vertices, stride, vertex_count);
+
+    // vertices shared by several groups are locked, so that groups stay stitched
+    uint32* owners = malloc(vertex_count * sizeof(uint32));
+    BVR_ASSERT(owners);
+    memset(owners, 0xFF, vertex_count * sizeof(uint32));
+
+    uint64 previous_count = 0;
+    for (uint64 group = 0; group < group_count; group++)
+    {
+        bvr_vertex_group_t* vertex_group = &((bvr_vertex_group_t*)vertex_groups->data)[group];
+        const uint32* group_elements = (uint32*)elements->data + vertex_group->element_offset;
+
+        for (uint32 i = 0; i < vertex_group->element_count; i++)
+        {
+            uint32 position = simplifier.remap[group_elements[i]];
+            if(owners[position] == BVRI_LOD_NONE){
+                owners[position] = group;
+            }
+            else if(owners[position] != group){
+                simplifier.locked[position] = 1;
+            }
+        }
+
+        previous_count += vertex_group->element_count;
+    }
+
+    free(owners);
+
+    bvr_vertex_group_t* levels = malloc((BVR_MESH_LOD_COUNT - 1) * group_count * sizeof(bvr_vertex_group_t));
+    BVR_ASSERT(levels);
+
+    bvr_vertex_group_t* previous = (bvr_vertex_group_t*)vertex_groups->data;
+
+    for (uint32 lod = 1; lod < BVR_MESH_LOD_COUNT; lod++)
+    {
+        bvr_vertex_group_t* level = &levels[(lod - 1) * group_count];
+        float level_error = 0.0f;
+        uint64 level_count = 0;
+
+        elements->data = realloc(elements->data, (elements->count + previous_count) * sizeof(uint32));
+        BVR_ASSERT(elements->data);
+
+        for (uint64 group = 0; group < group_count; group++)
+        {
+            uint32* source = (uint32*)elements->data + previous[group].element_offset;
+            uint32* target = (uint32*)elements->data + elements->count + level_count;
+            float group_error;
+
+            memcpy(target, source, previous[group].element_count * sizeof(uint32));
+
+            level[group].element_offset = elements->count + level_count;
+            level[group].base_vertex = previous[group].base_vertex;
+            level[group].element_count = bvri_simplify(&simplifier, target, previous[group].element_count, 
+                previous[group].element_count / 6 * 3, &group_error);
+
+            level_error = group_error > level_error ? group_error : level_error;
+            level_count += level[group].element_count;
+        }
+
+        // stop once the mesh cannot be simplified enough
+        if(level_count * 10 > previous_count * 9){
+            break;
+        }
+
+        uint32* clusters = malloc((level_count / 3 + 1) * sizeof(uint32));
+        BVR_ASSERT(clusters);
+
+        // names are only created for accepted levels, rejected ones are simply dropped
+        for (uint64 group = 0; group < group_count; group++)
+        {
+            bvr_create_string(&level[group].name, NULL);
+            bvri_optimize_vertex_cache((uint32*)elements->data + level[group].element_offset, level[group].element_count, 
+                vertex_count, clusters);
+        }
+
+        free(clusters);
+
+        // errors add up since each level is simplified from the previous one
+        mesh->lod_errors[lod] = mesh->lod_errors[lod - 1] + level_error;
+        mesh->lod_count++;
+
+        elements->count += level_count;
+        previous = level;
+        previous_count = level_count;
+    }
+
+    bvri_destroy_simplifier(&simplifier);
+
+    if(mesh->lod_count > 1){
+        mesh->lod_groups.data = levels;
+        mesh->lod_groups.size = (mesh->lod_count - 1) * group_count * sizeof(bvr_vertex_group_t);
+    }
+    else {
+        free(levels);
+    }
+}
+
+#endif
+
+#endif
+
+/*
+    Get the number of floats used by each attribute of a layout before quantization.
+*/
+static void bvri_get_float_layout(bvr_mesh_array_attrib_t attrib, uint32* position_count, uint32* uv_count, uint32* normal_count){
+    *position_count = (attrib == BVR_MESH_ATTRIB_V2 || attrib == BVR_MESH_ATTRIB_V2UV2) ? 2 : 3;
+    *uv_count = (attrib == BVR_MESH_ATTRIB_V2 || attrib == BVR_MESH_ATTRIB_V3 || attrib == BVR_MESH_ATTRIB_V3_QUANTIZED) ? 0 : 2;
+    *normal_count = (attrib == BVR_MESH_ATTRIB_V3UV2N3 || attrib == BVR_MESH_ATTRIB_V3UV2N3_QUANTIZED) ? 3 : 0;
+}
+
+/*
+    Get the size of a vertex in a layout, as set by its attribute pointers.
+*/
+static uint32 bvri_get_vertex_stride(bvr_mesh_array_attrib_t attrib, int vertex_type){
+    uint32 position_count, uv_count, normal_count;
+    bvri_get_float_layout(attrib, &position_count, &uv_count, &normal_count);
+
+    if(attrib >= BVR_MESH_ATTRIB_V3_QUANTIZED){
+        return (4 + (uv_count ? 2 : 0) + (normal_count ? 2 : 0)) * sizeof(int16);
+    }
+
+    return (position_count + uv_count + normal_count) * bvr_sizeof(vertex_type);
+}
+
+/*
+    Convert a float in [-1, 1] to a signed normalized 16 bits integer.
+*/
+static int16 bvri_quantize_snorm16(float v){
+    v = clamp(v, -1.0f, 1.0f);
+    return (int16)(v * 32767.0f + (v < 0.0f ? -0.5f : 0.5f));
+}
+
+/*
+    Convert a float in [0, 1] to an unsigned normalized 16 bits integer.
+*/
+static uint16 bvri_quantize_unorm16(float v){
+    v = clamp(v, 0.0f, 1.0f);
+    return (uint16)(v * 65535.0f + 0.5f);
+}
+
+/*
+    Octahedral encoding of a unit normal, projected on the octahedron 
+    and its lower half folded over the upper one.
+*/
+static void bvri_quantize_octahedral(int16* result, const float* normal){
+    float length = fabsf(normal[0]) + fabsf(normal[1]) + fabsf(normal[2]);
+    float x = 0.0f, y = 0.0f;
+
+    if(length > 0.0f){
+        x = normal[0] / length;
+        y = normal[1] / length;
+
+        if(normal[2] < 0.0f){
+            float fx = (1.0f - fabsf(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+            float fy = (1.0f - fabsf(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+            x = fx;
+            y = fy;
+        }
+    }
+
+    result[0] = bvri_quantize_snorm16(x);
+    result[1] = bvri_quantize_snorm16(y);
+}
+
+/*
+    Quantize float vertices (vec3 position, then `uv_count` and `normal_count` floats)
+    to mesh's quantized layout, in place since quantized vertices are always smaller.
+    Positions are stored relative to their bounds, mesh's dequantization is updated.
+    Returns the size of the quantized vertices.
+*/
+static uint64 bvri_quantize_vertices(bvr_mesh_t* mesh, void* vertices, uint32 vertex_count, 
+    uint32 uv_count, uint32 normal_count){
+
+    const uint32 stride = 3 + uv_count + normal_count;
+    const uint32 quantized_stride = 4 + (uv_count ? 2 : 0) + (normal_count ? 2 : 0);
+
+    float* source = (float*)vertices;
+    int16* target = (int16*)vertices;
+
+    vec3 min = {0.0f, 0.0f, 0.0f};
+    vec3 max = {0.0f, 0.0f, 0.0f};
+    if(vertex_count){
+        vec3_copy(min, source);
+        vec3_copy(max, source);
+    }
+
+    for (uint64 i = 1; i < vertex_count; i++)
+    {
+        for (uint32 axis = 0; axis < 3; axis++)
+        {
+            min[axis] = fminf(min[axis], source[i * stride + axis]);
+            max[axis] = fmaxf(max[axis], source[i * stride + axis]);
+        }
+    }
+    
+    for (uint32 axis = 0; axis < 3; axis++)
+    {
+        mesh->position_offset[axis] = (min[axis] + max[axis]) * 0.5f;
+        mesh->position_scale[axis] = (max[axis] - min[axis]) * 0.5f;
+    }
+
+    int clamped_uvs = 0;
+    for (uint64 i = 0; i < vertex_count; i++)
+    {
+        // quantized vertices overlap the vertex they're made from
+        float vertex[8];
+        memcpy(vertex, &source[i * stride], stride * sizeof(float));
+
+        int16* quantized = &target[i * quantized_stride];
+        for (uint32 axis = 0; axis < 3; axis++)
+        {
+            quantized[axis] = mesh->position_scale[axis] > 0.0f ? 
+                bvri_quantize_snorm16((vertex[axis] - mesh->position_offset[axis]) / mesh->position_scale[axis]) : 0;
+        }
+
+        quantized[3] = 32767;
+        quantized += 4;
+        
+        if(uv_count){
+            clamped_uvs |= vertex[3] < 0.0f || vertex[3] > 1.0f || vertex[4] < 0.0f || vertex[4] > 1.0f;
+
+            ((uint16*)quantized)[0] = bvri_quantize_unorm16(vertex[3]);
+            ((uint16*)quantized)[1] = bvri_quantize_unorm16(vertex[4]);
+            quantized += 2;
+        }
+        if(normal_count){
+            bvri_quantize_octahedral(quantized, &vertex[3 + uv_count]);
+        }
+    }
+
+    if(clamped_uvs){
+        BVR_PRINT("quantized uvs are clamped between 0 and 1!");
+    }
+
+    // a flat axis keeps a unit scale
+    for (uint32 axis = 0; axis < 3; axis++)
+    {
+        if(mesh->position_scale[axis] <= 0.0f){
+            mesh->position_scale[axis] = 1.0f;
+        }
+    }
+
+    return (uint64)vertex_count * quantized_stride * sizeof(int16);
+}
+
+#ifndef BVR_NO_OBJ
+
+#include <ctype.h>
+
+#define BVRI_OBJ_SIGNATURE_SIZE 512
+
+/*
+    Minimal size of a chunk parsed on its own thread.
+*/
+#define BVRI_OBJ_CHUNK_SIZE (4 << 20)
+#define BVRI_OBJ_MAX_THREADS 8
+
+/*
+    Growable array used to store OBJ's attributes.
+*/
+struct bvri_objarray_s {
+    char* data;
+    uint64 count;
+    uint64 capacity;
+    uint32 elemsize;
+};
+
+static void bvri_objcreatearray(struct bvri_objarray_s* array, uint32 elemsize){
+    array->data = NULL;
+    array->count = 0;
+    array->capacity = 0;
+    array->elemsize = elemsize;
+}
+
+/*
+    Return a pointer to a new element at the end of the array.
+*/
+static void* bvri_objarraypush(struct bvri_objarray_s* array){
+    if(array->count >= array->capacity){
+        array->capacity = array->capacity ? array->capacity * 2 : 256;
+        array->data = realloc(array->data, array->capacity * array->elemsize);
+        BVR_ASSERT(array->data);
+    }
+
+    return array->data + (array->count++) * array->elemsize;
+}
+
+static void bvri_objdestroyarray(struct bvri_objarray_s* array){
+    free(array->data);
+    array->data = NULL;
+    array->count = 0;
+    array->capacity = 0;
+}
+
+/*
+    Skip spaces and tabs.
+*/
+static char* bvri_objskip(char* buffer){
+    while (*buffer == ' ' || *buffer == '\t')
+    {
+        buffer++;
+    }
+    return buffer;
+}
+
+static char* bvri_objparseint(char* buffer, int* v){
+    int sig = + 1;
+    int num = 0;
+
+    if(*buffer == '-'){
+        sig = -1;
+        buffer++;
+    }
+
+    while (isdigit(*buffer))
+    {
+        num = 10 * num + (*buffer++ - '0');
+    }
+    
+    *v = sig * num;
+
+    return buffer;
+}
+
+/*
+    Powers of ten exactly representable as floats.
+*/
+static const float bvri_objpow10[] = {
+    1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f
+};
+
+/*
+    Parse a decimal float, with an optional exponent.
+    Mantissas up to 2^24 scaled by at most 10^10 are rounded once from exact floats, 
+    everything else falls back on strtof.
+*/
+static char* bvri_objparsefloat(char* buffer, float* v){
+    char* start = buffer;
+    int negative = 0;
+
+    if(*buffer == '-'){
+        negative = 1;
+        buffer++;
+    }
+    else if(*buffer == '+'){
+        buffer++;
+    }
+
+    uint64 mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    int found = 0;
+
+    while (isdigit(*buffer))
+    {
+        if(digits < 19){
+            mantissa = 10 * mantissa + (*buffer - '0');
+            digits += mantissa != 0;
+        }
+        else {
+            exponent++;
+        }
+        
+        buffer++;
+        found = 1;
+    }
+    
+    if(*buffer == '.'){
+        buffer++;
+
+        while (isdigit(*buffer))
+        {
+            if(digits < 19){
+                mantissa = 10 * mantissa + (*buffer - '0');
+                digits += mantissa != 0;
+                exponent--;
+            }
+            
+            buffer++;
+            found = 1;
+        }
+    }
+
+    // 'nan', 'inf' and other oddities
+    if(!found){
+        *v = strtof(start, &buffer);
+        return buffer;
+    }
+
+    if(*buffer == 'e' || *buffer == 'E'){
+        int exponent_sign = 1;
+        int value = 0;
+        char* cursor = buffer + 1;
+
+        if(*cursor == '-'){
+            exponent_sign = -1;
+            cursor++;
+        }
+        else if(*cursor == '+'){
+            cursor++;
+        }
+
+        if(isdigit(*cursor)){
+            while (isdigit(*cursor))
+            {
+                if(value < 10000){
+                    value = 10 * value + (*cursor - '0');
+                }
+                cursor++;
+            }
+            
+            exponent += exponent_sign * value;
+            buffer = cursor;
+        }
+    }
+
+    // both operands are exact floats, so a single multiply or divide rounds correctly
+    if(mantissa <= (1 << 24) && exponent >= -10 && exponent <= 10){
+        float value = (float)mantissa;
+        if(exponent < 0){
+            value /= bvri_objpow10[-exponent];
+        }
+        else {
+            value *= bvri_objpow10[exponent];
+        }
+        
+        *v = negative ? -value : value;
+        return buffer;
+    }
+
+    *v = strtof(start, NULL);
+    return buffer;
+}
+
+
+/*
+    Return the next line and terminate the current one.
+*/
+static char* bvri_objnextline(char* line, char* end){
+    char* next = memchr(line, '\n', end - line);
+    if(!next){
+        next = end;
+    }
+
+    *next = '\0';
+    if(next > line && next[-1] == '\r'){
+        next[-1] = '\0';
+    }
+
+    return next + (next < end);
+}
+
+static int bvri_is_obj(FILE* file){
+    fseek(file, 0, SEEK_SET);
+
+    char sig[BVRI_OBJ_SIGNATURE_SIZE + 1];
+    uint64 size = fread(sig, sizeof(char), BVRI_OBJ_SIGNATURE_SIZE, file);
+    sig[size] = '\0';
+
+    // check 5 first lines
+    char* line = sig;
+    for (uint64 i = 0; i < 5 && line < sig + size; i++)
+    {
+        char* next = bvri_objnextline(line, sig + size);
+
+        if(!strncmp(line, "mtllib ", 7)){
+            return BVR_OK;
+        }
+
+        if((line[0] == 'o' || line[0] == 'v') && line[1] == ' '){
+            return BVR_OK;
+        }
+
+        line = next;
+    }
+    
+    return BVR_FAILED;
+}
+
+/*
+    Push back a new vertex group as the targetted group
+*/
+static bvr_vertex_group_t* bvri_objpushgrp(struct bvr_buffer_s* group, bvr_string_t* name){
+    bvr_vertex_group_t* vertex_group;
+
+    if(group->data){
+        group->data = realloc(group->data, group->size + group->elemsize);
+        BVR_ASSERT(group->data);
+
+        vertex_group = (bvr_vertex_group_t*)((char*)group->data + group->size);
+        group->size += group->elemsize;
+    }
+    else {
+        group->data = malloc(group->elemsize);
+        group->size += group->elemsize;
+
+        vertex_group = (bvr_vertex_group_t*)group->data;
+    }
+
+    if(name->string){
+        bvr_string_create_and_copy(&vertex_group->name, name);
+    }
+    else {
+        bvr_create_string(&vertex_group->name, NULL);
+    }
+
+    vertex_group->element_count = 0;
+    vertex_group->base_vertex = 0;
+    return vertex_group;
+}
+
+/*
+    Convert an OBJ index (starting at 1, or negative relative to the end) into an array index.
+    Returns -1 if the index is missing or out of bounds.
+*/
+static int bvri_objindex(int index, uint64 count){
+    if(index > 0 && (uint64)index <= count){
+        return index - 1;
+    }
+    if(index < 0 && (uint64)(-index) <= count){
+        return (int)count + index;
+    }
+    return -1;
+}
+
+/*
+    Parse a face's vertex, formatted as 'v', 'v/vt', 'v//vn' or 'v/vt/vn'
+*/
+static char* bvri_objparseface(char* buffer, int* vertex, int* uv, int* normal){
+    *uv = 0;
+    *normal = 0;
+
+    buffer = bvri_objparseint(buffer, vertex);
+    if(*buffer == '/'){
+        buffer = bvri_objparseint(++buffer, uv);
+
+        if(*buffer == '/'){
+            buffer = bvri_objparseint(++buffer, normal);
+        }
+    }
+
+    return buffer;
+}
+
+/*
+    Parse `count` floats separated by spaces.
+*/
+static char* bvri_objparsefloats(char* buffer, float* values, uint32 count){
+    for (uint32 i = 0; i < count; i++)
+    {
+        buffer = bvri_objparsefloat(bvri_objskip(buffer), &values[i]);
+    }
+    return buffer;
+}
+
+struct bvri_objcorner_s {
+    int vertex;
+    int uv;
+    int normal;
+};
+
+struct bvri_objface_s {
+    uint32 corner;
+    uint32 edges;
+
+    /*
+        Attributes count when the face was read, 
+        used to resolve relative indices.
+    */
+    uint32 vertex_count;
+    uint32 uv_count;
+    uint32 normal_count;
+};
+
+struct bvri_objgroup_s {
+    bvr_string_t name;
+    uint32 face;
+};
+
+/*
+    Part of an OBJ file, parsed on its own thread.
+*/
+struct bvri_objchunk_s {
+    char* begin;
+    char* end;
+
+    int parse_uvs;
+    int parse_normals;
+
+    struct bvri_objarray_s vertex;  /* vec3 */
+    struct bvri_objarray_s uvs;     /* vec2 */
+    struct bvri_objarray_s normals; /* vec3 */
+    struct bvri_objarray_s corners; /* struct bvri_objcorner_s */
+    struct bvri_objarray_s faces;   /* struct bvri_objface_s */
+    struct bvri_objarray_s groups;  /* struct bvri_objgroup_s */
+
+    uint64 element_count;
+    
+    bvr_string_t material;
+};
+
+static void bvri_objcreatechunk(struct bvri_objchunk_s* chunk, char* begin, char* end){
+    chunk->begin = begin;
+    chunk->end = end;
+    chunk->element_count = 0;
+
+    bvri_objcreatearray(&chunk->vertex, sizeof(vec3));
+    bvri_objcreatearray(&chunk->uvs, sizeof(vec2));
+    bvri_objcreatearray(&chunk->normals, sizeof(vec3));
+    bvri_objcreatearray(&chunk->corners, sizeof(struct bvri_objcorner_s));
+    bvri_objcreatearray(&chunk->faces, sizeof(struct bvri_objface_s));
+    bvri_objcreatearray(&chunk->groups, sizeof(struct bvri_objgroup_s));
+    bvr_create_string(&chunk->material, NULL);
+}
+
+static void bvri_objdestroychunk(struct bvri_objchunk_s* chunk){
+    for (uint64 i = 0; i < chunk->groups.count; i++)
+    {
+        bvr_destroy_string(&((struct bvri_objgroup_s*)chunk->groups.data)[i].name);
+    }
+    
+    bvri_objdestroyarray(&chunk->vertex);
+    bvri_objdestroyarray(&chunk->uvs);
+    bvri_objdestroyarray(&chunk->normals);
+    bvri_objdestroyarray(&chunk->corners);
+    bvri_objdestroyarray(&chunk->faces);
+    bvri_objdestroyarray(&chunk->groups);
+    bvr_destroy_string(&chunk->material);
+}
+
+/*
+    Parse every line of a chunk.
+    Indices are kept as written and resolved when chunks are merged.
+*/
+static int bvri_objparsechunk(void* data){
+    struct bvri_objchunk_s* chunk = (struct bvri_objchunk_s*)data;
+
+    char* line = chunk->begin;
+    while(line < chunk->end){
+        char* next = bvri_objnextline(line, chunk->end);
+
+        switch (line[0])
+        {
+        case '#':
+            /* skip */
+            break;
+        
+        case 'm':
+            if(!strncmp(line, "mtllib ", 7)){
+                bvr_destroy_string(&chunk->material);
+                bvr_create_string(&chunk->material, bvri_objskip(&line[7]));
+            }
+            break;    
+
+        case 'o':
+            {
+                struct bvri_objgroup_s* group = bvri_objarraypush(&chunk->groups);
+                bvr_create_string(&group->name, bvri_objskip(&line[1]));
+                group->face = chunk->faces.count;
+            }
+            break;
+
+        case 'v':
+            {
+                if(line[1] == 'n' && chunk->parse_normals){
+                    bvri_objparsefloats(&line[2], (float*)bvri_objarraypush(&chunk->normals), 3);
+                }
+                else if(line[1] == 't' && chunk->parse_uvs){
+                    bvri_objparsefloats(&line[2], (float*)bvri_objarraypush(&chunk->uvs), 2);
+                }
+                else if(line[1] == ' ' || line[1] == '\t'){
+                    bvri_objparsefloats(&line[1], (float*)bvri_objarraypush(&chunk->vertex), 3);
+                }
+            }   
+            break;
+        
+        case 'f': 
+            {
+                struct bvri_objface_s* face = bvri_objarraypush(&chunk->faces);
+                face->corner = chunk->corners.count;
+                face->edges = 0;
+                face->vertex_count = chunk->vertex.count;
+                face->uv_count = chunk->uvs.count;
+                face->normal_count = chunk->normals.count;
+
+                char* cursor = bvri_objskip(&line[1]);
+                int malformed = 0;
+                while (*cursor != '\0')
+                {
+                    struct bvri_objcorner_s* corner = bvri_objarraypush(&chunk->corners);
+                    char* start = cursor;
+                    cursor = bvri_objskip(bvri_objparseface(cursor, &corner->vertex, &corner->uv, &corner->normal));
+
+                    face->edges++;
+
+                    // corner is not a number, the cursor would never move
+                    if(cursor == start){
+                        malformed = 1;
+                        break;
+                    }
+                }
+
+                if(malformed){
+                    BVR_PRINT("skipping malformed face!");
+                    chunk->corners.count -= face->edges;
+                    chunk->faces.count--;
+                    break;
+                }
+
+                if(face->edges < 3){
+                    BVR_PRINT("skipping degenerated face!");
+                    chunk->corners.count -= face->edges;
+                    chunk->faces.count--;
+                    break;
+                }
+                
+                chunk->element_count += (face->edges - 2) * 3;
+            }
+            break;
+
+        default:
+            break;
+        }
+
+        line = next;
+    }
+
+    return BVR_OK;
+}
+
+/*
+    Append `count` elements at the end of the array.
+*/
+static void* bvri_objarrayappend(struct bvri_objarray_s* array, const void* data, uint64 count){
+    if(array->count + count > array->capacity){
+        array->capacity = array->count + count;
+        array->data = realloc(array->data, array->capacity * array->elemsize);
+        BVR_ASSERT(array->data);
+    }
+
+    char* target = array->data + array->count * array->elemsize;
+    memcpy(target, data, count * array->elemsize);
+    array->count += count;
+    return target;
+}
+
+/*
+    Move `source`'s elements at the end of `dest`.
+*/
+static void bvri_objarraymerge(struct bvri_objarray_s* dest, struct bvri_objarray_s* source){
+    // steal source's storage if there is nothing to keep
+    if(!dest->count){
+        struct bvri_objarray_s empty = *dest;
+        *dest = *source;
+        *source = empty;
+        return;
+    }
+
+    bvri_objarrayappend(dest, source->data, source->count);
+}
+
+/*
+    Resolve faces' indices from `first_face`, once their attributes are stored in `object`.
+*/
+static void bvri_objresolve(struct bvri_objchunk_s* object, uint32 first_face, 
+    uint32 corner_base, uint32 vertex_base, uint32 uv_base, uint32 normal_base){
+
+    for (uint32 i = first_face; i < object->faces.count; i++)
+    {
+        struct bvri_objface_s* face = &((struct bvri_objface_s*)object->faces.data)[i];
+        
+        face->corner += corner_base;
+        face->vertex_count += vertex_base;
+        face->uv_count += uv_base;
+        face->normal_count += normal_base;
+
+        struct bvri_objcorner_s* corners = &((struct bvri_objcorner_s*)object->corners.data)[face->corner];
+        for (uint32 corner = 0; corner < face->edges; corner++)
+        {
+            corners[corner].vertex = bvri_objindex(corners[corner].vertex, face->vertex_count);
+            corners[corner].uv = bvri_objindex(corners[corner].uv, face->uv_count);
+            corners[corner].normal = bvri_objindex(corners[corner].normal, face->normal_count);
+        }
+    }
+}
+
+/*
+    Append a chunk to `object`, chunks must be merged in file's order.
+*/
+static void bvri_objmergechunk(struct bvri_objchunk_s* object, struct bvri_objchunk_s* chunk){
+    uint32 vertex_base = object->vertex.count;
+    uint32 uv_base = object->uvs.count;
+    uint32 normal_base = object->normals.count;
+    uint32 corner_base = object->corners.count;
+    uint32 face_base = object->faces.count;
+
+    bvri_objarraymerge(&object->vertex, &chunk->vertex);
+    bvri_objarraymerge(&object->uvs, &chunk->uvs);
+    bvri_objarraymerge(&object->normals, &chunk->normals);
+    bvri_objarraymerge(&object->corners, &chunk->corners);
+    bvri_objarraymerge(&object->faces, &chunk->faces);
+
+    // indices are resolved against the attributes read before each face
+    bvri_objresolve(object, face_base, corner_base, vertex_base, uv_base, normal_base);
+
+    // groups' names are moved to the object
+    struct bvri_objgroup_s* groups = bvri_objarrayappend(&object->groups, chunk->groups.data, chunk->groups.count);
+    for (uint64 i = 0; i < chunk->groups.count; i++)
+    {
+        groups[i].face += face_base;
+    }
+    chunk->groups.count = 0;
+
+    if(chunk->material.string){
+        bvr_destroy_string(&object->material);
+        object->material = chunk->material;
+        chunk->material.string = NULL;
+        chunk->material.length = 0;
+    }
+
+    object->element_count += chunk->element_count;
+}
+
+/*
+    Split the file at line boundaries and parse each part on its own thread.
+*/
+static void bvri_objparse(struct bvri_objchunk_s* object, char* data, uint64 size){
+    uint32 chunk_count = size / BVRI_OBJ_CHUNK_SIZE;
+    if(chunk_count > (uint32)SDL_GetNumLogicalCPUCores()){
+        chunk_count = SDL_GetNumLogicalCPUCores();
+    }
+    if(chunk_count > BVRI_OBJ_MAX_THREADS){
+        chunk_count = BVRI_OBJ_MAX_THREADS;
+    }
+
+    if(chunk_count <= 1){
+        object->begin = data;
+        object->end = data + size;
+        bvri_objparsechunk(object);
+        bvri_objresolve(object, 0, 0, 0, 0, 0);
+        return;
+    }
+
+    struct bvri_objchunk_s chunks[BVRI_OBJ_MAX_THREADS];
+    SDL_Thread* threads[BVRI_OBJ_MAX_THREADS];
+
+    char* begin = data;
+    for (uint32 i = 0; i < chunk_count; i++)
+    {
+        char* end = data + size;
+        if(i + 1 < chunk_count){
+            end = data + size * (i + 1) / chunk_count;
+
+            // move the end right after the next line
+            char* line = memchr(end, '\n', data + size - end);
+            end = line ? line + 1 : data + size;
+        }
+
+        bvri_objcreatechunk(&chunks[i], begin, end);
+        chunks[i].parse_uvs = object->parse_uvs;
+        chunks[i].parse_normals = object->parse_normals;
+        
+        // the last chunk is parsed by this thread
+        threads[i] = NULL;
+        if(i + 1 < chunk_count){
+            threads[i] = SDL_CreateThread(bvri_objparsechunk, "bvr_obj_parser", &chunks[i]);
+        }
+        if(!threads[i]){
+            bvri_objparsechunk(&chunks[i]);
+        }
+
+        begin = end;
+    }
+
+    for (uint32 i = 0; i < chunk_count; i++)
+    {
+        if(threads[i]){
+            SDL_WaitThread(threads[i], NULL);
+        }
+
+        bvri_objmergechunk(object, &chunks[i]);
+        bvri_objdestroychunk(&chunks[i]);
+    }
+}
+
+#define BVRI_OBJ_MAP_EMPTY 0xFFFFFFFF
+
+/*
+    Open addressing hash map from a face's corner to its vertex index.
+*/
+struct bvri_objmap_s {
+    struct bvri_objmapentry_s {
+        struct bvri_objcorner_s key;
+        uint32 index;
+    }* entries;
+
+    uint64 mask;
+};
+
+static void bvri_objcreatemap(struct bvri_objmap_s* map, uint64 count){
+    uint64 capacity = 16;
+    while (capacity < count * 2)
+    {
+        capacity <<= 1;
+    }
+
+    map->mask = capacity - 1;
+    map->entries = malloc(capacity * sizeof(struct bvri_objmapentry_s));
+    BVR_ASSERT(map->entries);
+
+    for (uint64 i = 0; i < capacity; i++)
+    {
+        map->entries[i].index = BVRI_OBJ_MAP_EMPTY;
+    }
+}
+
+/*
+    Return a pointer to the key's vertex index.
+    If the key is new, it is inserted and its index is BVRI_OBJ_MAP_EMPTY.
+*/
+static uint32* bvri_objmapfind(struct bvri_objmap_s* map, struct bvri_objcorner_s* key){
+    uint64 hash = (uint32)key->vertex * 0x9E3779B1u;
+    hash ^= (uint32)key->uv * 0x85EBCA77u;
+    hash ^= (uint32)key->normal * 0xC2B2AE3Du;
+    hash ^= hash >> 15;
+
+    for (uint64 slot = hash & map->mask;; slot = (slot + 1) & map->mask)
+    {
+        struct bvri_objmapentry_s* entry = &map->entries[slot];
+
+        if(entry->index == BVRI_OBJ_MAP_EMPTY){
+            entry->key = *key;
+            return &entry->index;
+        }
+
+        if(entry->key.vertex == key->vertex && entry->key.uv == key->uv && entry->key.normal == key->normal){
+            return &entry->index;
+        }
+    }
+}
+
+static void bvri_objdestroymap(struct bvri_objmap_s* map){
+    free(map->entries);
+    map->entries = NULL;
+}
+
+static uint32 bvri_earcut(const float* vertices, uint32 vertex_count, uint32 stride, 
+    const uint32* holes, uint32 hole_count, uint32** triangles);
+
+/*
+    Scratch memory used to triangulate faces.
+*/
+struct bvri_objtriangulation_s {
+    struct bvri_objarray_s points;      /* vec2 */
+    struct bvri_objarray_s triangles;   /* uint32 */
+};
+
+static void bvri_objcreatetriangulation(struct bvri_objtriangulation_s* triangulation){
+    bvri_objcreatearray(&triangulation->points, sizeof(vec2));
+    bvri_objcreatearray(&triangulation->triangles, sizeof(uint32));
+}
+
+static void bvri_objdestroytriangulation(struct bvri_objtriangulation_s* triangulation){
+    bvri_objdestroyarray(&triangulation->points);
+    bvri_objdestroyarray(&triangulation->triangles);
+}
+
+static void bvri_objpushtriangle(struct bvri_objarray_s* triangles, uint32 a, uint32 b, uint32 c){
+    *(uint32*)bvri_objarraypush(triangles) = a;
+    *(uint32*)bvri_objarraypush(triangles) = b;
+    *(uint32*)bvri_objarraypush(triangles) = c;
+}
+
+static float bvri_objcross(const float* a, const float* b, const float* c){
+    return (b[0] - a[0]) * (c[1] - a[1]) - (b[1] - a[1]) * (c[0] - a[0]);
+}
+
+/*
+    Split a face into at most (edges - 2) triangles, stored in `triangulation->triangles` 
+    as indices into the face's corners. Returns the number of indices.
+    Convex faces are split as a fan, other faces are projected on their plane and cut by bvri_earcut, 
+    which drops degenerated parts.
+*/
+static uint32 bvri_objtriangulate(struct bvri_objtriangulation_s* triangulation, 
+    const float* positions, const struct bvri_objcorner_s* corners, uint32 edges){
+
+    triangulation->points.count = 0;
+    triangulation->triangles.count = 0;
+
+    // compute face normal with Newell's method, to project the face on its dominant plane
+    vec3 normal = {0.0f, 0.0f, 0.0f};
+    int has_positions = edges > 3;
+    for (uint32 corner = 0; corner < edges && has_positions; corner++)
+    {
+        if(corners[corner].vertex < 0 || corners[(corner + 1) % edges].vertex < 0){
+            has_positions = 0;
+            break;
+        }
+
+        const float* a = positions + corners[corner].vertex * 3;
+        const float* b = positions + corners[(corner + 1) % edges].vertex * 3;
+
+        normal[0] += (a[1] - b[1]) * (a[2] + b[2]);
+        normal[1] += (a[2] - b[2]) * (a[0] + b[0]);
+        normal[2] += (a[0] - b[0]) * (a[1] + b[1]);
+    }
+
+    int convex = 1;
+    if(has_positions){
+        // drop the dominant axis, flip the projection so that the face is counter-clockwise 
+        int axis = 2;
+        if(fabsf(normal[0]) > fabsf(normal[1]) && fabsf(normal[0]) > fabsf(normal[2])) axis = 0;
+        else if(fabsf(normal[1]) > fabsf(normal[2])) axis = 1;
+
+        int u = (axis + 1) % 3;
+        int v = (axis + 2) % 3;
+        float sign = normal[axis] < 0.0f ? -1.0f : 1.0f;
+
+        for (uint32 corner = 0; corner < edges; corner++)
+        {
+            const float* position = positions + corners[corner].vertex * 3;
+            float* point = (float*)bvri_objarraypush(&triangulation->points);
+            point[0] = position[u];
+            point[1] = position[v] * sign;
+        }
+
+        vec2* points = (vec2*)triangulation->points.data;
+        for (uint32 corner = 0; corner < edges && convex; corner++)
+        {
+            convex = bvri_objcross(points[corner], points[(corner + 1) % edges], points[(corner + 2) % edges]) >= 0.0f;
+        }
+    }
+
+    if(convex){
+        for (uint32 corner = 2; corner < edges; corner++)
+        {
+            bvri_objpushtriangle(&triangulation->triangles, 0, corner - 1, corner);
+        }
+
+        return triangulation->triangles.count;
+    }
+
+    uint32* triangles = NULL;
+    uint32 count = bvri_earcut((float*)triangulation->points.data, edges, 2, NULL, 0, &triangles);
+
+    if(count){
+        bvri_objarrayappend(&triangulation->triangles, triangles, count);
+    }
+
+    free(triangles);
+    return count;
+}
+
+/*
+    Copy `count` floats of the `index`th element of `source`, or zeros if the index is missing.
+*/
+static float* bvri_objcopyattrib(float* target, const float* source, int index, uint32 source_stride, uint32 count){
+    if(index >= 0){
+        memcpy(target, source + index * source_stride, count * sizeof(float));
+    }
+    else {
+        memset(target, 0, count * sizeof(float));
+    }
+    return target + count;
+}
+
+static int bvri_load_obj(bvr_mesh_t* mesh, FILE* file){
+    BVR_ASSERT(mesh);
+
+    struct bvri_objchunk_s object;
+    struct bvr_buffer_s vertex_groups;
+    bvr_mesh_buffer_t vertices;
+    bvr_mesh_buffer_t elements;
+
+    vertex_groups.data = NULL;
+    vertex_groups.elemsize = sizeof(bvr_vertex_group_t);
+    vertex_groups.size = 0;
+
+    elements.data = NULL;
+    vertices.data = NULL;
+    elements.count = 0;
+    vertices.count = 0;
+    elements.type = BVR_UNSIGNED_INT32;
+    vertices.type = BVR_FLOAT;
+
+    // vertex layout, in floats
+    uint32 position_count, uv_count, normal_count;
+    bvri_get_float_layout(mesh->attrib, &position_count, &uv_count, &normal_count);
+    
+    const uint32 stride = position_count + uv_count + normal_count;
+
+    // read the whole file at once, lines are then tokenized in place
+    fseek(file, 0, SEEK_SET);
+
+    uint64 size = bvr_get_file_size(file);
+    char* data = malloc(size + 1);
+    BVR_ASSERT(data);
+
+    size = fread(data, sizeof(char), size, file);
+    data[size] = '\0';
+
+    bvri_objcreatechunk(&object, data, data + size);
+    object.parse_uvs = uv_count != 0;
+    object.parse_normals = normal_count != 0;
+
+    bvri_objparse(&object, data, size);
+
+    free(data);
+
+    elements.count = object.element_count;
+    if(!elements.count){
+        BVR_PRINT("failed to load mesh :(");
+        goto bvr_objfailed;
+    }
+
+    // build the whole vertex and element arrays before uploading them at once,
+    // corners sharing the same attributes are merged into a single vertex
+    vertices.data = malloc(object.corners.count * stride * sizeof(float));
+    elements.data = malloc(elements.count * sizeof(uint32));
+    BVR_ASSERT(vertices.data && elements.data);
+
+    struct bvri_objmap_s map;
+    bvri_objcreatemap(&map, object.corners.count);
+
+    struct bvri_objtriangulation_s triangulation;
+    bvri_objcreatetriangulation(&triangulation);
+
+    struct bvri_objarray_s face_indices;
+    bvri_objcreatearray(&face_indices, sizeof(uint32));
+
+    float* vertex = (float*)vertices.data;
+    uint32* element = (uint32*)elements.data;
+    uint32 vertex_count = 0;
+
+    struct bvri_objgroup_s* groups = (struct bvri_objgroup_s*)object.groups.data;
+    uint64 group = 0;
+    bvr_vertex_group_t* vertex_group = NULL;
+
+    for (uint64 i = 0; i <= object.faces.count; i++)
+    {
+        // open the groups starting at this face
+        while (group < object.groups.count && groups[group].face == i)
+        {
+            vertex_group = bvri_objpushgrp(&vertex_groups, &groups[group].name);
+            vertex_group->element_offset = element - (uint32*)elements.data;
+            group++;
+        }
+
+        if(i == object.faces.count){
+            break;
+        }
+
+        // faces declared before any object
+        if(!vertex_group){
+            bvr_string_t name;
+            bvr_create_string(&name, NULL);
+
+            vertex_group = bvri_objpushgrp(&vertex_groups, &name);
+            vertex_group->element_offset = 0;
+        }
+
+        struct bvri_objface_s* face = &((struct bvri_objface_s*)object.faces.data)[i];
+        struct bvri_objcorner_s* corners = &((struct bvri_objcorner_s*)object.corners.data)[face->corner];
+
+        face_indices.count = 0;
+        for (uint32 corner = 0; corner < face->edges; corner++)
+        {
+            // attributes unused by the layout must not split vertices
+            struct bvri_objcorner_s key = corners[corner];
+            key.uv = uv_count ? key.uv : -1;
+            key.normal = normal_count ? key.normal : -1;
+
+            uint32* index = bvri_objmapfind(&map, &key);
+            if(*index == BVRI_OBJ_MAP_EMPTY){
+                *index = vertex_count++;
+
+                // positions are always stored as vec3, 2D layouts only keep x and y
+                vertex = bvri_objcopyattrib(vertex, (float*)object.vertex.data, key.vertex, 3, position_count);
+
+                if(uv_count){
+                    vertex = bvri_objcopyattrib(vertex, (float*)object.uvs.data, key.uv, 2, uv_count);
+                }
+                if(normal_count){
+                    vertex = bvri_objcopyattrib(vertex, (float*)object.normals.data, key.normal, 3, normal_count);
+                }
+            }
+
+            *(uint32*)bvri_objarraypush(&face_indices) = *index;
+        }
+
+        uint32 count = bvri_objtriangulate(&triangulation, (float*)object.vertex.data, corners, face->edges);
+        uint32* triangles = (uint32*)triangulation.triangles.data;
+        for (uint32 triangle = 0; triangle < count; triangle++)
+        {
+            *element++ = ((uint32*)face_indices.data)[triangles[triangle]];
+        }
+
+        vertex_group->element_count += count;
+    }
+
+    bvri_objdestroymap(&map);
+    bvri_objdestroytriangulation(&triangulation);
+    bvri_objdestroyarray(&face_indices);
+
+    // degenerated faces may give less triangles than reserved
+    BVR_ASSERT(element <= (uint32*)elements.data + elements.count);
+    elements.count = element - (uint32*)elements.data;
+
+#ifndef BVR_NO_MESH_OPTIMIZATION
+    // reordering triangles would break 2D meshes' drawing order
+    if(position_count == 3){
+        vertex_count = bvri_optimize_mesh((float*)vertices.data, stride, vertex_count, 
+            (uint32*)elements.data, elements.count, &vertex_groups);
+
+#ifndef BVR_NO_MESH_LOD
+        bvri_generate_lods(mesh, (float*)vertices.data, stride, vertex_count, &elements, &vertex_groups);
+#endif
+    }
+#endif
+
+    uint64 vertices_size = (uint64)vertex_count * stride * sizeof(float);
+    if(bvr_is_mesh_quantized(mesh)){
+        vertices_size = bvri_quantize_vertices(mesh, vertices.data, vertex_count, uv_count, normal_count);
+        vertices.type = BVR_INT16;
+    }
+
+    // narrow indices when they fit in 16 bits, in place since the buffer only shrinks
+    if(vertex_count <= 0xFFFF){
+        uint16* narrow = (uint16*)elements.data;
+        for (uint64 i = 0; i < elements.count; i++)
+        {
+            narrow[i] = (uint16)((uint32*)elements.data)[i];
+        }
+        
+        elements.type = BVR_UNSIGNED_INT16;
+    }
+
+    if(bvri_create_mesh_buffers(mesh, 
+        vertices_size, 
+        elements.count * bvr_sizeof(elements.type),
+        vertices.data, elements.data,
+        vertices.type, elements.type, mesh->attrib) == BVR_FAILED){
+
+        BVR_PRINT("failed to create object buffers");
+        goto bvr_objfailed;
+    }
+
+    mesh->vertex_groups.size = vertex_groups.size;
+    mesh->vertex_groups.data = vertex_groups.data;
+
+    bvri_objdestroychunk(&object);
+    free(vertices.data);
+    free(elements.data);
+
+    return BVR_OK;
+
+bvr_objfailed:
+    for (uint64 i = 0; i < BVR_BUFFER_COUNT(vertex_groups); i++)
+    {
+        bvr_destroy_string(&((bvr_vertex_group_t*)vertex_groups.data)[i].name);
+    }
+    
+    free(vertex_groups.data);
+
+    // levels of details generated before failing
+    for (uint64 i = 0; i < BVR_BUFFER_COUNT(mesh->lod_groups); i++)
+    {
+        bvr_destroy_string(&((bvr_vertex_group_t*)mesh->lod_groups.data)[i].name);
+    }
+
+    free(mesh->lod_groups.data);
+    mesh->lod_groups.data = NULL;
+    mesh->lod_groups.size = 0;
+    mesh->lod_count = 1;
+
+    bvri_objdestroychunk(&object);
+    free(vertices.data);
+    free(elements.data);
+
+    return BVR_FAILED;
+}
+
+#endif
+
+#define BVRI_BVRM_SIGNATURE "BVRM"
+#define BVRI_BVRM_VERSION 3
+#define BVRI_BVRM_ALIGNMENT 16
+
+/*
+    Binary mesh's header, followed by the vertex groups table, the levels of details table
+    and by the vertex and element blobs, aligned to BVRI_BVRM_ALIGNMENT.
+*/
+struct bvri_bvrm_header_s {
+    char signature[4];
+    uint32 version;
+
+    /*
+        Source file's modification time and size, 
+        used to invalidate cached meshes.
+    */
+    int64 source_time;
+    uint64 source_size;
+
+    uint32 attrib;
+    uint32 vertex_type;
+    uint32 element_type;
+    uint32 group_count;
+    uint32 lod_count;
+
+    /*
+        Dequantization of quantized layouts.
+    */
+    float position_offset[3];
+    float position_scale[3];
+
+    uint64 vertex_offset;
+    uint64 vertex_size;
+    uint64 element_offset;
+    uint64 element_size;
+};
+
+/*
+    Each group is stored as its element offset, its element count,
+    its name's length, and its name without null terminator.
+*/
+struct bvri_bvrm_group_s {
+    uint32 element_offset;
+    uint32 element_count;
+    uint32 name_length;
+};
+
+/*
+    Each level of details after the first one is stored as its error,
+    followed by a group (without name) for each vertex group.
+*/
+
+static int bvri_is_bvrm(FILE* file){
+    char sig[4];
+
+    fseek(file, 0, SEEK_SET);
+    if(fread(sig, sizeof(char), sizeof(sig), file) != sizeof(sig)){
+        return BVR_FAILED;
+    }
+
+    return !strncmp(sig, BVRI_BVRM_SIGNATURE, sizeof(sig));
+}
+
+/*
+    Walk the groups and levels of details tables, which must end before the vertex blob, 
+    and check that groups' ranges are inside the element blob.
+*/
+static int bvri_check_bvrm_tables(const char* cursor, const char* end, const struct bvri_bvrm_header_s* header){
+    uint32 element_size = bvr_sizeof(header->element_type);
+    if(!element_size){
+        return BVR_FAILED;
+    }
+
+    uint64 element_count = header->element_size / element_size;
+    uint32 lod_count = header->lod_count < BVR_MESH_LOD_COUNT ? header->lod_count : BVR_MESH_LOD_COUNT;
+
+    for (uint32 lod = 0; lod < lod_count || lod == 0; lod++)
+    {
+        if(lod){
+            if((uint64)(end - cursor) < sizeof(float)){
+                return BVR_FAILED;
+            }
+            cursor += sizeof(float);
+        }
+
+        for (uint32 i = 0; i < header->group_count; i++)
+        {
+            struct bvri_bvrm_group_s group;
+            if((uint64)(end - cursor) < sizeof(group)){
+                return BVR_FAILED;
+            }
+
+            memcpy(&group, cursor, sizeof(group));
+            cursor += sizeof(group);
+
+            if((uint64)group.element_offset + group.element_count > element_count){
+                return BVR_FAILED;
+            }
+
+            // only the first level of details stores names
+            if(!lod){
+                if((uint64)(end - cursor) < group.name_length){
+                    return BVR_FAILED;
+                }
+                cursor += group.name_length;
+            }
+        }
+    }
+
+    return BVR_OK;
+}
+
+static int bvri_load_bvrm(bvr_mesh_t* mesh, FILE* file){
+    bvr_file_view_t view;
+    if(!bvr_map_file(&view, file)){
+        return BVR_FAILED;
+    }
+
+    struct bvri_bvrm_header_s header;
+    char* data = (char*)view.data;
+    char* cursor = data + sizeof(header);
+
+    if(view.size < sizeof(header)){
+        goto bvri_bvrmfailed;
+    }
+
+    memcpy(&header, data, sizeof(header));
+
+    // sizes are checked first so that offsets' checks cannot overflow
+    if(header.version != BVRI_BVRM_VERSION || 
+        header.vertex_offset < sizeof(header) ||
+        header.vertex_size > view.size || header.vertex_offset > view.size - header.vertex_size ||
+        header.element_size > view.size || header.element_offset > view.size - header.element_size ||
+        !bvri_check_bvrm_tables(cursor, data + header.vertex_offset, &header)){
+        
+        BVR_PRINT("corrupted or outdated binary mesh!");
+        goto bvri_bvrmfailed;
+    }
+
+    // dequantization is needed to copy positions back to model space
+    vec3_copy(mesh->position_offset, header.position_offset);
+    vec3_copy(mesh->position_scale, header.position_scale);
+
+    // vertex and element blobs are directly uploaded from the mapped file
+    if(!bvri_create_mesh_buffers(mesh, header.vertex_size, header.element_size,
+        data + header.vertex_offset, data + header.element_offset,
+        header.vertex_type, header.element_type, header.attrib)){
+        
+        goto bvri_bvrmfailed;
+    }
+
+    mesh->vertex_groups.size = header.group_count * sizeof(bvr_vertex_group_t);
+    mesh->vertex_groups.data = malloc(mesh->vertex_groups.size);
+    BVR_ASSERT(mesh->vertex_groups.data);
+
+    for (uint32 i = 0; i < header.group_count; i++)
+    {
+        struct bvri_bvrm_group_s group;
+        bvr_vertex_group_t* vertex_group = &((bvr_vertex_group_t*)mesh->vertex_groups.data)[i];
+
+        memcpy(&group, cursor, sizeof(group));
+        cursor += sizeof(group);
+
+        vertex_group->element_offset = group.element_offset;
+        vertex_group->element_count = group.element_count;
+        vertex_group->base_vertex = 0;
+        bvr_create_string(&vertex_group->name, NULL);
+
+        if(group.name_length){
+            vertex_group->name.length = group.name_length + 1;
+            vertex_group->name.string = malloc(vertex_group->name.length);
+            BVR_ASSERT(vertex_group->name.string);
+
+            memcpy(vertex_group->name.string, cursor, group.name_length);
+            vertex_group->name.string[group.name_length] = '\0';
+            cursor += group.name_length;
+        }
+    }
+
+    // levels of details beyond BVR_MESH_LOD_COUNT are ignored
+    mesh->lod_count = header.lod_count < BVR_MESH_LOD_COUNT ? header.lod_count : BVR_MESH_LOD_COUNT;
+    mesh->lod_count = mesh->lod_count ? mesh->lod_count : 1;
+
+    if(mesh->lod_count > 1){
+        mesh->lod_groups.size = (mesh->lod_count - 1) * header.group_count * sizeof(bvr_vertex_group_t);
+        mesh->lod_groups.data = malloc(mesh->lod_groups.size);
+        BVR_ASSERT(mesh->lod_groups.data);
+    }
+
+    for (uint32 lod = 1; lod < mesh->lod_count; lod++)
+    {
+        memcpy(&mesh->lod_errors[lod], cursor, sizeof(float));
+        cursor += sizeof(float);
+
+        for (uint32 i = 0; i < header.group_count; i++)
+        {
+            struct bvri_bvrm_group_s group;
+            bvr_vertex_group_t* lod_group = bvr_mesh_get_lod_group(mesh, lod, i);
+
+            memcpy(&group, cursor, sizeof(group));
+            cursor += sizeof(group);
+
+            bvr_create_string(&lod_group->name, NULL);
+            lod_group->element_offset = group.element_offset;
+            lod_group->element_count = group.element_count;
+            lod_group->base_vertex = 0;
+        }
+    }
+
+    bvr_unmap_file(&view);
+    return BVR_OK;
+
+bvri_bvrmfailed:
+    bvr_unmap_file(&view);
+    return BVR_FAILED;
+}
+
+static void bvri_write_bvrm_padding(FILE* file){
+    static const char padding[BVRI_BVRM_ALIGNMENT] = {0};
+
+    uint64 position = ftell(file);
+    if(position % BVRI_BVRM_ALIGNMENT){
+        fwrite(padding, sizeof(char), BVRI_BVRM_ALIGNMENT - position % BVRI_BVRM_ALIGNMENT, file);
+    }
+}
+
+/*
+    glTF meshes drawn from their source buffer share it between vertices and elements.
+*/
+static int bvri_is_mesh_from_source(bvr_mesh_t* mesh){
+    return mesh->vertex_buffer && mesh->vertex_buffer == mesh->element_buffer;
+}
+
+/*
+    Write mesh's buffers, read back from the GPU or from the pending upload on a mesh loader's thread.
+*/
+static int bvri_write_bvrm(bvr_mesh_t* mesh, FILE* file, int64 source_time, uint64 source_size){
+    BVR_ASSERT(mesh);
+    BVR_ASSERT(file);
+
+    // glTF meshes keep their source layout
+    if(bvri_is_mesh_from_source(mesh)){
+        BVR_PRINT("cannot write a mesh drawn from its source buffers!");
+        return BVR_FAILED;
+    }
+
+    struct bvri_bvrm_header_s header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.signature, BVRI_BVRM_SIGNATURE, sizeof(header.signature));
+    header.version = BVRI_BVRM_VERSION;
+    header.source_time = source_time;
+    header.source_size = source_size;
+    header.attrib = mesh->attrib;
+    header.vertex_type = mesh->vertex_type;
+    header.element_type = mesh->element_type;
+    header.group_count = BVR_BUFFER_COUNT(mesh->vertex_groups);
+    header.lod_count = mesh->lod_count;
+    vec3_copy(header.position_offset, mesh->position_offset);
+    vec3_copy(header.position_scale, mesh->position_scale);
+    header.vertex_size = (uint64)mesh->vertex_count * bvr_sizeof(mesh->vertex_type);
+    header.element_size = (uint64)mesh->element_count * bvr_sizeof(mesh->element_type);
+
+    // blobs' offsets depend on the groups table
+    uint64 offset = sizeof(header);
+    for (uint32 i = 0; i < header.group_count; i++)
+    {
+        bvr_vertex_group_t* vertex_group = &((bvr_vertex_group_t*)mesh->vertex_groups.data)[i];
+        offset += sizeof(struct bvri_bvrm_group_s);
+        offset += vertex_group->name.string ? strlen(vertex_group->name.string) : 0;
+    }
+
+    offset += (uint64)(header.lod_count - 1) * (sizeof(float) + header.group_count * sizeof(struct bvri_bvrm_group_s));
+
+    header.vertex_offset = (offset + BVRI_BVRM_ALIGNMENT - 1) & ~(uint64)(BVRI_BVRM_ALIGNMENT - 1);
+    header.element_offset = (header.vertex_offset + header.vertex_size + BVRI_BVRM_ALIGNMENT - 1) & ~(uint64)(BVRI_BVRM_ALIGNMENT - 1);
+
+    fseek(file, 0, SEEK_SET);
+    fwrite(&header, sizeof(header), 1, file);
+
+    for (uint32 i = 0; i < header.group_count; i++)
+    {
+        bvr_vertex_group_t* vertex_group = &((bvr_vertex_group_t*)mesh->vertex_groups.data)[i];
+
+        struct bvri_bvrm_group_s group;
+        group.element_offset = vertex_group->element_offset;
+        group.element_count = vertex_group->element_count;
+        group.name_length = vertex_group->name.string ? strlen(vertex_group->name.string) : 0;
+
+        fwrite(&group, sizeof(group), 1, file);
+        fwrite(vertex_group->name.string, sizeof(char), group.name_length, file);
+    }
+
+    for (uint32 lod = 1; lod < header.lod_count; lod++)
+    {
+        fwrite(&mesh->lod_errors[lod], sizeof(float), 1, file);
+
+        for (uint32 i = 0; i < header.group_count; i++)
+        {
+            bvr_vertex_group_t* lod_group = bvr_mesh_get_lod_group(mesh, lod, i);
+
+            struct bvri_bvrm_group_s group;
+            group.element_offset = lod_group->element_offset;
+            group.element_count = lod_group->element_count;
+            group.name_length = 0;
+
+            fwrite(&group, sizeof(group), 1, file);
+        }
+    }
+
+    int status = BVR_OK;
+    struct {
+        uint32 target, buffer;
+        uint64 offset, size;
+    } blobs[2] = {
+        {GL_ARRAY_BUFFER, mesh->vertex_buffer, (uint64)mesh->base_vertex * mesh->stride, header.vertex_size},
+        {GL_ELEMENT_ARRAY_BUFFER, mesh->element_buffer, 
+            (uint64)mesh->element_offset * bvr_sizeof(mesh->element_type), header.element_size}
+    };
+
+    struct bvri_mesh_upload_s* upload = SDL_GetTLS(&__mesh_upload);
+    if(upload){
+        for (uint64 i = 0; i < 2 && status; i++)
+        {
+            bvri_write_bvrm_padding(file);
+            status = fwrite(i ? upload->elements : upload->vertices, sizeof(char), blobs[i].size, file) == blobs[i].size;
+        }
+
+        return status;
+    }
+
+    // the element buffer binding is part of the vertex array state
+    glBindVertexArray(0);
+
+    for (uint64 i = 0; i < 2 && status; i++)
+    {
+        bvri_write_bvrm_padding(file);
+
+        if(!blobs[i].size){
+            continue;
+        }
+
+        glBindBuffer(blobs[i].target, blobs[i].buffer);
+
+        void* data = glMapBufferRange(blobs[i].target, blobs[i].offset, blobs[i].size, GL_MAP_READ_BIT);
+        if(data){
+            status = fwrite(data, sizeof(char), blobs[i].size, file) == blobs[i].size;
+            glUnmapBuffer(blobs[i].target);
+        }
+        else {
+            status = BVR_FAILED;
+        }
+
+        glBindBuffer(blobs[i].target, 0);
+    }
+
+    if(!status){
+        BVR_PRINT("failed to write mesh!");
+    }
+
+    return status;
+}
+
+#ifndef BVR_NO_GLTF
+
+#define BVRI_GLB_MAGIC 0x46546C67
+#define BVRI_GLB_VERSION 2
+#define BVRI_GLB_CHUNK_JSON 0x4E4F534A
+#define BVRI_GLB_CHUNK_BIN 0x004E4942
+
+#define BVRI_GLB_TRIANGLES 4
+
+/*
+    Attributes read from glTF primitives, in the order of mesh's attribute pointers.
+*/
+static const char* bvri_glb_attributes[3] = {"POSITION", "TEXCOORD_0", "NORMAL"};
+
+/*
+    glTF accessor resolved inside the binary chunk.
+*/
+struct bvri_glb_accessor_s {
+    const char* data;
+    uint64 offset;
+
+    uint32 count;
+    uint32 stride;
+    uint32 component_type;
+    uint8 component_count;
+    uint8 normalized;
+};
+
+struct bvri_glb_primitive_s {
+    struct bvri_glb_accessor_s attributes[3];
+    struct bvri_glb_accessor_s indices;
+
+    uint8 has_attributes[3];
+    int32 base_vertex;
+
+    const char* name;
+};
+
+static int bvri_is_glb(FILE* file){
+    uint32 header[2];
+
+    fseek(file, 0, SEEK_SET);
+    if(fread(header, sizeof(uint32), 2, file) != 2){
+        return BVR_FAILED;
+    }
+
+    return header[0] == BVRI_GLB_MAGIC && header[1] == BVRI_GLB_VERSION;
+}
+
+static int64 bvri_glb_get_int(struct json_object* object, const char* key, int64 fallback){
+    struct json_object* value;
+    if(!json_object_object_get_ex(object, key, &value)){
+        return fallback;
+    }
+
+    return json_object_get_int64(value);
+}
+
+static struct json_object* bvri_glb_get_item(struct json_object* root, const char* key, int64 index){
+    struct json_object* array;
+    if(index < 0 || !json_object_object_get_ex(root, key, &array) || 
+        index >= (int64)json_object_array_length(array)){
+        
+        return NULL;
+    }
+
+    return json_object_array_get_idx(array, index);
+}
+
+/*
+    Resolve an accessor, only accessors stored in the binary chunk without sparse storage are supported.
+*/
+static int bvri_glb_get_accessor(struct json_object* root, int64 index, const char* bin, uint64 bin_size, 
+    struct bvri_glb_accessor_s* accessor){
+    
+    struct json_object* object = bvri_glb_get_item(root, "accessors", index);
+    struct json_object* type;
+
+    if(!object || !json_object_object_get_ex(object, "type", &type) || 
+        json_object_object_get_ex(object, "sparse", NULL)){
+        
+        return BVR_FAILED;
+    }
+
+    struct json_object* view = bvri_glb_get_item(root, "bufferViews", bvri_glb_get_int(object, "bufferView", -1));
+    if(!view || bvri_glb_get_int(view, "buffer", 0) != 0){
+        return BVR_FAILED;
+    }
+
+    const char* name = json_object_get_string(type);
+    if(!strcmp(name, "SCALAR")){
+        accessor->component_count = 1;
+    }
+    else if(!strncmp(name, "VEC", 3) && name[3] >= '2' && name[3] <= '4' && !name[4]){
+        accessor->component_count = name[3] - '0';
+    }
+    else {
+        return BVR_FAILED;
+    }
+
+    accessor->component_type = bvri_glb_get_int(object, "componentType", 0);
+    accessor->normalized = bvri_glb_get_int(object, "normalized", 0) ? 1 : 0;
+    accessor->count = bvri_glb_get_int(object, "count", 0);
+
+    uint64 size = (uint64)accessor->component_count * bvr_sizeof(accessor->component_type);
+    uint64 view_offset = bvri_glb_get_int(view, "byteOffset", 0);
+    uint64 view_length = bvri_glb_get_int(view, "byteLength", 0);
+
+    accessor->stride = bvri_glb_get_int(view, "byteStride", size);
+    accessor->offset = view_offset + bvri_glb_get_int(object, "byteOffset", 0);
+    accessor->data = bin + accessor->offset;
+
+    if(!size || !accessor->count || view_offset + view_length > bin_size ||
+        accessor->offset + (uint64)accessor->stride * (accessor->count - 1) + size > view_offset + view_length){
+        
+        return BVR_FAILED;
+    }
+
+    return BVR_OK;
+}
+
+/*
+    Read a component as a float, normalized integers are converted like OpenGL does.
+*/
+static float bvri_glb_read(const struct bvri_glb_accessor_s* accessor, uint32 index, uint32 component){
+    const char* element = accessor->data + (uint64)index * accessor->stride;
+
+    switch (accessor->component_type)
+    {
+    case BVR_FLOAT:
+        return ((const float*)element)[component];
+    case BVR_INT8:
+        return accessor->normalized ? fmaxf(((const int8*)element)[component] / 127.0f, -1.0f) : ((const int8*)element)[component];
+    case BVR_UNSIGNED_INT8:
+        return accessor->normalized ? ((const uint8*)element)[component] / 255.0f : ((const uint8*)element)[component];
+    case BVR_INT16:
+        return accessor->normalized ? fmaxf(((const int16*)element)[component] / 32767.0f, -1.0f) : ((const int16*)element)[component];
+    case BVR_UNSIGNED_INT16:
+        return accessor->normalized ? ((const uint16*)element)[component] / 65535.0f : ((const uint16*)element)[component];
+    default:
+        return 0.0f;
+    }
+}
+
+static uint32 bvri_glb_read_index(const struct bvri_glb_accessor_s* accessor, uint32 index){
+    const char* element = accessor->data + (uint64)index * accessor->stride;
+
+    switch (accessor->component_type)
+    {
+    case BVR_UNSIGNED_INT8:
+        return *(const uint8*)element;
+    case BVR_UNSIGNED_INT16:
+        return *(const uint16*)element;
+    default:
+        return *(const uint32*)element;
+    }
+}
+
+/*
+    Check if primitives can be drawn straight from the binary chunk, with one vertex array:
+    each attribute must have the same format in all primitives, and each primitive's attributes 
+    must start at the same vertex relative to the first primitive.
+*/
+static int bvri_glb_can_upload(struct bvri_glb_primitive_s* primitives, uint32 primitive_count, 
+    const uint32* counts, int quantized){
+
+    if(quantized){
+        return BVR_FAILED;
+    }
+
+    // the lowest position is the reference, so that base vertices are never negative
+    uint32 reference = 0;
+    for (uint32 i = 0; i < primitive_count; i++)
+    {
+        if(primitives[i].attributes[0].offset < primitives[reference].attributes[0].offset){
+            reference = i;
+        }
+    }
+
+    for (uint32 i = 0; i < primitive_count; i++)
+    {
+        struct bvri_glb_primitive_s* primitive = &primitives[i];
+
+        if(primitive->indices.component_type != primitives[0].indices.component_type ||
+            primitive->indices.stride != bvr_sizeof(primitive->indices.component_type) ||
+            primitive->indices.offset % primitive->indices.stride){
+            
+            return BVR_FAILED;
+        }
+
+        uint64 delta = primitive->attributes[0].offset - primitives[reference].attributes[0].offset;
+        if(delta % primitive->attributes[0].stride){
+            return BVR_FAILED;
+        }
+
+        primitive->base_vertex = delta / primitive->attributes[0].stride;
+
+        for (uint32 attribute = 0; attribute < 3; attribute++)
+        {
+            if(!counts[attribute]){
+                continue;
+            }
+
+            struct bvri_glb_accessor_s* accessor = &primitive->attributes[attribute];
+            struct bvri_glb_accessor_s* first = &primitives[reference].attributes[attribute];
+
+            if(!primitive->has_attributes[attribute] ||
+                accessor->component_type != first->component_type ||
+                accessor->normalized != first->normalized ||
+                accessor->stride != first->stride ||
+                accessor->component_count < counts[attribute] ||
+                accessor->offset != first->offset + (uint64)primitive->base_vertex * first->stride){
+                
+                return BVR_FAILED;
+            }
+        }
+    }
+
+    return primitives[0].indices.component_type == BVR_UNSIGNED_INT16 || 
+        primitives[0].indices.component_type == BVR_UNSIGNED_INT32;
+}
+
+/*
+    Upload the part of the binary chunk used by the primitives as it is, 
+    it holds both vertices and indices.
+*/
+static int bvri_glb_upload(bvr_mesh_t* mesh, struct bvri_glb_primitive_s* primitives, uint32 primitive_count, 
+    const uint32* counts, const char* bin, struct bvr_buffer_s* vertex_groups){
+
+    uint64 begin = ~(uint64)0, end = 0;
+    uint32 element_count = 0;
+
+    for (uint32 i = 0; i < primitive_count; i++)
+    {
+        struct bvri_glb_accessor_s* accessors[4] = {
+            &primitives[i].attributes[0], &primitives[i].attributes[1], 
+            &primitives[i].attributes[2], &primitives[i].indices
+        };
+
+        for (uint32 j = 0; j < 4; j++)
+        {
+            if(j < 3 && !counts[j]){
+                continue;
+            }
+
+            uint64 accessor_end = accessors[j]->offset + (uint64)accessors[j]->stride * (accessors[j]->count - 1) +
+                accessors[j]->component_count * bvr_sizeof(accessors[j]->component_type);
+
+            begin = accessors[j]->offset < begin ? accessors[j]->offset : begin;
+            end = accessor_end > end ? accessor_end : end;
+        }
+
+        element_count += primitives[i].indices.count;
+    }
+
+    // keep indices aligned within the buffer
+    begin &= ~(uint64)3;
+
+    // the element buffer binding is part of the vertex array state
+    glGenVertexArrays(1, &mesh->array_buffer);
+    glBindVertexArray(mesh->array_buffer);
+
+    glGenBuffers(1, &mesh->vertex_buffer);
+    mesh->element_buffer = mesh->vertex_buffer;
+
+    glBindBuffer(GL_ARRAY_BUFFER, mesh->vertex_buffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->element_buffer);
+    glBufferData(GL_ARRAY_BUFFER, end - begin, bin + begin, GL_STATIC_DRAW);
+
+    struct bvri_glb_primitive_s* reference = primitives;
+    for (uint32 i = 0; i < primitive_count; i++)
+    {
+        reference = primitives[i].base_vertex ? reference : &primitives[i];
+    }
+
+    mesh->attrib_count = 0;
+    for (uint32 attribute = 0; attribute < 3; attribute++)
+    {
+        if(!counts[attribute]){
+            continue;
+        }
+
+        struct bvri_glb_accessor_s* accessor = &reference->attributes[attribute];
+
+        glEnableVertexAttribArray(attribute);
+        glVertexAttribPointer(attribute, counts[attribute], accessor->component_type, accessor->normalized, 
+            accessor->stride, (void*)(accessor->offset - begin));
+        
+        mesh->attrib_count++;
+    }
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    mesh->vertex_type = reference->attributes[0].component_type;
+    mesh->element_type = reference->indices.component_type;
+    mesh->vertex_count = (end - begin) / bvr_sizeof(mesh->vertex_type);
+    mesh->element_count = element_count;
+    mesh->stride = reference->attributes[0].stride;
+
+    for (uint32 i = 0; i < primitive_count; i++)
+    {
+        bvr_vertex_group_t* group = &((bvr_vertex_group_t*)vertex_groups->data)[i];
+        group->element_offset = (primitives[i].indices.offset - begin) / primitives[i].indices.stride;
+        group->element_count = primitives[i].indices.count;
+        group->base_vertex = primitives[i].base_vertex;
+    }
+
+    // positions are packed, primitives may leave gaps in the vertex array
+    uint64 position_count = 0;
+    for (uint32 i = 0; i < primitive_count; i++)
+    {
+        position_count += primitives[i].attributes[0].count;
+    }
+
+    float* positions = malloc(position_count * counts[0] * sizeof(float));
+    BVR_ASSERT(positions);
+
+    float* position = positions;
+    for (uint32 i = 0; i < primitive_count; i++)
+    {
+        for (uint32 vertex = 0; vertex < primitives[i].attributes[0].count; vertex++)
+        {
+            for (uint32 axis = 0; axis < counts[0]; axis++)
+            {
+                *position++ = bvri_glb_read(&primitives[i].attributes[0], vertex, axis);
+            }
+        }
+    }
+
+    bvri_set_mesh_positions(mesh, positions, position_count, counts[0]);
+
+    return BVR_OK;
+}
+
+/*
+    Interleave primitives' vertices into mesh's layout, when they cannot be uploaded as they are.
+*/
+static int bvri_glb_convert(bvr_mesh_t* mesh, struct bvri_glb_primitive_s* primitives, uint32 primitive_count, 
+    const uint32* counts, struct bvr_buffer_s* vertex_groups){
+    
+    const uint32 stride = counts[0] + counts[1] + counts[2];
+
+    uint64 vertex_count = 0, element_count = 0;
+    for (uint32 i = 0; i < primitive_count; i++)
+    {
+        vertex_count += primitives[i].attributes[0].count;
+        element_count += primitives[i].indices.count;
+    }
+
+    float* vertices = calloc(vertex_count * stride, sizeof(float));
+    uint32* elements = malloc(element_count * sizeof(uint32));
+    BVR_ASSERT(vertices);
+    BVR_ASSERT(elements);
+
+    uint64 vertex = 0, element = 0;
+    for (uint32 i = 0; i < primitive_count; i++)
+    {
+        struct bvri_glb_primitive_s* primitive = &primitives[i];
+        bvr_vertex_group_t* group = &((bvr_vertex_group_t*)vertex_groups->data)[i];
+
+        group->element_offset = element;
+        group->element_count = primitive->indices.count;
+        group->base_vertex = 0;
+
+        for (uint32 index = 0; index < primitive->indices.count; index++)
+        {
+            uint32 value = bvri_glb_read_index(&primitive->indices, index);
+            if(value >= primitive->attributes[0].count){
+                BVR_PRINT("glTF index out of range!");
+                value = 0;
+            }
+
+            elements[element++] = vertex + value;
+        }
+
+        for (uint32 index = 0; index < primitive->attributes[0].count; index++, vertex++)
+        {
+            float* target = &vertices[vertex * stride];
+            for (uint32 attribute = 0; attribute < 3; attribute++)
+            {
+                if(!primitive->has_attributes[attribute]){
+                    target += counts[attribute];
+                    continue;
+                }
+
+                for (uint32 component = 0; component < counts[attribute]; component++)
+                {
+                    *target++ = component < primitive->attributes[attribute].component_count ? 
+                        bvri_glb_read(&primitive->attributes[attribute], index, component) : 0.0f;
+                }
+            }
+        }
+    }
+
+    uint64 vertices_size = vertex_count * stride * sizeof(float);
+    int vertex_type = BVR_FLOAT;
+    if(bvr_is_mesh_quantized(mesh)){
+        vertices_size = bvri_quantize_vertices(mesh, vertices, vertex_count, counts[1], counts[2]);
+        vertex_type = BVR_INT16;
+    }
+
+    // narrow indices when they fit in 16 bits, in place since the buffer only shrinks
+    int element_type = BVR_UNSIGNED_INT32;
+    if(vertex_count <= 0xFFFF){
+        for (uint64 i = 0; i < element_count; i++)
+        {
+            ((uint16*)elements)[i] = (uint16)elements[i];
+        }
+
+        element_type = BVR_UNSIGNED_INT16;
+    }
+
+    int status = bvri_create_mesh_buffers(mesh, vertices_size, element_count * bvr_sizeof(element_type), 
+        vertices, elements, vertex_type, element_type, mesh->attrib);
+
+    free(vertices);
+    free(elements);
+
+    return status;
+}
+
+/*
+    Load the first mesh of a binary glTF, each of its triangle primitives becomes a vertex group
+    named after its material.
+*/
+static int bvri_load_glb(bvr_mesh_t* mesh, FILE* file){
+    bvr_file_view_t view;
+    if(!bvr_map_file(&view, file)){
+        return BVR_FAILED;
+    }
+
+    int status = BVR_FAILED;
+    struct json_object* root = NULL;
+    struct bvri_glb_primitive_s* primitives = NULL;
+    struct bvr_buffer_s vertex_groups;
+
+    vertex_groups.size = 0;
+    vertex_groups.elemsize = sizeof(bvr_vertex_group_t);
+    vertex_groups.data = NULL;
+
+    const char* data = (const char*)view.data;
+    uint32 chunk[2];
+
+    // header, then a JSON chunk and an optional binary chunk
+    if(view.size < 20){
+        goto bvri_glbfailed;
+    }
+
+    memcpy(chunk, data + 12, sizeof(chunk));
+    if(chunk[1] != BVRI_GLB_CHUNK_JSON || 20 + (uint64)chunk[0] > view.size){
+        goto bvri_glbfailed;
+    }
+
+    const char* json = data + 20;
+    uint64 json_size = chunk[0];
+
+    const char* bin = NULL;
+    uint64 bin_size = 0;
+    uint64 bin_offset = 20 + ((json_size + 3) & ~(uint64)3);
+
+    if(bin_offset + 8 <= view.size){
+        memcpy(chunk, data + bin_offset, sizeof(chunk));
+        if(chunk[1] == BVRI_GLB_CHUNK_BIN && bin_offset + 8 + (uint64)chunk[0] <= view.size){
+            bin = data + bin_offset + 8;
+            bin_size = chunk[0];
+        }
+    }
+
+    struct json_tokener* tokener = json_tokener_new();
+    root = json_tokener_parse_ex(tokener, json, json_size);
+    json_tokener_free(tokener);
+
+    struct json_object* object = bvri_glb_get_item(root, "meshes", 0);
+    struct json_object* primitive_array;
+
+    if(!root || !bin || !object || !json_object_object_get_ex(object, "primitives", &primitive_array)){
+        BVR_PRINT("cannot find a mesh in glTF!");
+        goto bvri_glbfailed;
+    }
+
+    uint32 counts[3];
+    bvri_get_float_layout(mesh->attrib, &counts[0], &counts[1], &counts[2]);
+
+    uint32 primitive_count = 0;
+    primitives = calloc(json_object_array_length(primitive_array), sizeof(struct bvri_glb_primitive_s));
+    BVR_ASSERT(primitives);
+
+    for (uint64 i = 0; i < json_object_array_length(primitive_array); i++)
+    {
+        struct json_object* item = json_object_array_get_idx(primitive_array, i);
+        struct json_object* attributes;
+        struct bvri_glb_primitive_s* primitive = &primitives[primitive_count];
+
+        if(bvri_glb_get_int(item, "mode", BVRI_GLB_TRIANGLES) != BVRI_GLB_TRIANGLES ||
+            !json_object_object_get_ex(item, "attributes", &attributes) ||
+            !bvri_glb_get_accessor(root, bvri_glb_get_int(item, "indices", -1), bin, bin_size, &primitive->indices)){
+            
+            BVR_PRINT("skipping glTF primitive, only indexed triangles are supported!");
+            continue;
+        }
+
+        for (uint32 attribute = 0; attribute < 3; attribute++)
+        {
+            primitive->has_attributes[attribute] = bvri_glb_get_accessor(root, 
+                bvri_glb_get_int(attributes, bvri_glb_attributes[attribute], -1), bin, bin_size, 
+                &primitive->attributes[attribute]);
+        }
+
+        if(!primitive->has_attributes[0] || primitive->attributes[0].component_type != BVR_FLOAT){
+            BVR_PRINT("skipping glTF primitive, positions must be floats!");
+            continue;
+        }
+
+        struct json_object* material = bvri_glb_get_item(root, "materials", bvri_glb_get_int(item, "material", -1));
+        struct json_object* name = NULL;
+        
+        primitive->name = material && json_object_object_get_ex(material, "name", &name) ? 
+            json_object_get_string(name) : NULL;
+
+        primitive_count++;
+    }
+
+    if(!primitive_count){
+        goto bvri_glbfailed;
+    }
+
+    vertex_groups.size = primitive_count * sizeof(bvr_vertex_group_t);
+    vertex_groups.data = malloc(vertex_groups.size);
+    BVR_ASSERT(vertex_groups.data);
+
+    for (uint32 i = 0; i < primitive_count; i++)
+    {
+        bvr_create_string(&((bvr_vertex_group_t*)vertex_groups.data)[i].name, primitives[i].name);
+    }
+
+    // binary chunk is uploaded without copy when its layout can be drawn as it is,
+    // which needs the render thread
+    if(!SDL_GetTLS(&__mesh_upload) && bvri_glb_can_upload(primitives, primitive_count, counts, bvr_is_mesh_quantized(mesh))){
+        status = bvri_glb_upload(mesh, primitives, primitive_count, counts, bin, &vertex_groups);
+    }
+    else {
+        status = bvri_glb_convert(mesh, primitives, primitive_count, counts, &vertex_groups);
+    }
+
+    if(status){
+        mesh->vertex_groups.size = vertex_groups.size;
+        mesh->vertex_groups.data = vertex_groups.data;
+        vertex_groups.data = NULL;
+    }
+
+bvri_glbfailed:
+    for (uint64 i = 0; i < BVR_BUFFER_COUNT(vertex_groups); i++)
+    {
+        bvr_destroy_string(&((bvr_vertex_group_t*)vertex_groups.data)[i].name);
+    }
+
+    free(vertex_groups.data);
+    free(primitives);
+    json_object_put(root);
+    bvr_unmap_file(&view);
+
+    return status;
+}
+
+#endif
+
+int bvr_create_meshf(bvr_mesh_t* mesh, FILE* file, bvr_mesh_array_attrib_t attrib){
+    BVR_ASSERT(mesh);
+    BVR_ASSERT(file);
+
+    int status = 0;
+
+    mesh->array_buffer = 0;
+    mesh->vertex_buffer = 0;
+    mesh->element_buffer = 0;
+    mesh->base_vertex = 0;
+    mesh->element_offset = 0;
+    mesh->vertex_count = 0;
+    mesh->element_count = 0;
+    mesh->vertex_type = 0;
+    mesh->element_type = 0;
+    mesh->attrib_count = 0;
+    mesh->stride = 0;
+    mesh->attrib = attrib;
+
+    mesh->position_offset[0] = 0.0f;
+    mesh->position_offset[1] = 0.0f;
+    mesh->position_offset[2] = 0.0f;
+    mesh->position_scale[0] = 1.0f;
+    mesh->position_scale[1] = 1.0f;
+    mesh->position_scale[2] = 1.0f;
+
+    mesh->lod_count = 1;
+    mesh->lod_errors[0] = 0.0f;
+    mesh->lod_groups.size = 0;
+    mesh->lod_groups.elemsize = sizeof(bvr_vertex_group_t);
+    mesh->lod_groups.data = NULL;
+
+    memset(mesh->bounds_min, 0, sizeof(vec3));
+    memset(mesh->bounds_max, 0, sizeof(vec3));
+    memset(mesh->bounds_center, 0, sizeof(vec3));
+    mesh->bounds_radius = 0.0f;
+
+    mesh->positions = NULL;
+    mesh->position_count = 0;
+    mesh->position_components = 0;
+
+    mesh->vertex_groups.size = 0;
+    mesh->vertex_groups.elemsize = sizeof(bvr_vertex_group_t);
+    mesh->vertex_groups.data = NULL;
+
+    if(bvri_is_bvrm(file)){
+        status = bvri_load_bvrm(mesh, file);
+    }
+
+#ifndef BVR_NO_GLTF
+    if(!status && bvri_is_glb(file)){
+        status = bvri_load_glb(mesh, file);
+    }
+#endif
+
+#ifndef BVR_NO_OBJ
+    if(!status && bvri_is_obj(file)){
+        status = bvri_load_obj(mesh, file);
+    }
+#endif
+
+    if(!status){
+        BVR_PRINT("failed to load model");
+    }
+
+    return status;
+}
+
+int bvr_create_mesh(bvr_mesh_t* mesh, const char* path, bvr_mesh_array_attrib_t attrib){
+    BVR_ASSERT(mesh);
+    BVR_ASSERT(path);
+
+    BVR_FILE_EXISTS(path);
+
+    int status = BVR_FAILED;
+
+#ifndef BVR_NO_MESH_CACHE
+    uint64 length = strlen(path);
+    uint64 extension_length = sizeof(BVR_MESH_CACHE_EXTENSION) - 1;
+    
+    char* cache_path = NULL;
+    SDL_PathInfo info;
+
+    // binary meshes are never cached
+    if((length < extension_length || strcmp(path + length - extension_length, BVR_MESH_CACHE_EXTENSION)) && 
+        SDL_GetPathInfo(path, &info)){
+        
+        cache_path = malloc(length + extension_length + 1);
+        BVR_ASSERT(cache_path);
+
+        memcpy(cache_path, path, length);
+        memcpy(cache_path + length, BVR_MESH_CACHE_EXTENSION, extension_length + 1);
+
+        FILE* cache = fopen(cache_path, "rb");
+        if(cache){
+            struct bvri_bvrm_header_s header;
+
+            // cache is valid if the source and the attributes are the same
+            if(fread(&header, sizeof(header), 1, cache) == 1 &&
+                !strncmp(header.signature, BVRI_BVRM_SIGNATURE, sizeof(header.signature)) &&
+                header.version == BVRI_BVRM_VERSION &&
+                header.source_time == info.modify_time &&
+                header.source_size == info.size &&
+                header.attrib == (uint32)attrib){
+
+                status = bvr_create_meshf(mesh, cache, attrib);
+            }
+
+            fclose(cache);
+        }
+
+        if(status){
+            free(cache_path);
+            return status;
+        }
+    }
+#endif
+
+    FILE* file = fopen(path, "rb");
+    status = bvr_create_meshf(mesh, file, attrib);
+    fclose(file);
+
+#ifndef BVR_NO_MESH_CACHE
+    if(status && cache_path && !bvri_is_mesh_from_source(mesh)){
+        FILE* cache = fopen(cache_path, "wb");
+        if(cache){
+            int cached = bvri_write_bvrm(mesh, cache, info.modify_time, info.size);
+            fclose(cache);
+
+            // never leave a truncated cache behind
+            if(!cached){
+                remove(cache_path);
+            }
+        }
+    }
+
+    free(cache_path);
+#endif
+
+    return status;
+}
+
+int bvr_write_mesh(bvr_mesh_t* mesh, FILE* file){
+    return bvri_write_bvrm(mesh, file, 0, 0);
+}
+
+enum bvri_mesh_request_state_e {
+    BVRI_MESH_REQUEST_QUEUED,
+    BVRI_MESH_REQUEST_LOADING,
+    BVRI_MESH_REQUEST_READY,
+    BVRI_MESH_REQUEST_FAILED
+};
+
+/*
+    Mesh loaded by the mesh loader's thread.
+    `target` is the user's mesh, it is NULL once the mesh is destroyed before being loaded.
+*/
+struct bvri_mesh_request_s {
+    bvr_mesh_t* target;
+    bvr_mesh_t mesh;
+
+    struct bvri_mesh_upload_s upload;
+    bvr_string_t path;
+    bvr_mesh_array_attrib_t attrib;
+
+    int state;
+};
+
+static struct bvri_mesh_loader_s {
+    struct bvr_buffer_s requests;
+
+    SDL_Thread* thread;
+    SDL_Mutex* lock;
+    SDL_Condition* signal;
+    int running;
+} __mesh_loader;
+
+static int bvri_mesh_loader_worker(void* data){
+    struct bvri_mesh_loader_s* loader = (struct bvri_mesh_loader_s*)data;
+
+    SDL_LockMutex(loader->lock);
+    while (loader->running)
+    {
+        struct bvri_mesh_request_s* request = NULL;
+        for (uint64 i = 0; i < BVR_BUFFER_COUNT(loader->requests); i++)
+        {
+            request = ((struct bvri_mesh_request_s**)loader->requests.data)[i];
+            if(request->state == BVRI_MESH_REQUEST_QUEUED){
+                break;
+            }
+            request = NULL;
+        }
+
+        if(!request){
+            SDL_WaitCondition(loader->signal, loader->lock);
+            continue;
+        }
+
+        request->state = BVRI_MESH_REQUEST_LOADING;
+        SDL_UnlockMutex(loader->lock);
+
+        // buffers' content is kept in the request instead of being uploaded
+        SDL_SetTLS(&__mesh_upload, &request->upload, NULL);
+        int status = bvr_create_mesh(&request->mesh, request->path.string, request->attrib);
+        SDL_SetTLS(&__mesh_upload, NULL, NULL);
+
+        SDL_LockMutex(loader->lock);
+        request->state = status ? BVRI_MESH_REQUEST_READY : BVRI_MESH_REQUEST_FAILED;
+    }
+    SDL_UnlockMutex(loader->lock);
+
+    return 0;
+}
+
+/*
+    Create mesh's buffers from its pending upload, on the render thread.
+*/
+static void bvri_finish_mesh_request(struct bvri_mesh_request_s* request){
+    struct bvri_mesh_upload_s* upload = &request->upload;
+
+    if(request->state == BVRI_MESH_REQUEST_READY && request->target){
+        if(bvri_upload_mesh_buffers(&request->mesh, upload->vertices_size, upload->element_size, 
+            upload->vertices, upload->elements, upload->vertex_type, upload->attrib)){
+
+            memcpy(request->target, &request->mesh, sizeof(bvr_mesh_t));
+        }
+    }
+    else if(request->state == BVRI_MESH_REQUEST_READY){
+        bvr_destroy_mesh(&request->mesh);
+    }
+    else if(request->target){
+        BVR_PRINT("failed to load mesh in background!");
+    }
+
+    free(upload->vertices);
+    free(upload->elements);
+    bvr_destroy_string(&request->path);
+    free(request);
+}
+
+int bvr_create_mesh_async(bvr_mesh_t* mesh, const char* path, bvr_mesh_array_attrib_t attrib){
+    BVR_ASSERT(mesh);
+    BVR_ASSERT(path);
+
+    // mesh stays empty until it is loaded, it has no vertex group to draw
+    memset(mesh, 0, sizeof(bvr_mesh_t));
+    mesh->attrib = attrib;
+    mesh->lod_count = 1;
+    mesh->position_scale[0] = 1.0f;
+    mesh->position_scale[1] = 1.0f;
+    mesh->position_scale[2] = 1.0f;
+    mesh->vertex_groups.elemsize = sizeof(bvr_vertex_group_t);
+    mesh->lod_groups.elemsize = sizeof(bvr_vertex_group_t);
+
+    struct bvri_mesh_loader_s* loader = &__mesh_loader;
+    if(!loader->thread){
+        loader->requests.data = NULL;
+        loader->requests.size = 0;
+        loader->requests.elemsize = sizeof(struct bvri_mesh_request_s*);
+        loader->running = 1;
+
+        loader->lock = SDL_CreateMutex();
+        loader->signal = SDL_CreateCondition();
+        loader->thread = SDL_CreateThread(bvri_mesh_loader_worker, "bvr_mesh_loader", loader);
+
+        if(!loader->lock || !loader->signal || !loader->thread){
+            BVR_PRINT("failed to create mesh loader, loading mesh on the calling thread!");
+            bvr_destroy_mesh_loader();
+            return bvr_create_mesh(mesh, path, attrib);
+        }
+    }
+
+    struct bvri_mesh_request_s* request = calloc(1, sizeof(struct bvri_mesh_request_s));
+    BVR_ASSERT(request);
+
+    request->target = mesh;
+    request->attrib = attrib;
+    request->state = BVRI_MESH_REQUEST_QUEUED;
+    bvr_create_string(&request->path, path);
+
+    SDL_LockMutex(loader->lock);
+    loader->requests.data = realloc(loader->requests.data, loader->requests.size + loader->requests.elemsize);
+    BVR_ASSERT(loader->requests.data);
+
+    ((struct bvri_mesh_request_s**)loader->requests.data)[BVR_BUFFER_COUNT(loader->requests)] = request;
+    loader->requests.size += loader->requests.elemsize;
+
+    SDL_SignalCondition(loader->signal);
+    SDL_UnlockMutex(loader->lock);
+
+    return BVR_OK;
+}
+
+int bvr_is_mesh_loading(bvr_mesh_t* mesh){
+    BVR_ASSERT(mesh);
+
+    struct bvri_mesh_loader_s* loader = &__mesh_loader;
+    if(!loader->thread){
+        return 0;
+    }
+
+    int loading = 0;
+
+    SDL_LockMutex(loader->lock);
+    for (uint64 i = 0; i < BVR_BUFFER_COUNT(loader->requests) && !loading; i++)
+    {
+        loading = ((struct bvri_mesh_request_s**)loader->requests.data)[i]->target == mesh;
+    }
+    SDL_UnlockMutex(loader->lock);
+
+    return loading;
+}
+
+void bvr_update_mesh_loader(float budget){
+    struct bvri_mesh_loader_s* loader = &__mesh_loader;
+    if(!loader->thread){
+        return;
+    }
+
+    const uint64 start = SDL_GetTicksNS();
+    const uint64 limit = (uint64)(budget * SDL_NS_PER_MS);
+
+    // at least one mesh is finished each frame
+    do
+    {
+        struct bvri_mesh_request_s* request = NULL;
+
+        SDL_LockMutex(loader->lock);
+        for (uint64 i = 0; i < BVR_BUFFER_COUNT(loader->requests); i++)
+        {
+            request = ((struct bvri_mesh_request_s**)loader->requests.data)[i];
+            if(request->state == BVRI_MESH_REQUEST_READY || request->state == BVRI_MESH_REQUEST_FAILED){
+                loader->requests.size -= loader->requests.elemsize;
+                memmove(
+                    &((struct bvri_mesh_request_s**)loader->requests.data)[i], 
+                    &((struct bvri_mesh_request_s**)loader->requests.data)[i + 1], 
+                    loader->requests.size - i * loader->requests.elemsize
+                );
+                break;
+            }
+            request = NULL;
+        }
+        SDL_UnlockMutex(loader->lock);
+
+        if(!request){
+            break;
+        }
+
+        bvri_finish_mesh_request(request);
+    } 
+    while (SDL_GetTicksNS() - start < limit);
+}
+
+void bvr_destroy_mesh_loader(void){
+    struct bvri_mesh_loader_s* loader = &__mesh_loader;
+
+    if(loader->thread){
+        SDL_LockMutex(loader->lock);
+        loader->running = 0;
+        SDL_SignalCondition(loader->signal);
+        SDL_UnlockMutex(loader->lock);
+
+        SDL_WaitThread(loader->thread, NULL);
+        loader->thread = NULL;
+    }
+
+    // unfinished meshes are dropped
+    for (uint64 i = 0; i < BVR_BUFFER_COUNT(loader->requests); i++)
+    {
+        struct bvri_mesh_request_s* request = ((struct bvri_mesh_request_s**)loader->requests.data)[i];
+        request->target = NULL;
+        
+        bvri_finish_mesh_request(request);
+    }
+
+    free(loader->requests.data);
+    loader->requests.data = NULL;
+    loader->requests.size = 0;
+
+    SDL_DestroyCondition(loader->signal);
+    SDL_DestroyMutex(loader->lock);
+    loader->signal = NULL;
+    loader->lock = NULL;
+}
+
+/*
+    Forget the pending load of a destroyed mesh.
+*/
+static void bvri_cancel_mesh_request(bvr_mesh_t* mesh){
+    struct bvri_mesh_loader_s* loader = &__mesh_loader;
+    if(!loader->thread){
+        return;
+    }
+
+    SDL_LockMutex(loader->lock);
+    for (uint64 i = 0; i < BVR_BUFFER_COUNT(loader->requests); i++)
+    {
+        struct bvri_mesh_request_s* request = ((struct bvri_mesh_request_s**)loader->requests.data)[i];
+        if(request->target == mesh){
+            request->target = NULL;
+        }
+    }
+    SDL_UnlockMutex(loader->lock);
+}
+
+int bvr_create_meshv(bvr_mesh_t* mesh, bvr_mesh_buffer_t* vertices, bvr_mesh_buffer_t* elements, bvr_mesh_array_attrib_t attrib){
     BVR_ASSERT(mesh);
     BVR_ASSERT(vertices);
     BVR_ASSERT(elements);
 
-    int status = 0;
+    int status = 0;
+
+    mesh->array_buffer = 0;
+    mesh->vertex_buffer = 0;
+    mesh->element_buffer = 0;
+    mesh->base_vertex = 0;
+    mesh->element_offset = 0;
+    mesh->vertex_count = 0;
+    mesh->element_count = 0;
+    mesh->vertex_type = 0;
+    mesh->element_type = 0;
+    mesh->attrib_count = 0;
+    mesh->stride = 0;
+    mesh->attrib = attrib;
+
+    mesh->position_offset[0] = 0.0f;
+    mesh->position_offset[1] = 0.0f;
+    mesh->position_offset[2] = 0.0f;
+    mesh->position_scale[0] = 1.0f;
+    mesh->position_scale[1] = 1.0f;
+    mesh->position_scale[2] = 1.0f;
+
+    mesh->lod_count = 1;
+    mesh->lod_errors[0] = 0.0f;
+    mesh->lod_groups.size = 0;
+    mesh->lod_groups.elemsize = sizeof(bvr_vertex_group_t);
+    mesh->lod_groups.data = NULL;
+
+    memset(mesh->bounds_min, 0, sizeof(vec3));
+    memset(mesh->bounds_max, 0, sizeof(vec3));
+    memset(mesh->bounds_center, 0, sizeof(vec3));
+    mesh->bounds_radius = 0.0f;
+
+    mesh->positions = NULL;
+    mesh->position_count = 0;
+    mesh->position_components = 0;
+
+    mesh->vertex_groups.size = 0;
+    mesh->vertex_groups.elemsize = sizeof(bvr_vertex_group_t);
+    mesh->vertex_groups.data = NULL;
+
+    // float vertices are quantized on a copy
+    if(bvr_is_mesh_quantized(mesh) && vertices->type == BVR_FLOAT){
+        uint32 position_count, uv_count, normal_count;
+        bvri_get_float_layout(attrib, &position_count, &uv_count, &normal_count);
+
+        uint64 size = vertices->count * sizeof(float);
+        void* quantized = malloc(size);
+        BVR_ASSERT(quantized);
+
+        memcpy(quantized, vertices->data, size);
+        size = bvri_quantize_vertices(mesh, quantized, 
+            vertices->count / (position_count + uv_count + normal_count), uv_count, normal_count);
+
+        status = bvri_create_mesh_buffers(mesh, size, 
+            elements->count * bvr_sizeof(elements->type),
+            quantized, elements->data, BVR_INT16, elements->type, attrib
+        );
+
+        free(quantized);
+    }
+    else {
+        status = bvri_create_mesh_buffers(mesh, 
+            vertices->count * bvr_sizeof(vertices->type),
+            elements->count * bvr_sizeof(elements->type),
+            vertices->data, elements->data, vertices->type, elements->type, attrib
+        );
+    }
+
+    // if cannot create buffers
+    if(!status){
+        return BVR_FAILED;
+    }
+
+    // allocate a single vertex group 
+    mesh->vertex_groups.size = sizeof(bvr_vertex_group_t);
+    mesh->vertex_groups.data = malloc(mesh->vertex_groups.size);
+    BVR_ASSERT(mesh->vertex_groups.data);
+
+    ((bvr_vertex_group_t*)mesh->vertex_groups.data)[0].name.length = 0;
+    ((bvr_vertex_group_t*)mesh->vertex_groups.data)[0].name.string = NULL;
+    ((bvr_vertex_group_t*)mesh->vertex_groups.data)[0].element_offset = 0;
+    ((bvr_vertex_group_t*)mesh->vertex_groups.data)[0].element_count = elements->count;
+    ((bvr_vertex_group_t*)mesh->vertex_groups.data)[0].base_vertex = 0;
+
+    return BVR_OK;
+}
+
+/*
+    Compute mesh's bounds from a compact copy of its positions (`components` floats per vertex), 
+    and keep the copy unless BVR_NO_MESH_POSITIONS is defined.
+*/
+static void bvri_set_mesh_positions(bvr_mesh_t* mesh, float* positions, uint32 vertex_count, uint8 components){
+    mesh->position_count = vertex_count;
+    mesh->position_components = components;
+
+    memcpy(mesh->bounds_min, positions, components * sizeof(float));
+    memcpy(mesh->bounds_max, positions, components * sizeof(float));
+
+    for (uint64 i = 1; i < vertex_count; i++)
+    {
+        for (uint32 axis = 0; axis < components; axis++)
+        {
+            mesh->bounds_min[axis] = fminf(mesh->bounds_min[axis], positions[i * components + axis]);
+            mesh->bounds_max[axis] = fmaxf(mesh->bounds_max[axis], positions[i * components + axis]);
+        }
+    }
+
+    // sphere is centered on the box, its radius is the farthest vertex
+    float radius = 0.0f;
+    for (uint32 axis = 0; axis < 3; axis++)
+    {
+        mesh->bounds_center[axis] = (mesh->bounds_min[axis] + mesh->bounds_max[axis]) * 0.5f;
+    }
+
+    for (uint64 i = 0; i < vertex_count; i++)
+    {
+        float distance = 0.0f;
+        for (uint32 axis = 0; axis < components; axis++)
+        {
+            float delta = positions[i * components + axis] - mesh->bounds_center[axis];
+            distance += delta * delta;
+        }
+
+        radius = fmaxf(radius, distance);
+    }
+
+    mesh->bounds_radius = sqrtf(radius);
+
+#ifndef BVR_NO_MESH_POSITIONS
+    mesh->positions = positions;
+#else
+    free(positions);
+    mesh->position_count = 0;
+#endif
+}
+
+/*
+    Compute mesh's bounds from the vertices it is created with.
+    Quantized positions are brought back to model space.
+*/
+static void bvri_compute_mesh_bounds(bvr_mesh_t* mesh, const void* vertices, uint32 vertex_count){
+    const int quantized = bvr_is_mesh_quantized(mesh);
+
+    // only float and quantized vertices can be read back
+    if(!vertex_count || (!quantized && mesh->vertex_type != BVR_FLOAT)){
+        return;
+    }
+
+    const uint8 components = (mesh->attrib == BVR_MESH_ATTRIB_V2 || mesh->attrib == BVR_MESH_ATTRIB_V2UV2) ? 2 : 3;
+
+    float* positions = malloc((uint64)vertex_count * components * sizeof(float));
+    BVR_ASSERT(positions);
+
+    for (uint64 i = 0; i < vertex_count; i++)
+    {
+        const char* vertex = (const char*)vertices + i * mesh->stride;
+
+        for (uint32 axis = 0; axis < components; axis++)
+        {
+            float value;
+            if(quantized){
+                // snorm16 decoding, as done by OpenGL
+                value = fmaxf(((const int16*)vertex)[axis] / 32767.0f, -1.0f);
+                value = mesh->position_offset[axis] + value * mesh->position_scale[axis];
+            }
+            else {
+                value = ((const float*)vertex)[axis];
+            }
+
+            positions[i * components + axis] = value;
+        }
+    }
+
+    bvri_set_mesh_positions(mesh, positions, vertex_count, components);
+}
+
+/*
+    Define the attribute pointers of mesh's layout on the bound vertex array and vertex buffer, 
+    and set mesh's stride and attribute count.
+*/
+static int bvri_set_mesh_attributes(bvr_mesh_t* mesh, int vertex_type, bvr_mesh_array_attrib_t attrib){
+    // define each attributes pointers depending on attribute's type
+    switch (attrib)
+    {
+    case BVR_MESH_ATTRIB_V2:
+        {
+            mesh->attrib_count = 1;
+            mesh->stride = 2 * bvr_sizeof(vertex_type);
+
+            glEnableVertexAttribArray(0);
+            glVertexAttribPointer(0, 2, vertex_type, GL_FALSE, mesh->stride, (void*)0);
+        }
+        break;
+    
+    case BVR_MESH_ATTRIB_V3:
+        {
+            mesh->attrib_count = 1;
+            mesh->stride = 3 * bvr_sizeof(vertex_type);
+
+            glEnableVertexAttribArray(0);
+            glVertexAttribPointer(0, 3, vertex_type, GL_FALSE, mesh->stride, (void*)0);
+        }
+        break;
+
+    case BVR_MESH_ATTRIB_V2UV2:
+        {
+            mesh->attrib_count = 2;
+            mesh->stride = (2 + 2) * bvr_sizeof(vertex_type);
+
+            glEnableVertexAttribArray(0);
+            glVertexAttribPointer(0, 2, vertex_type, GL_FALSE, mesh->stride, (void*)0);
+            
+            glEnableVertexAttribArray(1);
+            glVertexAttribPointer(1, 2, vertex_type, GL_FALSE, mesh->stride, (void*)(2 * bvr_sizeof(vertex_type)));
+        }
+        break;
+    
+    case BVR_MESH_ATTRIB_V3UV2:
+        {
+            mesh->attrib_count = 2;
+            mesh->stride = (3 + 2) * bvr_sizeof(vertex_type);
+
+            glEnableVertexAttribArray(0);
+            glVertexAttribPointer(0, 3, vertex_type, GL_FALSE, mesh->stride, (void*)0);
+            
+            glEnableVertexAttribArray(1);
+            glVertexAttribPointer(1, 2, vertex_type, GL_FALSE, mesh->stride, (void*)(3 * bvr_sizeof(vertex_type)));
+        }
+        break;
+    
+    case BVR_MESH_ATTRIB_V3UV2N3:
+        {
+            mesh->attrib_count = 3;
+            mesh->stride = (3 + 2 + 3) * bvr_sizeof(vertex_type);
+
+            glEnableVertexAttribArray(0);
+            glVertexAttribPointer(0, 3, vertex_type, GL_FALSE, mesh->stride, (void*)0);
+            
+            glEnableVertexAttribArray(1);
+            glVertexAttribPointer(1, 2, vertex_type, GL_FALSE, mesh->stride, (void*)(3 * bvr_sizeof(vertex_type)));
+
+            glEnableVertexAttribArray(2);
+            glVertexAttribPointer(2, 3, vertex_type, GL_FALSE, mesh->stride, (void*)(5 * bvr_sizeof(vertex_type)));
+        }
+        break;
+
+    case BVR_MESH_ATTRIB_V3_QUANTIZED:
+        {
+            mesh->attrib_count = 1;
+            mesh->stride = 4 * sizeof(int16);
+
+            glEnableVertexAttribArray(0);
+            glVertexAttribPointer(0, 3, GL_SHORT, GL_TRUE, mesh->stride, (void*)0);
+        }
+        break;
+
+    case BVR_MESH_ATTRIB_V3UV2_QUANTIZED:
+        {
+            mesh->attrib_count = 2;
+            mesh->stride = (4 + 2) * sizeof(int16);
+
+            glEnableVertexAttribArray(0);
+            glVertexAttribPointer(0, 3, GL_SHORT, GL_TRUE, mesh->stride, (void*)0);
+
+            glEnableVertexAttribArray(1);
+            glVertexAttribPointer(1, 2, GL_UNSIGNED_SHORT, GL_TRUE, mesh->stride, (void*)(4 * sizeof(int16)));
+        }
+        break;
+
+    case BVR_MESH_ATTRIB_V3UV2N3_QUANTIZED:
+        {
+            mesh->attrib_count = 3;
+            mesh->stride = (4 + 2 + 2) * sizeof(int16);
+
+            glEnableVertexAttribArray(0);
+            glVertexAttribPointer(0, 3, GL_SHORT, GL_TRUE, mesh->stride, (void*)0);
+
+            glEnableVertexAttribArray(1);
+            glVertexAttribPointer(1, 2, GL_UNSIGNED_SHORT, GL_TRUE, mesh->stride, (void*)(4 * sizeof(int16)));
+
+            glEnableVertexAttribArray(2);
+            glVertexAttribPointer(2, 2, GL_SHORT, GL_TRUE, mesh->stride, (void*)(6 * sizeof(int16)));
+        }
+        break;
+
+    default:
+        BVR_PRINT("cannot recognize attribute type!");
+        return BVR_FAILED;
+    }
+
+    if(!mesh->stride){
+        BVR_PRINT("cannot get vertex type size!");
+        return BVR_FAILED;
+    }
+
+    return BVR_OK;
+}
+
+#ifndef BVR_NO_MESH_ARENA
+
+/*
+    Range of free units inside a shared buffer.
+*/
+struct bvri_mesh_range_s {
+    uint32 offset;
+    uint32 count;
+};
+
+/*
+    Free list of a shared buffer, sorted by offset. 
+    Units are vertices for vertex buffers and 4 bytes slots for element buffers.
+*/
+struct bvri_mesh_heap_s {
+    struct bvri_mesh_range_s* ranges;
+    uint32 range_count;
+    uint32 range_capacity;
+
+    uint32 capacity;
+};
+
+/*
+    Shared buffers of a layout (attributes and vertex type), 
+    all of its meshes are drawn with the same vertex array.
+*/
+struct bvri_mesh_arena_s {
+    bvr_mesh_array_attrib_t attrib;
+    int vertex_type;
+
+    uint32 array_buffer;
+    uint32 vertex_buffer;
+    uint32 element_buffer;
+
+    uint8 attrib_count;
+    uint16 stride;
+
+    struct bvri_mesh_heap_s vertices;
+    struct bvri_mesh_heap_s elements;
+};
+
+static struct bvri_mesh_arena_s __mesh_arenas[BVR_MESH_ARENA_COUNT];
+static uint32 __mesh_arena_count = 0;
+
+/*
+    Give a range back to the heap, merged with its neighbours.
+*/
+static void bvri_mesh_heap_release(struct bvri_mesh_heap_s* heap, uint32 offset, uint32 count){
+    if(!count){
+        return;
+    }
+
+    uint32 index = 0;
+    while (index < heap->range_count && heap->ranges[index].offset < offset)
+    {
+        index++;
+    }
+
+    int merge_previous = index > 0 && heap->ranges[index - 1].offset + heap->ranges[index - 1].count == offset;
+    int merge_next = index < heap->range_count && offset + count == heap->ranges[index].offset;
+
+    if(merge_previous && merge_next){
+        heap->ranges[index - 1].count += count + heap->ranges[index].count;
+        memmove(&heap->ranges[index], &heap->ranges[index + 1], 
+            (heap->range_count - index - 1) * sizeof(struct bvri_mesh_range_s));
+        
+        heap->range_count--;
+    }
+    else if(merge_previous){
+        heap->ranges[index - 1].count += count;
+    }
+    else if(merge_next){
+        heap->ranges[index].offset = offset;
+        heap->ranges[index].count += count;
+    }
+    else {
+        if(heap->range_count == heap->range_capacity){
+            heap->range_capacity = heap->range_capacity ? heap->range_capacity * 2 : 16;
+            heap->ranges = realloc(heap->ranges, heap->range_capacity * sizeof(struct bvri_mesh_range_s));
+            BVR_ASSERT(heap->ranges);
+        }
+
+        memmove(&heap->ranges[index + 1], &heap->ranges[index], 
+            (heap->range_count - index) * sizeof(struct bvri_mesh_range_s));
+
+        heap->ranges[index].offset = offset;
+        heap->ranges[index].count = count;
+        heap->range_count++;
+    }
+}
+
+/*
+    Resize a shared buffer while keeping its name and its content, 
+    so that the vertex array and the meshes using it stay valid.
+*/
+static void bvri_grow_mesh_buffer(uint32 buffer, uint64 size, uint64 new_size){
+    uint32 copy = 0;
+
+    // copy targets never touch the bound vertex array's state
+    if(size){
+        glGenBuffers(1, &copy);
+        glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, copy);
+        glBufferData(GL_COPY_WRITE_BUFFER, size, NULL, GL_STATIC_COPY);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, size);
+    }
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, new_size, NULL, GL_STATIC_DRAW);
+
+    if(size){
+        glBindBuffer(GL_COPY_READ_BUFFER, copy);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, size);
+        glDeleteBuffers(1, &copy);
+    }
+
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+/*
+    Allocate `count` units from the first free range large enough, 
+    the buffer is doubled until one is found.
+*/
+static uint32 bvri_mesh_heap_allocate(struct bvri_mesh_heap_s* heap, uint32 buffer, 
+    uint32 unit, uint32 initial_capacity, uint32 count){
+    
+    while (1)
+    {
+        for (uint32 i = 0; i < heap->range_count; i++)
+        {
+            if(heap->ranges[i].count < count){
+                continue;
+            }
+
+            uint32 offset = heap->ranges[i].offset;
+            heap->ranges[i].offset += count;
+            heap->ranges[i].count -= count;
+
+            if(!heap->ranges[i].count){
+                memmove(&heap->ranges[i], &heap->ranges[i + 1], 
+                    (heap->range_count - i - 1) * sizeof(struct bvri_mesh_range_s));
+                
+                heap->range_count--;
+            }
 
-    mesh->array_buffer = 0;
-    mesh->vertex_buffer = 0;
-    mesh->element_buffer = 0;
-    mesh->vertex_count = 0;
-    mesh->element_count = 0;
-    mesh->element_type = 0;
-    mesh->attrib_count = 0;
-    mesh->stride = 0;
-    mesh->attrib = attrib;
+            return offset;
+        }
 
-    mesh->vertex_groups.size = 0;
-    mesh->vertex_groups.elemsize = sizeof(bvr_vertex_group_t);
-    mesh->vertex_groups.data = NULL;
+        uint32 capacity = heap->capacity ? heap->capacity * 2 : initial_capacity;
+        if(capacity < heap->capacity + count){
+            capacity = heap->capacity + count;
+        }
 
-    status = bvri_create_mesh_buffers(mesh, 
-        vertices->count * bvr_sizeof(vertices->type),
-        elements->count * bvr_sizeof(elements->type),
-        vertices->type, elements->type, attrib
-    );
+        bvri_grow_mesh_buffer(buffer, (uint64)heap->capacity * unit, (uint64)capacity * unit);
+        bvri_mesh_heap_release(heap, heap->capacity, capacity - heap->capacity);
+        heap->capacity = capacity;
+    }
+}
+
+/*
+    Find the shared buffers of a layout, they are created on first use.
+*/
+static struct bvri_mesh_arena_s* bvri_get_mesh_arena(bvr_mesh_t* mesh){
+    for (uint32 i = 0; i < __mesh_arena_count; i++)
+    {
+        if(__mesh_arenas[i].attrib == mesh->attrib && __mesh_arenas[i].vertex_type == mesh->vertex_type){
+            return &__mesh_arenas[i];
+        }
+    }
+
+    if(__mesh_arena_count == BVR_MESH_ARENA_COUNT){
+        return NULL;
+    }
+
+    struct bvri_mesh_arena_s* arena = &__mesh_arenas[__mesh_arena_count];
+    memset(arena, 0, sizeof(struct bvri_mesh_arena_s));
+    arena->attrib = mesh->attrib;
+    arena->vertex_type = mesh->vertex_type;
+
+    glGenVertexArrays(1, &arena->array_buffer);
+    glGenBuffers(1, &arena->vertex_buffer);
+    glGenBuffers(1, &arena->element_buffer);
+
+    // attributes stay enabled, the vertex array is only used by arena's meshes
+    glBindVertexArray(arena->array_buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, arena->vertex_buffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, arena->element_buffer);
+
+    int status = bvri_set_mesh_attributes(mesh, mesh->vertex_type, mesh->attrib);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
-    // if cannot create buffers
     if(!status){
+        glDeleteVertexArrays(1, &arena->array_buffer);
+        glDeleteBuffers(1, &arena->vertex_buffer);
+        glDeleteBuffers(1, &arena->element_buffer);
+        return NULL;
+    }
+
+    arena->attrib_count = mesh->attrib_count;
+    arena->stride = mesh->stride;
+
+    __mesh_arena_count++;
+    return arena;
+}
+
+static struct bvri_mesh_arena_s* bvri_find_mesh_arena(bvr_mesh_t* mesh){
+    for (uint32 i = 0; i < __mesh_arena_count; i++)
+    {
+        if(mesh->array_buffer && __mesh_arenas[i].array_buffer == mesh->array_buffer){
+            return &__mesh_arenas[i];
+        }
+    }
+
+    return NULL;
+}
+
+/*
+    Suballocate mesh's vertices and elements from its layout's shared buffers.
+*/
+static int bvri_create_mesh_arena_buffers(bvr_mesh_t* mesh, uint64 vertices_size, uint64 element_size, 
+    void* vertices, void* elements){
+    
+    struct bvri_mesh_arena_s* arena = bvri_get_mesh_arena(mesh);
+    if(!arena){
         return BVR_FAILED;
     }
 
-    // allocate a single vertex group 
-    mesh->vertex_groups.size = sizeof(bvr_vertex_group_t);
-    mesh->vertex_groups.data = malloc(mesh->vertex_groups.size);
-    BVR_ASSERT(mesh->vertex_groups.data);
+    mesh->attrib_count = arena->attrib_count;
+    mesh->stride = arena->stride;
+
+    uint32 vertex_count = vertices_size / arena->stride;
+    uint32 element_slots = (element_size + sizeof(uint32) - 1) / sizeof(uint32);
+
+    uint32 vertex_offset = bvri_mesh_heap_allocate(&arena->vertices, arena->vertex_buffer, 
+        arena->stride, BVR_MESH_ARENA_VERTEX_SIZE / arena->stride, vertex_count);
+    
+    glBindBuffer(GL_COPY_WRITE_BUFFER, arena->vertex_buffer);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, (uint64)vertex_offset * arena->stride, vertices_size, vertices);
+
+    uint32 element_slot = 0;
+    if(element_slots){
+        element_slot = bvri_mesh_heap_allocate(&arena->elements, arena->element_buffer, 
+            sizeof(uint32), BVR_MESH_ARENA_ELEMENT_SIZE / sizeof(uint32), element_slots);
+        
+        if(elements){
+            glBindBuffer(GL_COPY_WRITE_BUFFER, arena->element_buffer);
+            glBufferSubData(GL_COPY_WRITE_BUFFER, (uint64)element_slot * sizeof(uint32), element_size, elements);
+        }
+    }
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    mesh->array_buffer = arena->array_buffer;
+    mesh->vertex_buffer = arena->vertex_buffer;
+    mesh->element_buffer = arena->element_buffer;
+    mesh->base_vertex = vertex_offset;
+    mesh->element_offset = element_slot * sizeof(uint32) / bvr_sizeof(mesh->element_type);
+
+    return BVR_OK;
+}
+
+void bvr_destroy_mesh_arenas(void){
+    for (uint32 i = 0; i < __mesh_arena_count; i++)
+    {
+        glDeleteVertexArrays(1, &__mesh_arenas[i].array_buffer);
+        glDeleteBuffers(1, &__mesh_arenas[i].vertex_buffer);
+        glDeleteBuffers(1, &__mesh_arenas[i].element_buffer);
+
+        free(__mesh_arenas[i].vertices.ranges);
+        free(__mesh_arenas[i].elements.ranges);
+    }
+
+    __mesh_arena_count = 0;
+}
+
+#else
+
+void bvr_destroy_mesh_arenas(void){
+}
+
+#endif
+
+/*
+    Create mesh's vertex array and buffers.
+    Meshes created with their vertices are suballocated from shared buffers unless BVR_NO_MESH_ARENA is defined.
+*/
+static int bvri_upload_mesh_buffers(bvr_mesh_t* mesh, uint64 vertices_size, uint64 element_size, 
+    void* vertices, void* elements, int vertex_type, bvr_mesh_array_attrib_t attrib){
+
+#ifndef BVR_NO_MESH_ARENA
+    if(vertices){
+        if(!bvri_create_mesh_arena_buffers(mesh, vertices_size, element_size, vertices, elements)){
+            BVR_PRINT("cannot allocate mesh from shared buffers!");
+            bvr_destroy_mesh(mesh);
+            return BVR_FAILED;
+        }
+
+        return BVR_OK;
+    }
+#endif
+
+    // create vertex array 
+    glGenVertexArrays(1, &mesh->array_buffer);
+    glBindVertexArray(mesh->array_buffer);
+
+    // create vertex and element buffers
+    glGenBuffers(1, &mesh->vertex_buffer);
+    glGenBuffers(1, &mesh->element_buffer);
+
+    // allocate the whole buffers
+    glBindBuffer(GL_ARRAY_BUFFER, mesh->vertex_buffer);
+    glBufferData(GL_ARRAY_BUFFER, vertices_size, vertices, GL_STATIC_DRAW);
+
+    if(element_size){
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->element_buffer);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, element_size, elements, GL_STATIC_DRAW);
+    }
+
+    if(!bvri_set_mesh_attributes(mesh, vertex_type, attrib)){
+        glBindVertexArray(0);
+        bvr_destroy_mesh(mesh);
+        return BVR_FAILED;
+    }
+
+    for (uint64 i = 0; i < mesh->attrib_count; i++){ 
+        glDisableVertexAttribArray(i); 
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+
+    return BVR_OK;
+}
+
+/*
+    Generic buffer creation function.
+    If `vertices` or `elements` are not NULL, their content is uploaded at allocation.
+    On a mesh loader's thread, they are copied instead and uploaded later by the render thread.
+*/
+static int bvri_create_mesh_buffers(bvr_mesh_t* mesh, uint64 vertices_size, uint64 element_size, 
+    void* vertices, void* elements, int vertex_type, int element_type, bvr_mesh_array_attrib_t attrib){
+
+    BVR_ASSERT(mesh);
+    BVR_ASSERT(vertices_size);
+
+    mesh->attrib = attrib;
+    mesh->vertex_count = vertices_size / bvr_sizeof(vertex_type);
+    mesh->element_count = element_size / bvr_sizeof(element_type);
+    mesh->vertex_type = vertex_type;
+    mesh->element_type = element_type;
+    mesh->base_vertex = 0;
+    mesh->element_offset = 0;
+
+    struct bvri_mesh_upload_s* upload = SDL_GetTLS(&__mesh_upload);
+    if(upload){
+        upload->vertices_size = vertices_size;
+        upload->element_size = element_size;
+        upload->vertex_type = vertex_type;
+        upload->attrib = attrib;
+        upload->vertices = NULL;
+        upload->elements = NULL;
+
+        if(vertices){
+            upload->vertices = malloc(vertices_size);
+            BVR_ASSERT(upload->vertices);
+            memcpy(upload->vertices, vertices, vertices_size);
+        }
+
+        if(elements && element_size){
+            upload->elements = malloc(element_size);
+            BVR_ASSERT(upload->elements);
+            memcpy(upload->elements, elements, element_size);
+        }
+
+        mesh->stride = bvri_get_vertex_stride(attrib, vertex_type);
+    }
+    else if(!bvri_upload_mesh_buffers(mesh, vertices_size, element_size, vertices, elements, vertex_type, attrib)){
+        return BVR_FAILED;
+    }
+
+    if(vertices){
+        bvri_compute_mesh_bounds(mesh, vertices, vertices_size / mesh->stride);
+    }
+
+    return BVR_OK;
+}
+
+/*
+    Polygon triangulation by ear clipping, after Mapbox's earcut.
+    Vertices are kept in a circular doubly linked list so that removing an ear is constant time, 
+    and large polygons are indexed along a z-order curve so that ear tests only look at nearby vertices.
+    Holes are bridged to the outer ring before clipping.
+*/
+
+#define BVRI_EARCUT_BLOCK_SIZE 1024
+
+/*
+    Below this vertex count, ear tests scan the whole ring instead of the z-order curve.
+*/
+#define BVRI_EARCUT_HASH_THRESHOLD 80
+
+struct bvri_earcut_node_s {
+    uint32 i;
+    float x, y;
+
+    uint32 z;
+    int steiner;
+
+    struct bvri_earcut_node_s* prev;
+    struct bvri_earcut_node_s* next;
+    struct bvri_earcut_node_s* prev_z;
+    struct bvri_earcut_node_s* next_z;
+};
+
+struct bvri_earcut_block_s {
+    struct bvri_earcut_block_s* next;
+    struct bvri_earcut_node_s nodes[BVRI_EARCUT_BLOCK_SIZE];
+};
+
+struct bvri_earcut_s {
+    const float* vertices;
+    uint32 stride;
+
+    /* nodes are allocated by blocks and freed at once */
+    struct bvri_earcut_block_s* blocks;
+    uint32 block_used;
+
+    float min_x, min_y, inv_size;
+
+    uint32* triangles;
+    uint32 triangle_count;
+    uint32 triangle_capacity;
+};
+
+static struct bvri_earcut_node_s* bvri_earcut_create_node(struct bvri_earcut_s* earcut, uint32 i, float x, float y){
+    if(!earcut->blocks || earcut->block_used == BVRI_EARCUT_BLOCK_SIZE){
+        struct bvri_earcut_block_s* block = malloc(sizeof(struct bvri_earcut_block_s));
+        BVR_ASSERT(block);
+
+        block->next = earcut->blocks;
+        earcut->blocks = block;
+        earcut->block_used = 0;
+    }
+
+    struct bvri_earcut_node_s* node = &earcut->blocks->nodes[earcut->block_used++];
+    node->i = i;
+    node->x = x;
+    node->y = y;
+    node->z = 0;
+    node->steiner = 0;
+    node->prev = NULL;
+    node->next = NULL;
+    node->prev_z = NULL;
+    node->next_z = NULL;
+
+    return node;
+}
+
+static void bvri_earcut_push_triangle(struct bvri_earcut_s* earcut, uint32 a, uint32 b, uint32 c){
+    if(earcut->triangle_count + 3 > earcut->triangle_capacity){
+        earcut->triangle_capacity = earcut->triangle_capacity ? earcut->triangle_capacity * 2 : 192;
+        earcut->triangles = realloc(earcut->triangles, earcut->triangle_capacity * sizeof(uint32));
+        BVR_ASSERT(earcut->triangles);
+    }
+
+    earcut->triangles[earcut->triangle_count++] = a;
+    earcut->triangles[earcut->triangle_count++] = b;
+    earcut->triangles[earcut->triangle_count++] = c;
+}
+
+/*
+    Twice the signed area of the triangle p, q, r.
+*/
+static float bvri_earcut_area(const struct bvri_earcut_node_s* p, const struct bvri_earcut_node_s* q, const struct bvri_earcut_node_s* r){
+    return (q->y - p->y) * (r->x - q->x) - (q->x - p->x) * (r->y - q->y);
+}
+
+static int bvri_earcut_equals(const struct bvri_earcut_node_s* a, const struct bvri_earcut_node_s* b){
+    return a->x == b->x && a->y == b->y;
+}
+
+static int bvri_earcut_point_in_triangle(float ax, float ay, float bx, float by, float cx, float cy, float px, float py){
+    return (cx - px) * (ay - py) >= (ax - px) * (cy - py) &&
+        (ax - px) * (by - py) >= (bx - px) * (ay - py) &&
+        (bx - px) * (cy - py) >= (cx - px) * (by - py);
+}
+
+static struct bvri_earcut_node_s* bvri_earcut_insert_node(struct bvri_earcut_s* earcut, uint32 i, struct bvri_earcut_node_s* last){
+    struct bvri_earcut_node_s* node = bvri_earcut_create_node(earcut, i, 
+        earcut->vertices[i * earcut->stride + 0], earcut->vertices[i * earcut->stride + 1]);
+
+    if(!last){
+        node->prev = node;
+        node->next = node;
+    }
+    else {
+        node->next = last->next;
+        node->prev = last;
+        last->next->prev = node;
+        last->next = node;
+    }
+
+    return node;
+}
+
+static void bvri_earcut_remove_node(struct bvri_earcut_node_s* node){
+    node->next->prev = node->prev;
+    node->prev->next = node->next;
+
+    if(node->prev_z){
+        node->prev_z->next_z = node->next_z;
+    }
+    if(node->next_z){
+        node->next_z->prev_z = node->prev_z;
+    }
+}
+
+/*
+    Create a circular list from a ring of vertices, with the given winding.
+*/
+static struct bvri_earcut_node_s* bvri_earcut_linked_list(struct bvri_earcut_s* earcut, uint32 start, uint32 end, int clockwise){
+    struct bvri_earcut_node_s* last = NULL;
+    float area = 0.0f;
+
+    for (uint32 i = start, j = end - 1; i < end; j = i++)
+    {
+        const float* a = &earcut->vertices[i * earcut->stride];
+        const float* b = &earcut->vertices[j * earcut->stride];
+        area += (b[0] - a[0]) * (a[1] + b[1]);
+    }
+
+    if(clockwise == (area > 0.0f)){
+        for (uint32 i = start; i < end; i++)
+        {
+            last = bvri_earcut_insert_node(earcut, i, last);
+        }
+    }
+    else {
+        for (uint32 i = end; i > start; i--)
+        {
+            last = bvri_earcut_insert_node(earcut, i - 1, last);
+        }
+    }
+
+    if(last && bvri_earcut_equals(last, last->next)){
+        bvri_earcut_remove_node(last);
+        last = last->next;
+    }
+
+    return last;
+}
+
+/*
+    Remove duplicated and collinear points.
+*/
+static struct bvri_earcut_node_s* bvri_earcut_filter_points(struct bvri_earcut_node_s* start, struct bvri_earcut_node_s* end){
+    if(!start){
+        return start;
+    }
+    if(!end){
+        end = start;
+    }
+
+    struct bvri_earcut_node_s* p = start;
+    int again;
+    do {
+        again = 0;
+
+        if(!p->steiner && (bvri_earcut_equals(p, p->next) || bvri_earcut_area(p->prev, p, p->next) == 0.0f)){
+            bvri_earcut_remove_node(p);
+            p = end = p->prev;
+            if(p == p->next){
+                break;
+            }
+            again = 1;
+        }
+        else {
+            p = p->next;
+        }
+    } while (again || p != end);
+
+    return end;
+}
+
+/*
+    Interleave the bits of the coordinates, mapped to 15 bits each.
+*/
+static uint32 bvri_earcut_z_order(struct bvri_earcut_s* earcut, float fx, float fy){
+    uint32 x = (uint32)((fx - earcut->min_x) * earcut->inv_size);
+    uint32 y = (uint32)((fy - earcut->min_y) * earcut->inv_size);
+
+    x = (x | (x << 8)) & 0x00FF00FF;
+    x = (x | (x << 4)) & 0x0F0F0F0F;
+    x = (x | (x << 2)) & 0x33333333;
+    x = (x | (x << 1)) & 0x55555555;
+
+    y = (y | (y << 8)) & 0x00FF00FF;
+    y = (y | (y << 4)) & 0x0F0F0F0F;
+    y = (y | (y << 2)) & 0x33333333;
+    y = (y | (y << 1)) & 0x55555555;
+
+    return x | (y << 1);
+}
+
+/*
+    Sort the z-order list with a bottom-up merge sort.
+*/
+static void bvri_earcut_sort_linked(struct bvri_earcut_node_s* list){
+    uint32 merges, size = 1;
+
+    do {
+        struct bvri_earcut_node_s* p = list;
+        struct bvri_earcut_node_s* tail = NULL;
+        list = NULL;
+        merges = 0;
+
+        while (p)
+        {
+            merges++;
+
+            struct bvri_earcut_node_s* q = p;
+            uint32 p_size = 0;
+            for (uint32 i = 0; i < size && q; i++)
+            {
+                p_size++;
+                q = q->next_z;
+            }
+
+            uint32 q_size = size;
+            while (p_size > 0 || (q_size > 0 && q))
+            {
+                struct bvri_earcut_node_s* e;
+                if(p_size != 0 && (q_size == 0 || !q || p->z <= q->z)){
+                    e = p;
+                    p = p->next_z;
+                    p_size--;
+                }
+                else {
+                    e = q;
+                    q = q->next_z;
+                    q_size--;
+                }
+
+                if(tail){
+                    tail->next_z = e;
+                }
+                else {
+                    list = e;
+                }
+
+                e->prev_z = tail;
+                tail = e;
+            }
+
+            p = q;
+        }
+
+        tail->next_z = NULL;
+        size *= 2;
+    } while (merges > 1);
+}
+
+static void bvri_earcut_index_curve(struct bvri_earcut_s* earcut, struct bvri_earcut_node_s* start){
+    struct bvri_earcut_node_s* p = start;
+    do {
+        if(!p->z){
+            p->z = bvri_earcut_z_order(earcut, p->x, p->y);
+        }
+
+        p->prev_z = p->prev;
+        p->next_z = p->next;
+        p = p->next;
+    } while (p != start);
+
+    p->prev_z->next_z = NULL;
+    p->prev_z = NULL;
+
+    bvri_earcut_sort_linked(p);
+}
+
+static int bvri_earcut_is_ear(struct bvri_earcut_node_s* ear){
+    struct bvri_earcut_node_s* a = ear->prev;
+    struct bvri_earcut_node_s* b = ear;
+    struct bvri_earcut_node_s* c = ear->next;
 
-    ((bvr_vertex_group_t*)mesh->vertex_groups.data)[0].name.length = 0;
-    ((bvr_vertex_group_t*)mesh->vertex_groups.data)[0].name.string = NULL;
-    ((bvr_vertex_group_t*)mesh->vertex_groups.data)[0].element_offset = 0;
-    ((bvr_vertex_group_t*)mesh->vertex_groups.data)[0].element_count = elements->count;
+    // reflex, can't be an ear
+    if(bvri_earcut_area(a, b, c) >= 0.0f){
+        return 0;
+    }
 
-    // copy vertex values over buffers
-    glBindBuffer(GL_ARRAY_BUFFER, mesh->vertex_buffer);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->element_buffer);
+    float x0 = fminf(a->x, fminf(b->x, c->x)), y0 = fminf(a->y, fminf(b->y, c->y));
+    float x1 = fmaxf(a->x, fmaxf(b->x, c->x)), y1 = fmaxf(a->y, fmaxf(b->y, c->y));
+
+    for (struct bvri_earcut_node_s* p = c->next; p != a; p = p->next)
+    {
+        if(p->x >= x0 && p->x <= x1 && p->y >= y0 && p->y <= y1 && 
+            bvri_earcut_point_in_triangle(a->x, a->y, b->x, b->y, c->x, c->y, p->x, p->y) &&
+            bvri_earcut_area(p->prev, p, p->next) >= 0.0f){
+            return 0;
+        }
+    }
+
+    return 1;
+}
 
-    glBufferSubData(GL_ARRAY_BUFFER, 0, vertices->count * bvr_sizeof(vertices->type), vertices->data);
-    glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, elements->count * bvr_sizeof(elements->type), elements->data);
+static int bvri_earcut_blocks_ear(struct bvri_earcut_node_s* p, struct bvri_earcut_node_s* ear, 
+    float x0, float y0, float x1, float y1){
     
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    struct bvri_earcut_node_s* a = ear->prev;
+    struct bvri_earcut_node_s* c = ear->next;
 
-    return BVR_OK;
+    return p->x >= x0 && p->x <= x1 && p->y >= y0 && p->y <= y1 && p != a && p != c &&
+        bvri_earcut_point_in_triangle(a->x, a->y, ear->x, ear->y, c->x, c->y, p->x, p->y) &&
+        bvri_earcut_area(p->prev, p, p->next) >= 0.0f;
 }
 
 /*
-    Generic buffer creation function
+    Same as bvri_earcut_is_ear, only looking at the vertices whose z-order falls in triangle's bounds.
 */
-static int bvri_create_mesh_buffers(bvr_mesh_t* mesh, uint64 vertices_size, uint64 element_size, 
-    int vertex_type, int element_type, bvr_mesh_array_attrib_t attrib){
+static int bvri_earcut_is_ear_hashed(struct bvri_earcut_s* earcut, struct bvri_earcut_node_s* ear){
+    struct bvri_earcut_node_s* a = ear->prev;
+    struct bvri_earcut_node_s* b = ear;
+    struct bvri_earcut_node_s* c = ear->next;
 
-    BVR_ASSERT(mesh);
-    BVR_ASSERT(vertices_size);
+    if(bvri_earcut_area(a, b, c) >= 0.0f){
+        return 0;
+    }
 
-    // create vertex array 
-    glGenVertexArrays(1, &mesh->array_buffer);
-    glBindVertexArray(mesh->array_buffer);
+    float x0 = fminf(a->x, fminf(b->x, c->x)), y0 = fminf(a->y, fminf(b->y, c->y));
+    float x1 = fmaxf(a->x, fmaxf(b->x, c->x)), y1 = fmaxf(a->y, fmaxf(b->y, c->y));
 
-    // create vertex and element buffers
-    glGenBuffers(1, &mesh->vertex_buffer);
-    glGenBuffers(1, &mesh->element_buffer);
+    uint32 min_z = bvri_earcut_z_order(earcut, x0, y0);
+    uint32 max_z = bvri_earcut_z_order(earcut, x1, y1);
 
-    // allocate the whole buffers
-    glBindBuffer(GL_ARRAY_BUFFER, mesh->vertex_buffer);
-    glBufferData(GL_ARRAY_BUFFER, vertices_size, NULL, GL_STATIC_DRAW);
+    struct bvri_earcut_node_s* p = ear->prev_z;
+    struct bvri_earcut_node_s* n = ear->next_z;
 
-    if(element_size){
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->element_buffer);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, element_size, NULL, GL_STATIC_DRAW);
+    // look both ways along the curve
+    while (p && p->z >= min_z && n && n->z <= max_z)
+    {
+        if(bvri_earcut_blocks_ear(p, ear, x0, y0, x1, y1)){
+            return 0;
+        }
+        p = p->prev_z;
+
+        if(bvri_earcut_blocks_ear(n, ear, x0, y0, x1, y1)){
+            return 0;
+        }
+        n = n->next_z;
     }
-    
-    mesh->attrib = attrib;
-    mesh->vertex_count = vertices_size / bvr_sizeof(vertex_type);
-    mesh->element_count = element_size / bvr_sizeof(element_type);
-    mesh->element_type = element_type;
 
-    // define each attributes pointers depending on attribute's type
-    switch (attrib)
+    for (; p && p->z >= min_z; p = p->prev_z)
     {
-    case BVR_MESH_ATTRIB_V2:
-        {
-            mesh->attrib_count = 1;
-            mesh->stride = 2 * bvr_sizeof(vertex_type);
-
-            glEnableVertexAttribArray(0);
-            glVertexAttribPointer(0, 2, vertex_type, GL_FALSE, mesh->stride, (void*)0);
+        if(bvri_earcut_blocks_ear(p, ear, x0, y0, x1, y1)){
+            return 0;
         }
-        break;
-    
-    case BVR_MESH_ATTRIB_V3:
-        {
-            mesh->attrib_count = 1;
-            mesh->stride = 3 * bvr_sizeof(vertex_type);
+    }
 
-            glEnableVertexAttribArray(0);
-            glVertexAttribPointer(0, 3, vertex_type, GL_FALSE, mesh->stride, (void*)0);
+    for (; n && n->z <= max_z; n = n->next_z)
+    {
+        if(bvri_earcut_blocks_ear(n, ear, x0, y0, x1, y1)){
+            return 0;
         }
-        break;
+    }
 
-    case BVR_MESH_ATTRIB_V2UV2:
-        {
-            mesh->attrib_count = 2;
-            mesh->stride = (2 + 2) * bvr_sizeof(vertex_type);
+    return 1;
+}
 
-            glEnableVertexAttribArray(0);
-            glVertexAttribPointer(0, 2, vertex_type, GL_FALSE, mesh->stride, (void*)0);
-            
-            glEnableVertexAttribArray(1);
-            glVertexAttribPointer(1, 2, vertex_type, GL_FALSE, mesh->stride, (void*)(2 * bvr_sizeof(vertex_type)));
-        }
-        break;
-    
-    case BVR_MESH_ATTRIB_V3UV2:
-        {
-            mesh->attrib_count = 2;
-            mesh->stride = (3 + 2) * bvr_sizeof(vertex_type);
+static int bvri_earcut_sign(float v){
+    return (v > 0.0f) - (v < 0.0f);
+}
 
-            glEnableVertexAttribArray(0);
-            glVertexAttribPointer(0, 3, vertex_type, GL_FALSE, mesh->stride, (void*)0);
-            
-            glEnableVertexAttribArray(1);
-            glVertexAttribPointer(1, 2, vertex_type, GL_FALSE, mesh->stride, (void*)(3 * bvr_sizeof(vertex_type)));
-        }
-        break;
+/*
+    Returns true if q lies on segment pr, knowing that they're collinear.
+*/
+static int bvri_earcut_on_segment(const struct bvri_earcut_node_s* p, const struct bvri_earcut_node_s* q, const struct bvri_earcut_node_s* r){
+    return q->x <= fmaxf(p->x, r->x) && q->x >= fminf(p->x, r->x) && 
+        q->y <= fmaxf(p->y, r->y) && q->y >= fminf(p->y, r->y);
+}
+
+static int bvri_earcut_intersects(const struct bvri_earcut_node_s* p1, const struct bvri_earcut_node_s* q1, 
+    const struct bvri_earcut_node_s* p2, const struct bvri_earcut_node_s* q2){
     
-    case BVR_MESH_ATTRIB_V3UV2N3:
-        {
-            mesh->attrib_count = 3;
-            mesh->stride = (3 + 2 + 3) * bvr_sizeof(vertex_type);
+    int o1 = bvri_earcut_sign(bvri_earcut_area(p1, q1, p2));
+    int o2 = bvri_earcut_sign(bvri_earcut_area(p1, q1, q2));
+    int o3 = bvri_earcut_sign(bvri_earcut_area(p2, q2, p1));
+    int o4 = bvri_earcut_sign(bvri_earcut_area(p2, q2, q1));
 
-            glEnableVertexAttribArray(0);
-            glVertexAttribPointer(0, 3, vertex_type, GL_FALSE, mesh->stride, (void*)0);
-            
-            glEnableVertexAttribArray(1);
-            glVertexAttribPointer(1, 2, vertex_type, GL_FALSE, mesh->stride, (void*)(3 * bvr_sizeof(vertex_type)));
+    if(o1 != o2 && o3 != o4){
+        return 1;
+    }
 
-            glEnableVertexAttribArray(2);
-            glVertexAttribPointer(2, 3, vertex_type, GL_FALSE, mesh->stride, (void*)(5 * bvr_sizeof(vertex_type)));
+    return (o1 == 0 && bvri_earcut_on_segment(p1, p2, q1)) ||
+        (o2 == 0 && bvri_earcut_on_segment(p1, q2, q1)) ||
+        (o3 == 0 && bvri_earcut_on_segment(p2, p1, q2)) ||
+        (o4 == 0 && bvri_earcut_on_segment(p2, q1, q2));
+}
+
+static int bvri_earcut_intersects_polygon(const struct bvri_earcut_node_s* a, const struct bvri_earcut_node_s* b){
+    const struct bvri_earcut_node_s* p = a;
+    do {
+        if(p->i != a->i && p->next->i != a->i && p->i != b->i && p->next->i != b->i &&
+            bvri_earcut_intersects(p, p->next, a, b)){
+            return 1;
         }
-        break;
+        p = p->next;
+    } while (p != a);
 
-    default:
-        {
-            BVR_PRINT("cannot recognize attribute type!");
-            bvr_destroy_mesh(mesh);
+    return 0;
+}
+
+/*
+    Returns true if the diagonal ab starts inside the polygon at a.
+*/
+static int bvri_earcut_locally_inside(const struct bvri_earcut_node_s* a, const struct bvri_earcut_node_s* b){
+    return bvri_earcut_area(a->prev, a, a->next) < 0.0f ?
+        bvri_earcut_area(a, b, a->next) >= 0.0f && bvri_earcut_area(a, a->prev, b) >= 0.0f :
+        bvri_earcut_area(a, b, a->prev) < 0.0f || bvri_earcut_area(a, a->next, b) < 0.0f;
+}
+
+static int bvri_earcut_middle_inside(const struct bvri_earcut_node_s* a, const struct bvri_earcut_node_s* b){
+    const struct bvri_earcut_node_s* p = a;
+    float px = (a->x + b->x) * 0.5f;
+    float py = (a->y + b->y) * 0.5f;
+    int inside = 0;
+
+    do {
+        if(((p->y > py) != (p->next->y > py)) && p->next->y != p->y &&
+            px < (p->next->x - p->x) * (py - p->y) / (p->next->y - p->y) + p->x){
+            inside = !inside;
         }
-        return BVR_FAILED;
-    }
+        p = p->next;
+    } while (p != a);
 
-    if(!mesh->stride){
-        BVR_PRINT("cannot get vertex type size!");
-        bvr_destroy_mesh(mesh);
-        return BVR_FAILED;
+    return inside;
+}
+
+static int bvri_earcut_is_valid_diagonal(const struct bvri_earcut_node_s* a, const struct bvri_earcut_node_s* b){
+    if(a->next->i == b->i || a->prev->i == b->i || bvri_earcut_intersects_polygon(a, b)){
+        return 0;
     }
 
-    for (uint64 i = 0; i < mesh->attrib_count; i++){ 
-        glDisableVertexAttribArray(i); 
+    if(bvri_earcut_locally_inside(a, b) && bvri_earcut_locally_inside(b, a) && bvri_earcut_middle_inside(a, b) &&
+        (bvri_earcut_area(a->prev, a, b->prev) != 0.0f || bvri_earcut_area(a, b->prev, b) != 0.0f)){
+        return 1;
     }
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    // zero length diagonal between two touching rings
+    return bvri_earcut_equals(a, b) && 
+        bvri_earcut_area(a->prev, a, a->next) > 0.0f && bvri_earcut_area(b->prev, b, b->next) > 0.0f;
+}
 
-    return BVR_OK;
+/*
+    Split the polygon along the diagonal ab, returns the node starting the second polygon.
+*/
+static struct bvri_earcut_node_s* bvri_earcut_split_polygon(struct bvri_earcut_s* earcut, struct bvri_earcut_node_s* a, struct bvri_earcut_node_s* b){
+    struct bvri_earcut_node_s* a2 = bvri_earcut_create_node(earcut, a->i, a->x, a->y);
+    struct bvri_earcut_node_s* b2 = bvri_earcut_create_node(earcut, b->i, b->x, b->y);
+    struct bvri_earcut_node_s* an = a->next;
+    struct bvri_earcut_node_s* bp = b->prev;
+
+    a->next = b;
+    b->prev = a;
+
+    a2->next = an;
+    an->prev = a2;
+
+    b2->next = a2;
+    a2->prev = b2;
+
+    bp->next = b2;
+    b2->prev = bp;
+
+    return b2;
 }
 
-void bvr_triangulate(bvr_mesh_buffer_t* src, bvr_mesh_buffer_t* dest, const uint8 stride){
+static void bvri_earcut_linked(struct bvri_earcut_s* earcut, struct bvri_earcut_node_s* ear, int pass);
 
-    // https://github.com/joelibaceta/triangulator/blob/main/triangulator/ear_clipping_method.py
+/*
+    Clip the small self-intersections left after the first passes.
+*/
+static struct bvri_earcut_node_s* bvri_earcut_cure_local_intersections(struct bvri_earcut_s* earcut, struct bvri_earcut_node_s* start){
+    struct bvri_earcut_node_s* p = start;
+    do {
+        struct bvri_earcut_node_s* a = p->prev;
+        struct bvri_earcut_node_s* b = p->next->next;
+
+        if(!bvri_earcut_equals(a, b) && bvri_earcut_intersects(a, p, p->next, b) && 
+            bvri_earcut_locally_inside(a, b) && bvri_earcut_locally_inside(b, a)){
+            
+            bvri_earcut_push_triangle(earcut, a->i, p->i, b->i);
 
-    BVR_ASSERT(src);
-    BVR_ASSERT(dest);
-    BVR_ASSERT(src->data && src->count);
+            bvri_earcut_remove_node(p);
+            bvri_earcut_remove_node(p->next);
 
-    dest->type = BVR_FLOAT;
-    dest->count = 0;
-    dest->data = NULL;
+            p = start = b;
+        }
+        p = p->next;
+    } while (p != start);
 
-    struct {
-        vec2 a, b, c;
-    } triangles[1024];
+    return bvri_earcut_filter_points(p, NULL);
+}
+
+/*
+    Last resort, split the polygon in two along a valid diagonal and triangulate both halves.
+*/
+static void bvri_earcut_split(struct bvri_earcut_s* earcut, struct bvri_earcut_node_s* start){
+    struct bvri_earcut_node_s* a = start;
+    do {
+        for (struct bvri_earcut_node_s* b = a->next->next; b != a->prev; b = b->next)
+        {
+            if(a->i != b->i && bvri_earcut_is_valid_diagonal(a, b)){
+                struct bvri_earcut_node_s* c = bvri_earcut_split_polygon(earcut, a, b);
+
+                a = bvri_earcut_filter_points(a, a->next);
+                c = bvri_earcut_filter_points(c, c->next);
+
+                bvri_earcut_linked(earcut, a, 0);
+                bvri_earcut_linked(earcut, c, 0);
+                return;
+            }
+        }
+        a = a->next;
+    } while (a != start);
+}
+
+/*
+    Clip ears until one triangle remains. When no ear can be found, retry after removing 
+    degenerated points, then after curing self-intersections, then by splitting the polygon.
+*/
+static void bvri_earcut_linked(struct bvri_earcut_s* earcut, struct bvri_earcut_node_s* ear, int pass){
+    if(!ear){
+        return;
+    }
 
-    // create a copy of the vertices.
-    uint32 vertex_count = src->count / stride;
-    vec2* raw_poly = (vec2*)src->data;
-    vec2* polygone = malloc(src->count * bvr_sizeof(src->type));
-    BVR_ASSERT(polygone);
+    if(!pass && earcut->inv_size != 0.0f){
+        bvri_earcut_index_curve(earcut, ear);
+    }
 
-    memcpy(polygone, src->data, src->count * bvr_sizeof(src->type));
+    struct bvri_earcut_node_s* stop = ear;
 
-    int signed_area = 0;
+    while (ear->prev != ear->next)
     {
-        vec2 p0, p1;
-        for (size_t point = 0; point < vertex_count; point++)
-        {
-            vec2_copy(p0, polygone[point]);
-            vec2_copy(p1, polygone[((point + 1) % vertex_count)]);
+        struct bvri_earcut_node_s* prev = ear->prev;
+        struct bvri_earcut_node_s* next = ear->next;
 
-            signed_area += vec2_cross(p0, p1);
+        if(earcut->inv_size != 0.0f ? bvri_earcut_is_ear_hashed(earcut, ear) : bvri_earcut_is_ear(ear)){
+            bvri_earcut_push_triangle(earcut, prev->i, ear->i, next->i);
+            bvri_earcut_remove_node(ear);
+
+            // skipping the next vertex leads to less sliver triangles
+            ear = next->next;
+            stop = next->next;
+            continue;
         }
-     
-        // if this polygone is signed, then we flip it
-        if(signed_area < 0){
-            for (size_t point = 0; point < vertex_count; point++)
-            {
-                vec2 tmp;
-                vec2_copy(tmp, polygone[point]);
-                vec2_copy(polygone[point], polygone[vertex_count - 1 - point]);
-                vec2_copy(polygone[vertex_count - 1 - point], tmp);
+
+        ear = next;
+
+        if(ear == stop){
+            if(pass == 0){
+                bvri_earcut_linked(earcut, bvri_earcut_filter_points(ear, NULL), 1);
+            }
+            else if(pass == 1){
+                ear = bvri_earcut_cure_local_intersections(earcut, bvri_earcut_filter_points(ear, NULL));
+                bvri_earcut_linked(earcut, ear, 2);
             }
+            else if(pass == 2){
+                bvri_earcut_split(earcut, ear);
+            }
+            break;
         }
     }
+}
 
-    vec2* prev_vert = (vec2*)1;
-    vec2* curr_vert = (vec2*)1;
-    vec2* next_vert = (vec2*)1;
+static struct bvri_earcut_node_s* bvri_earcut_leftmost(struct bvri_earcut_node_s* start){
+    struct bvri_earcut_node_s* p = start;
+    struct bvri_earcut_node_s* leftmost = start;
 
-    // while there are triangles to be found
-    while (curr_vert != 0)
-    {
-        prev_vert = NULL;
-        curr_vert = NULL;
-        next_vert = NULL;
+    do {
+        if(p->x < leftmost->x || (p->x == leftmost->x && p->y < leftmost->y)){
+            leftmost = p;
+        }
+        p = p->next;
+    } while (p != start);
 
-        for (size_t point = 0; point < vertex_count; point++)
-        {
-            prev_vert = &polygone[(point + vertex_count - 1) % vertex_count];
-            curr_vert = &polygone[point];
-            next_vert = &polygone[(point + 1) % vertex_count];
-        
-            // determine triangle angle
-            float angle = 0;
-            {
-                vec2 ba, bc;
-                vec2_sub(ba, *prev_vert, *curr_vert);
-                vec2_sub(bc, *next_vert, *curr_vert);
+    return leftmost;
+}
 
-                float theta = vec2_dot(ba, bc) / (vec2_len(ba) * vec2_len(bc));
-                angle = rad_to_deg(acosf(theta));
+static int bvri_earcut_sector_contains_sector(const struct bvri_earcut_node_s* m, const struct bvri_earcut_node_s* p){
+    return bvri_earcut_area(m->prev, m, p->prev) < 0.0f && bvri_earcut_area(p->next, m, m->next) < 0.0f;
+}
 
-                if(vec2_cross(ba, bc) < 0){
-                    angle = 360 - angle;
+/*
+    Find a vertex of the outer ring visible from hole's leftmost vertex (David Eberly's method).
+*/
+static struct bvri_earcut_node_s* bvri_earcut_find_hole_bridge(struct bvri_earcut_node_s* hole, struct bvri_earcut_node_s* outer){
+    struct bvri_earcut_node_s* p = outer;
+    struct bvri_earcut_node_s* m = NULL;
+    float hx = hole->x, hy = hole->y;
+    float qx = -INFINITY;
+
+    // closest segment intersected by a ray going left from the hole
+    do {
+        if(hy <= p->y && hy >= p->next->y && p->next->y != p->y){
+            float x = p->x + (hy - p->y) * (p->next->x - p->x) / (p->next->y - p->y);
+            if(x <= hx && x > qx){
+                qx = x;
+                m = p->x < p->next->x ? p : p->next;
+                if(x == hx){
+                    return m;
                 }
             }
+        }
+        p = p->next;
+    } while (p != outer);
 
-            if(angle >= 180){
-                // skip because the angle is greater than 180
-                continue;
+    if(!m){
+        return NULL;
+    }
+
+    // look for points inside the triangle hole, intersection, m that would hide m
+    struct bvri_earcut_node_s* stop = m;
+    float mx = m->x, my = m->y;
+    float tan_min = INFINITY;
+
+    p = m;
+    do {
+        if(hx >= p->x && p->x >= mx && hx != p->x && 
+            bvri_earcut_point_in_triangle(hy < my ? hx : qx, hy, mx, my, hy < my ? qx : hx, hy, p->x, p->y)){
+            
+            float tan = fabsf(hy - p->y) / (hx - p->x);
+            if(bvri_earcut_locally_inside(p, hole) && 
+                (tan < tan_min || (tan == tan_min && (p->x > m->x || (p->x == m->x && bvri_earcut_sector_contains_sector(m, p)))))){
+                m = p;
+                tan_min = tan;
             }
-            else {
-                bool found_inside = false;
+        }
+        p = p->next;
+    } while (p != stop);
 
-                // check if there is another poly point inside the triangle we found 
-                for (size_t i = 0; i < vertex_count; i++)
-                {
-                    if( ((*prev_vert)[0] == raw_poly[i][0] && (*prev_vert)[1] == raw_poly[i][1]) ||
-                        ((*curr_vert)[0] == raw_poly[i][0] && (*curr_vert)[1] == raw_poly[i][1]) ||
-                        ((*next_vert)[0] == raw_poly[i][0] && (*next_vert)[1] == raw_poly[i][1])){
+    return m;
+}
 
-                        continue;
-                    }
+static int bvri_earcut_compare_x(const void* a, const void* b){
+    float ax = (*(struct bvri_earcut_node_s* const*)a)->x;
+    float bx = (*(struct bvri_earcut_node_s* const*)b)->x;
+    return (ax > bx) - (ax < bx);
+}
 
-                    if(bvr_is_point_inside_triangle(raw_poly[i], *prev_vert, *curr_vert, *next_vert)){
-                        found_inside = true;
-                        break;
-                    }
-                }
+/*
+    Link each hole to the outer ring, from left to right.
+*/
+static struct bvri_earcut_node_s* bvri_earcut_eliminate_holes(struct bvri_earcut_s* earcut, struct bvri_earcut_node_s* outer, 
+    const uint32* holes, uint32 hole_count, uint32 vertex_count){
+    
+    struct bvri_earcut_node_s** queue = malloc(hole_count * sizeof(struct bvri_earcut_node_s*));
+    BVR_ASSERT(queue);
+
+    uint32 queue_count = 0;
+    for (uint32 hole = 0; hole < hole_count; hole++)
+    {
+        uint32 end = hole + 1 < hole_count ? holes[hole + 1] : vertex_count;
+        struct bvri_earcut_node_s* list = bvri_earcut_linked_list(earcut, holes[hole], end, 0);
+        if(!list){
+            continue;
+        }
 
-                // add the new founded triangle
-                if(!found_inside){
-                    vec2_copy(triangles[dest->count].a, *prev_vert);
-                    vec2_copy(triangles[dest->count].b, *curr_vert);
-                    vec2_copy(triangles[dest->count].c, *next_vert);
+        if(list == list->next){
+            list->steiner = 1;
+        }
+        queue[queue_count++] = bvri_earcut_leftmost(list);
+    }
 
-                    // pop out the ear point from the list
-                    for (size_t y = point; y < vertex_count; y++)
-                    {
-                        vec2_copy(polygone[y], polygone[y + 1]);
-                    }
+    qsort(queue, queue_count, sizeof(struct bvri_earcut_node_s*), bvri_earcut_compare_x);
 
-                    vertex_count--;
-                    dest->count++;
-                    
-                    break;
-                }
-            }
+    for (uint32 hole = 0; hole < queue_count; hole++)
+    {
+        struct bvri_earcut_node_s* bridge = bvri_earcut_find_hole_bridge(queue[hole], outer);
+        if(!bridge){
+            continue;
         }
-        
-        if(curr_vert == NULL){
-            break;
+
+        struct bvri_earcut_node_s* bridge_reverse = bvri_earcut_split_polygon(earcut, bridge, queue[hole]);
+        bvri_earcut_filter_points(bridge_reverse, bridge_reverse->next);
+        outer = bvri_earcut_filter_points(bridge, bridge->next);
+    }
+
+    free(queue);
+    return outer;
+}
+
+/*
+    Triangulate the rings of `vertices`, the outer ring followed by the holes starting at `holes`.
+    Returns the number of indices written to `*triangles`, which must be freed.
+*/
+static uint32 bvri_earcut(const float* vertices, uint32 vertex_count, uint32 stride, 
+    const uint32* holes, uint32 hole_count, uint32** triangles){
+
+    struct bvri_earcut_s earcut;
+    earcut.vertices = vertices;
+    earcut.stride = stride;
+    earcut.blocks = NULL;
+    earcut.block_used = 0;
+    earcut.min_x = 0.0f;
+    earcut.min_y = 0.0f;
+    earcut.inv_size = 0.0f;
+    earcut.triangles = NULL;
+    earcut.triangle_count = 0;
+    earcut.triangle_capacity = 0;
+
+    uint32 outer_count = hole_count ? holes[0] : vertex_count;
+    struct bvri_earcut_node_s* outer = bvri_earcut_linked_list(&earcut, 0, outer_count, 1);
+
+    if(outer && outer->next != outer->prev){
+        if(hole_count){
+            outer = bvri_earcut_eliminate_holes(&earcut, outer, holes, hole_count, vertex_count);
+        }
+
+        // large polygons are hashed along a z-order curve
+        if(vertex_count > BVRI_EARCUT_HASH_THRESHOLD){
+            float max_x = vertices[0], max_y = vertices[1];
+            earcut.min_x = max_x;
+            earcut.min_y = max_y;
+
+            for (uint32 i = 1; i < outer_count; i++)
+            {
+                earcut.min_x = fminf(earcut.min_x, vertices[i * stride + 0]);
+                earcut.min_y = fminf(earcut.min_y, vertices[i * stride + 1]);
+                max_x = fmaxf(max_x, vertices[i * stride + 0]);
+                max_y = fmaxf(max_y, vertices[i * stride + 1]);
+            }
+
+            float size = fmaxf(max_x - earcut.min_x, max_y - earcut.min_y);
+            earcut.inv_size = size != 0.0f ? 32767.0f / size : 0.0f;
         }
+
+        bvri_earcut_linked(&earcut, outer, 0);
     }
-    
+
+    while (earcut.blocks)
+    {
+        struct bvri_earcut_block_s* next = earcut.blocks->next;
+        free(earcut.blocks);
+        earcut.blocks = next;
+    }
+
+    *triangles = earcut.triangles;
+    return earcut.triangle_count;
+}
+
+void bvr_triangulate_with_holes(bvr_mesh_buffer_t* src, const uint32* holes, uint32 hole_count, 
+    bvr_mesh_buffer_t* dest, const uint8 stride){
+
+    BVR_ASSERT(src);
+    BVR_ASSERT(dest);
+    BVR_ASSERT(src->data && src->count);
+    BVR_ASSERT(src->type == BVR_FLOAT);
+    BVR_ASSERT(stride >= 2);
+
+    const float* vertices = (const float*)src->data;
+    uint32* triangles = NULL;
+    uint32 count = bvri_earcut(vertices, src->count / stride, stride, holes, hole_count, &triangles);
+
     dest->type = BVR_VEC2;
-    dest->count = dest->count * 3;
-    dest->data = malloc(dest->count * sizeof(vec2));
+    dest->count = count;
+    dest->data = NULL;
 
-    memcpy(dest->data, &triangles[0], dest->count * sizeof(vec2));
+    if(count){
+        dest->data = malloc(count * sizeof(vec2));
+        BVR_ASSERT(dest->data);
 
-    free(polygone);
+        for (uint32 i = 0; i < count; i++)
+        {
+            vec2_copy(((vec2*)dest->data)[i], &vertices[triangles[i] * stride]);
+        }
+    }
+
+    free(triangles);
+}
+
+void bvr_triangulate(bvr_mesh_buffer_t* src, bvr_mesh_buffer_t* dest, const uint8 stride){
+    bvr_triangulate_with_holes(src, NULL, 0, dest, stride);
 }
 
 void bvr_destroy_mesh(bvr_mesh_t* mesh){
     BVR_ASSERT(mesh);
 
+    bvri_cancel_mesh_request(mesh);
+
     for (uint64 i = 0; i < BVR_BUFFER_COUNT(mesh->vertex_groups); i++)
     {
         bvr_destroy_string(&((bvr_vertex_group_t*)mesh->vertex_groups.data)[i].name);
     }
     free(mesh->vertex_groups.data);
 
+    for (uint64 i = 0; i < BVR_BUFFER_COUNT(mesh->lod_groups); i++)
+    {
+        bvr_destroy_string(&((bvr_vertex_group_t*)mesh->lod_groups.data)[i].name);
+    }
+    free(mesh->lod_groups.data);
+    free(mesh->positions);
+
+#ifndef BVR_NO_MESH_ARENA
+    // shared buffers only get mesh's ranges back
+    struct bvri_mesh_arena_s* arena = bvri_find_mesh_arena(mesh);
+    if(arena){
+        bvri_mesh_heap_release(&arena->vertices, mesh->base_vertex, 
+            (uint64)mesh->vertex_count * bvr_sizeof(mesh->vertex_type) / arena->stride);
+        
+        if(mesh->element_count){
+            bvri_mesh_heap_release(&arena->elements, 
+                (uint64)mesh->element_offset * bvr_sizeof(mesh->element_type) / sizeof(uint32),
+                ((uint64)mesh->element_count * bvr_sizeof(mesh->element_type) + sizeof(uint32) - 1) / sizeof(uint32));
+        }
+
+        mesh->array_buffer = 0;
+        mesh->vertex_buffer = 0;
+        mesh->element_buffer = 0;
+        return;
+    }
+#endif
+
     glDeleteVertexArrays(1, &mesh->array_buffer);
     glDeleteBuffers(1, &mesh->vertex_buffer);
     glDeleteBuffers(1, &mesh->element_buffer);
@@ -41,8 +41,16 @@ int bvr_create_book(bvr_book_t* book){
     book->pipeline.clear_color[1] = 0.0f;
     book->pipeline.clear_color[2] = 0.0f;
 
+    book->pipeline.commands = NULL;
+    book->pipeline.command_order = NULL;
+    book->pipeline.command_keys = NULL;
     book->pipeline.command_count = 0;
-    memset(&book->pipeline.commands, 0, sizeof(book->pipeline.commands));
+    book->pipeline.command_capacity = 0;
+    memset(&book->pipeline.instances, 0, sizeof(book->pipeline.instances));
+    memset(&book->pipeline.statistics, 0, sizeof(book->pipeline.statistics));
+
+    memset(&book->pipeline.cache, 0, sizeof(book->pipeline.cache));
+    bvr_pipeline_invalidate_cache(&book->pipeline, 1);
 
     bvr_create_memstream(&book->asset_stream, 0);
 
@@ -65,9 +73,16 @@ bvr_book_t* bvr_get_book_instance(){
 void bvr_new_frame(bvr_book_t* book){
     bvr_window_poll_events();
 
+    // finish meshes loaded in background
+    bvr_update_mesh_loader(BVR_MESH_UPLOAD_BUDGET);
+
     book->current_time = bvr_frames();
     book->delta_time = (book->current_time - book->prev_time) / 1000.0f;
 
+    book->pipeline.cache.issued_calls = 0;
+    book->pipeline.cache.elided_calls = 0;
+    memset(&book->pipeline.statistics, 0, sizeof(book->pipeline.statistics));
+
     // reset opengl states
     bvr_framebuffer_enable(&book->window.framebuffer);
     bvr_framebuffer_clear(&book->window.framebuffer, book->pipeline.clear_color);
@@ -155,17 +170,29 @@ void bvr_update(bvr_book_t* book){
 }
 
 void bvr_flush(bvr_book_t* book){
-    // draw each element of the draw command array
-    qsort(
-        book->pipeline.commands, 
-        book->pipeline.command_count, 
-        sizeof(struct bvr_draw_command_s), 
-        bvr_pipeline_compare_commands
-    );
+    bvr_pipeline_t* pipeline = &book->pipeline;
+
+    // bindings may have changed since the last flush, and the GUI may have drawn with its own states
+    bvr_pipeline_invalidate_cache(pipeline, 0);
+    bvr_pipeline_state_enable(&pipeline->rendering_pass);
+
+    // draw each element of the draw command array, in key order
+    bvr_pipeline_sort_commands(pipeline->commands, pipeline->command_count, pipeline->command_order, pipeline->command_keys);
     
-    for (uint64 i = 0; i < book->pipeline.command_count; i++)
+    for (uint32 i = 0; i < pipeline->command_count;)
     {
-        bvr_pipeline_draw_cmd(&book->pipeline.commands[i]);
+        // consecutive commands drawing the same mesh with the same states are merged into one instanced draw
+        uint32 instances = bvr_pipeline_instance_count(pipeline->commands, &pipeline->command_order[i], 
+            pipeline->command_count - i);
+
+        if(instances > 1){
+            bvr_pipeline_draw_instanced(pipeline->commands, &pipeline->command_order[i], instances);
+        }
+        else {
+            bvr_pipeline_draw_cmd(&pipeline->commands[pipeline->command_order[i]]);
+        }
+
+        i += instances;
     }
 
     book->pipeline.command_count = 0;
@@ -177,6 +204,11 @@ void bvr_render(bvr_book_t* book){
         bvr_flush(book);
     }
 
+    // instance data written this frame is fenced
+    if(book->pipeline.instances.buffer){
+        bvr_dynamic_buffer_next_frame(&book->pipeline.instances);
+    }
+
     // disable the rendering framebuffer
     bvr_framebuffer_disable(&book->window.framebuffer);
 
@@ -211,6 +243,11 @@ void bvr_render(bvr_book_t* book){
 }
 
 void bvr_destroy_book(bvr_book_t* book){
+    // shared mesh buffers and pipeline's instance buffer need the context
+    bvr_destroy_mesh_loader();
+    bvr_destroy_mesh_arenas();
+    bvr_destroy_pipeline(&book->pipeline);
+
     if(book->window.context){
         bvr_destroy_window(&book->window);
     }
@@ -43,6 +43,10 @@ static int bvri_compile_shader(uint32* shader, bvr_string_t* const content, int
 }
 
 static int bvri_link_shader(const uint32 program) {
+    // instance attributes are at fixed locations, the pipeline binds them without querying the program
+    glBindAttribLocation(program, BVR_ATTRIBUTE_INSTANCE_TRANSFORM, BVR_ATTRIBUTE_INSTANCE_TRANSFORM_NAME);
+    glBindAttribLocation(program, BVR_ATTRIBUTE_INSTANCE_LAYER, BVR_ATTRIBUTE_INSTANCE_LAYER_NAME);
+
     glLinkProgram(program);
 
     int state;
@@ -209,6 +213,10 @@ shader_cstor_bidings:
     if (shader->blocks[0].location == -1) {
         BVR_PRINT("cannot find transform uniform!");
     }
+
+    if (glGetAttribLocation(shader->program, BVR_ATTRIBUTE_INSTANCE_TRANSFORM_NAME) != -1) {
+        shader->flags |= BVR_INSTANCED_SHADER;
+    }
         
     bvr_destroy_string(&file_content);
 
@@ -337,9 +345,10 @@ bvr_shader_uniform_t* bvr_shader_register_texture(bvr_shader_t* shader, int type
                 texture_uniform.layer = *layer;
             }
 
-            texture_uniform.layer_location = glGetUniformLocation(shader->program, layer_name);
+            // instanced shaders read the layer from their instance attributes
+            texture_uniform.layer_location = layer_name ? glGetUniformLocation(shader->program, layer_name) : -1;
 
-            if(texture_uniform.layer_location == -1){
+            if(layer_name && texture_uniform.layer_location == -1){
                 BVR_PRINT("failed to find texture layer location!");
             }
         }